@@ -0,0 +1,178 @@
+#include "AnalysisPool.h"
+#include "EvalCache.h"
+
+#include <algorithm>
+
+namespace chessAi
+{
+
+AnalysisPool::AnalysisPool(unsigned int threads, bool useBook, size_t evalCacheSizeInMegaBytes)
+    : m_slots(std::max(1u, threads)),
+      m_evalCache(std::make_shared<EvalCache>(evalCacheSizeInMegaBytes)), m_lastId(0),
+      m_completed(0), m_start(std::chrono::steady_clock::now())
+{
+    for (auto& slot : m_slots) {
+        slot.worker = std::make_unique<EngineWorker>(useBook, std::chrono::milliseconds(1000));
+        slot.worker->post(
+            [evalCache = m_evalCache](Engine& engine) { engine.setEvalCache(evalCache); });
+    }
+    CHESS_LOG_INFO("Analysis pool started with {} workers.", m_slots.size());
+}
+
+AnalysisPool::~AnalysisPool()
+{
+    stopAll();
+    wait();
+}
+
+unsigned int AnalysisPool::submit(Analysis analysis, ResultCallback callback,
+                                  InfoCallback progress)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    Job job;
+    job.id = ++m_lastId;
+    job.analysis = std::move(analysis);
+    job.callback = std::move(callback);
+    job.progress = std::move(progress);
+
+    auto id = job.id;
+    auto freeSlot = std::find_if(m_slots.begin(), m_slots.end(),
+                                 [](const Slot& slot) { return !slot.id.has_value(); });
+    if (freeSlot != m_slots.end())
+        dispatch(static_cast<size_t>(freeSlot - m_slots.begin()), std::move(job));
+    else
+        m_queue.push_back(std::move(job));
+    return id;
+}
+
+void AnalysisPool::stop(unsigned int id)
+{
+    stopJobs([id](unsigned int jobId, const std::string&) { return jobId == id; });
+}
+
+void AnalysisPool::stopSession(const std::string& session)
+{
+    stopJobs([&session](unsigned int, const std::string& jobSession) {
+        return jobSession == session;
+    });
+}
+
+void AnalysisPool::stopAll()
+{
+    stopJobs([](unsigned int, const std::string&) { return true; });
+}
+
+void AnalysisPool::wait()
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+    auto isIdle = [](const Slot& slot) { return !slot.id.has_value(); };
+    m_idle.wait(lock, [this, &isIdle]() {
+        return m_queue.empty() && std::all_of(m_slots.begin(), m_slots.end(), isIdle);
+    });
+}
+
+unsigned int AnalysisPool::getThreads() const
+{
+    return static_cast<unsigned int>(m_slots.size());
+}
+
+AnalysisPool::Statistics AnalysisPool::getStatistics()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    Statistics statistics;
+    statistics.completed = m_completed;
+    statistics.queued = m_queue.size();
+    statistics.running = static_cast<size_t>(std::count_if(
+        m_slots.begin(), m_slots.end(), [](const Slot& slot) { return slot.id.has_value(); }));
+    auto seconds =
+        std::chrono::duration<double>(std::chrono::steady_clock::now() - m_start).count();
+    if (seconds > 0.0)
+        statistics.analysesPerSecond = static_cast<double>(m_completed) / seconds;
+    return statistics;
+}
+
+void AnalysisPool::dispatch(size_t slotIndex, Job job)
+{
+    auto& slot = m_slots[slotIndex];
+    slot.id = job.id;
+    slot.session = job.analysis.session;
+
+    auto limits = job.analysis.limits;
+    if (job.analysis.clearHash)
+        slot.worker->newGame();
+    slot.worker->post([limits](Engine& engine) {
+        engine.setTimeLimit(limits.time);
+        engine.setDepthLimit(limits.depth);
+        engine.setNodeLimit(limits.nodes);
+        engine.setMultiPv(limits.multiPv);
+    });
+
+    Engine::InfoCallback progress;
+    if (job.progress) {
+        progress = [id = job.id, callback = job.progress](const Engine::SearchInfo& info) {
+            callback(id, info);
+        };
+    }
+    // Worker calls the callback without holding its lock, finish can dispatch to it again.
+    slot.request = slot.worker->search(
+        job.analysis.bitBoards, job.analysis.zobristKeysHistory,
+        [this, slotIndex, id = job.id, callback = std::move(job.callback)](
+            const EngineWorker::Result& result) {
+            if (callback)
+                callback(id, result);
+            finish(slotIndex);
+        },
+        std::move(progress));
+}
+
+void AnalysisPool::finish(size_t slotIndex)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    ++m_completed;
+    m_slots[slotIndex].id = std::nullopt;
+    if (!m_queue.empty()) {
+        auto job = std::move(m_queue.front());
+        m_queue.pop_front();
+        dispatch(slotIndex, std::move(job));
+    }
+    else {
+        m_idle.notify_all();
+    }
+}
+
+void AnalysisPool::stopJobs(
+    const std::function<bool(unsigned int id, const std::string& session)>& isStopped)
+{
+    std::vector<Job> dropped;
+    std::vector<std::pair<EngineWorker*, unsigned int>> running;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        std::deque<Job> kept;
+        for (auto& job : m_queue) {
+            if (isStopped(job.id, job.analysis.session))
+                dropped.push_back(std::move(job));
+            else
+                kept.push_back(std::move(job));
+        }
+        m_queue = std::move(kept);
+
+        for (const auto& slot : m_slots) {
+            if (slot.id.has_value() && isStopped(*slot.id, slot.session))
+                running.emplace_back(slot.worker.get(), slot.request);
+        }
+        m_idle.notify_all();
+    }
+
+    // Outside of the lock, worker may call back to finish from this thread.
+    for (auto [worker, request] : running)
+        worker->stop(request);
+
+    EngineWorker::Result result;
+    result.stopped = true;
+    for (const auto& job : dropped) {
+        if (job.callback)
+            job.callback(job.id, result);
+    }
+}
+
+} // namespace chessAi
@@ -0,0 +1,163 @@
+#pragma once
+
+#include "EngineWorker.h"
+
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+
+namespace chessAi
+{
+
+/**
+ * Fixed pool of engine workers that runs analyses of any number of sessions. Memory doesn't grow
+ * with the number of sessions: every worker has one transposition table (pooled, entries are
+ * keyed by position, so any worker can continue the analysis of any session) and all workers
+ * share one evaluation cache. Opening book, bitbases and magic tables are process wide and read
+ * only.
+ *
+ * Analyses are queued in order and run on the first free worker. Callbacks are called from
+ * worker threads, or from the thread calling stop for analyses that didn't start.
+ */
+class AnalysisPool
+{
+public:
+    struct Limits
+    {
+        std::chrono::milliseconds time{1000};
+        unsigned int depth = 100;
+        /**
+         * 0 for no limit.
+         */
+        uint64_t nodes = 0;
+        unsigned int multiPv = 1;
+    };
+
+    struct Analysis
+    {
+        std::string session;
+        PieceBitBoards bitBoards;
+        /**
+         * Used to detect 3 fold repetition.
+         */
+        std::vector<uint64_t> zobristKeysHistory;
+        Limits limits;
+        /**
+         * Clears the transposition table of the worker first, so the result doesn't depend on
+         * earlier analyses (reproducible test suite runs).
+         */
+        bool clearHash = false;
+    };
+
+    using ResultCallback = std::function<void(unsigned int id, const EngineWorker::Result&)>;
+    using InfoCallback = std::function<void(unsigned int id, const Engine::SearchInfo&)>;
+
+public:
+    /**
+     * @param threads Number of workers, at least one.
+     * @param useBook Book moves are returned without search (see Engine).
+     * @param evalCacheSizeInMegaBytes Size of the evaluation cache shared by all workers.
+     */
+    AnalysisPool(unsigned int threads, bool useBook, size_t evalCacheSizeInMegaBytes = 16);
+
+    /**
+     * Stops all analyses, callbacks of the queued ones are called with Result::stopped.
+     */
+    ~AnalysisPool();
+
+    AnalysisPool(const AnalysisPool&) = delete;
+    AnalysisPool& operator=(const AnalysisPool&) = delete;
+
+    /**
+     * Queues analysis. Progress callback gets the search info after every iteration.
+     *
+     * @return Id of the analysis, passed to callbacks and to stop.
+     */
+    unsigned int submit(Analysis analysis, ResultCallback callback,
+                        InfoCallback progress = nullptr);
+
+    /**
+     * Stops the analysis, running one returns the best move found so far.
+     */
+    void stop(unsigned int id);
+
+    /**
+     * Stops all analyses of the session.
+     */
+    void stopSession(const std::string& session);
+
+    /**
+     * Stops all analyses.
+     */
+    void stopAll();
+
+    /**
+     * Blocks until no analysis is queued or running.
+     */
+    void wait();
+
+    unsigned int getThreads() const;
+
+    struct Statistics
+    {
+        uint64_t completed = 0;
+        size_t running = 0;
+        size_t queued = 0;
+        /**
+         * Completed analyses per second since the pool was created.
+         */
+        double analysesPerSecond = 0.0;
+    };
+
+    Statistics getStatistics();
+
+private:
+    struct Job
+    {
+        unsigned int id = 0;
+        Analysis analysis;
+        ResultCallback callback;
+        InfoCallback progress;
+    };
+
+    struct Slot
+    {
+        std::unique_ptr<EngineWorker> worker;
+        /**
+         * Running analysis and its request id in the worker.
+         */
+        std::optional<unsigned int> id;
+        std::string session;
+        unsigned int request = 0;
+    };
+
+    /**
+     * Starts the job on the free worker, called under m_mutex.
+     */
+    void dispatch(size_t slotIndex, Job job);
+
+    /**
+     * Worker finished its analysis, starts the next queued one.
+     */
+    void finish(size_t slotIndex);
+
+    /**
+     * Stops analyses (queued or running) selected by id and session.
+     */
+    void stopJobs(
+        const std::function<bool(unsigned int id, const std::string& session)>& isStopped);
+
+private:
+    std::mutex m_mutex;
+    std::condition_variable m_idle;
+    std::vector<Slot> m_slots;
+    std::deque<Job> m_queue;
+    std::shared_ptr<EvalCache> m_evalCache;
+    unsigned int m_lastId;
+    uint64_t m_completed;
+    std::chrono::steady_clock::time_point m_start;
+};
+
+} // namespace chessAi
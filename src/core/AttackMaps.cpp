@@ -0,0 +1,88 @@
+#include "AttackMaps.h"
+#include "King.h"
+#include "Knight.h"
+#include "Pawn.h"
+
+namespace chessAi
+{
+
+namespace
+{
+
+void addAttack(AttackMaps::ColorAttacks& attacks, PieceFigure figure, uint64_t attack,
+               uint64_t mobilityArea)
+{
+    attacks.attackedTwice |= attacks.all & attack;
+    attacks.all |= attack;
+    attacks.byFigure[static_cast<size_t>(figure)] |= attack;
+    attacks.mobility[static_cast<size_t>(figure)] = static_cast<uint16_t>(
+        attacks.mobility[static_cast<size_t>(figure)] +
+        PieceBitBoards::countSetBits(attack & mobilityArea));
+}
+
+template <PieceColor TColor>
+void generateColorAttacks(const PieceBitBoards& bitBoards, AttackMaps::ColorAttacks& attacks,
+                          uint64_t opponentPawnAttacks)
+{
+    const auto& magicAttacks = AttackMaps::getMagicAttacks();
+    auto occupancy = bitBoards.getAllPiecesBoard();
+    auto mobilityArea = ~bitBoards.getAllPiecesBoard<TColor>() & ~opponentPawnAttacks;
+
+    const auto& pawnPositions = (TColor == PieceColor::White) ? bitBoards.whitePawnPositions
+                                                              : bitBoards.blackPawnPositions;
+    const auto& knightPositions = (TColor == PieceColor::White) ? bitBoards.whiteKnightPositions
+                                                                : bitBoards.blackKnightPositions;
+    const auto& bishopPositions = (TColor == PieceColor::White) ? bitBoards.whiteBishopPositions
+                                                                : bitBoards.blackBishopPositions;
+    const auto& rookPositions = (TColor == PieceColor::White) ? bitBoards.whiteRookPositions
+                                                              : bitBoards.blackRookPositions;
+    const auto& queenPositions = (TColor == PieceColor::White) ? bitBoards.whiteQueenPositions
+                                                               : bitBoards.blackQueenPositions;
+    const auto& kingPositions = (TColor == PieceColor::White) ? bitBoards.whiteKingPositions
+                                                              : bitBoards.blackKingPositions;
+
+    // Pawn attacks are not counted for mobility.
+    for (auto position : pawnPositions)
+        addAttack(attacks, PieceFigure::Pawn, Pawn<TColor>::originToAttacks[position], 0);
+    for (auto position : knightPositions)
+        addAttack(attacks, PieceFigure::Knight, Knight::originToAttacks[position], mobilityArea);
+    for (auto position : bishopPositions)
+        addAttack(attacks, PieceFigure::Bishop,
+                  magicAttacks.Bishop(occupancy, static_cast<int>(position)), mobilityArea);
+    for (auto position : rookPositions)
+        addAttack(attacks, PieceFigure::Rook,
+                  magicAttacks.Rook(occupancy, static_cast<int>(position)), mobilityArea);
+    for (auto position : queenPositions)
+        addAttack(attacks, PieceFigure::Queen,
+                  magicAttacks.Queen(occupancy, static_cast<int>(position)), mobilityArea);
+    if (!kingPositions.empty())
+        addAttack(attacks, PieceFigure::King, King::originToAttacks[kingPositions[0]], 0);
+}
+
+template <PieceColor TColor>
+uint64_t generatePawnAttacks(const std::vector<uint16_t>& pawnPositions)
+{
+    uint64_t attacks = 0;
+    for (auto position : pawnPositions)
+        attacks |= Pawn<TColor>::originToAttacks[position];
+    return attacks;
+}
+
+} // namespace
+
+AttackMaps::AttackMaps(const PieceBitBoards& bitBoards) : colors()
+{
+    auto whitePawnAttacks = generatePawnAttacks<PieceColor::White>(bitBoards.whitePawnPositions);
+    auto blackPawnAttacks = generatePawnAttacks<PieceColor::Black>(bitBoards.blackPawnPositions);
+
+    generateColorAttacks<PieceColor::White>(bitBoards, colors[0], blackPawnAttacks);
+    generateColorAttacks<PieceColor::Black>(bitBoards, colors[1], whitePawnAttacks);
+}
+
+const magic_bits::Attacks& AttackMaps::getMagicAttacks()
+{
+    static const magic_bits::Attacks s_magicAttacks;
+    return s_magicAttacks;
+}
+
+} // namespace chessAi
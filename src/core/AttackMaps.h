@@ -0,0 +1,74 @@
+#pragma once
+
+#include "PieceBitBoards.h"
+#include "PieceType.h"
+#include "magic-bits-master/include/magic_bits.hpp"
+
+#include <array>
+#include <cstdint>
+
+namespace chessAi
+{
+
+/**
+ * Attacked squares of both colors for one position, computed once per node and shared between
+ * evaluation (mobility, king safety, threats) and move generation (check detection).
+ */
+struct AttackMaps
+{
+    struct ColorAttacks
+    {
+        /**
+         * Union of attacks of all pieces of the figure, indexed by PieceFigure.
+         */
+        std::array<uint64_t, 7> byFigure{};
+        uint64_t all = 0;
+        /**
+         * Squares attacked by at least two pieces.
+         */
+        uint64_t attackedTwice = 0;
+        /**
+         * Sum of safe squares (not occupied by own pieces and not attacked by opponents pawns)
+         * over all pieces of the figure, indexed by PieceFigure.
+         */
+        std::array<uint16_t, 7> mobility{};
+    };
+
+    explicit AttackMaps(const PieceBitBoards& bitBoards);
+
+    template <PieceColor TColor>
+    const ColorAttacks& get() const;
+
+    const ColorAttacks& get(PieceColor color) const;
+
+    template <PieceColor TColor>
+    bool isKingInCheck(const PieceBitBoards& bitBoards) const;
+
+    /**
+     * Magic bitboard tables for sliding pieces. Built once on first use, safe to call from many
+     * threads.
+     */
+    static const magic_bits::Attacks& getMagicAttacks();
+
+    std::array<ColorAttacks, 2> colors;
+};
+
+template <PieceColor TColor>
+const AttackMaps::ColorAttacks& AttackMaps::get() const
+{
+    return colors[static_cast<size_t>(TColor)];
+}
+
+inline const AttackMaps::ColorAttacks& AttackMaps::get(PieceColor color) const
+{
+    return colors[static_cast<size_t>(color)];
+}
+
+template <PieceColor TColor>
+bool AttackMaps::isKingInCheck(const PieceBitBoards& bitBoards) const
+{
+    return (get<PieceType::getOppositeColor<TColor>()>().all &
+            bitBoards.getPieceBitBoard<TColor, PieceFigure::King>()) != 0;
+}
+
+} // namespace chessAi
@@ -0,0 +1,417 @@
+#include "Bitbase.h"
+#include "Pawn.h"
+#include "PieceBitBoards.h"
+
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <mutex>
+
+namespace chessAi
+{
+
+namespace
+{
+
+/**
+ * Figures of Bitbase::figureLetters.
+ */
+constexpr std::array<PieceFigure, 5> letterFigures = {PieceFigure::Queen, PieceFigure::Rook,
+                                                      PieceFigure::Bishop, PieceFigure::Knight,
+                                                      PieceFigure::Pawn};
+
+/**
+ * Squares of the a8-d8-d5 triangle (row <= column <= 3) in index order, and index of every
+ * square in it.
+ */
+struct KingTriangle
+{
+    std::array<uint8_t, 10> squares{};
+    std::array<uint8_t, 64> indices{};
+
+    constexpr KingTriangle()
+    {
+        uint8_t index = 0;
+        for (uint8_t square = 0; square < 64; ++square) {
+            unsigned int row = square / 8u;
+            unsigned int column = square % 8u;
+            if (row <= column && column <= 3) {
+                squares[index] = square;
+                indices[square] = index;
+                ++index;
+            }
+        }
+    }
+};
+
+constexpr KingTriangle kingTriangle;
+
+uint8_t transpose(uint8_t square)
+{
+    return static_cast<uint8_t>((square % 8) * 8 + square / 8);
+}
+
+} // namespace
+
+std::optional<BitbasePosition> BitbasePosition::fromBitBoards(const PieceBitBoards& bitBoards)
+{
+    if (PieceBitBoards::countSetBits(bitBoards.getAllPiecesBoard()) > Bitbase::maxPieces)
+        return {};
+    if (bitBoards.whiteKingSideCastle || bitBoards.whiteQueenSideCastle ||
+        bitBoards.blackKingSideCastle || bitBoards.blackQueenSideCastle)
+        return {};
+
+    // En passant square is set after every double push, it matters only if a pawn can capture.
+    auto pieceBitBoards = bitBoards.getBitBoardsByPieceIndex();
+    if (bitBoards.enPassantTargetSquare != 0) {
+        auto target = bitBoards.enPassantTargetSquare;
+        auto capturers = (bitBoards.currentMoveColor == PieceColor::White)
+                             ? Pawn<PieceColor::Black>::originToAttacks[target] & pieceBitBoards[0]
+                             : Pawn<PieceColor::White>::originToAttacks[target] & pieceBitBoards[6];
+        if (capturers != 0)
+            return {};
+    }
+
+    BitbasePosition position;
+    position.sideToMove = bitBoards.currentMoveColor;
+    for (size_t index = 0; index < pieceBitBoards.size(); ++index) {
+        for (auto bitBoard = pieceBitBoards[index]; bitBoard; bitBoard &= bitBoard - 1) {
+            auto& piece = position.pieces[position.count++];
+            piece.color = (index < 6) ? PieceColor::White : PieceColor::Black;
+            piece.figure = static_cast<PieceFigure>(index % 6 + 1);
+            piece.square =
+                static_cast<uint8_t>(PieceBitBoards::getLeastSignificantSetBit(bitBoard));
+        }
+    }
+    return position;
+}
+
+uint64_t BitbasePosition::getMaterialKey() const
+{
+    uint64_t key = 0;
+    for (uint8_t i = 0; i < count; ++i) {
+        auto shift = 4 * (static_cast<unsigned int>(pieces[i].color) * 7 +
+                          static_cast<unsigned int>(pieces[i].figure));
+        key += 1ULL << shift;
+    }
+    return key;
+}
+
+std::optional<Bitbase> Bitbase::fromName(std::string_view name)
+{
+    if (name.size() < 2 || name.size() > maxPieces || name.front() != 'K')
+        return {};
+    auto blackKing = name.find('K', 1);
+    if (blackKing == std::string_view::npos || name.find('K', blackKing + 1) != name.npos)
+        return {};
+
+    Bitbase bitbase;
+    bitbase.m_name = name;
+    bitbase.m_pieces.push_back({PieceColor::White, PieceFigure::King, 0});
+    bitbase.m_pieces.push_back({PieceColor::Black, PieceFigure::King, 0});
+    for (size_t i = 1; i < name.size(); ++i) {
+        if (i == blackKing)
+            continue;
+        auto letter = figureLetters.find(name[i]);
+        if (letter == std::string_view::npos)
+            return {};
+        auto color = (i < blackKing) ? PieceColor::White : PieceColor::Black;
+        bitbase.m_pieces.push_back({color, letterFigures[letter], 0});
+        bitbase.m_hasPawns |= letterFigures[letter] == PieceFigure::Pawn;
+    }
+
+    BitbasePosition position;
+    for (const auto& piece : bitbase.m_pieces)
+        position.pieces[position.count++] = piece;
+    bitbase.m_materialKey = position.getMaterialKey();
+    for (uint8_t i = 0; i < position.count; ++i)
+        position.pieces[i].color = PieceType::getOppositeColor(position.pieces[i].color);
+    bitbase.m_flippedMaterialKey = position.getMaterialKey();
+
+    bitbase.m_size = 2 * (bitbase.m_hasPawns ? 32 : kingTriangle.squares.size());
+    for (size_t i = 1; i < bitbase.m_pieces.size(); ++i)
+        bitbase.m_size *= 64;
+    return bitbase;
+}
+
+std::optional<Bitbase> Bitbase::create(std::string_view name)
+{
+    auto bitbase = fromName(name);
+    if (!bitbase.has_value())
+        return {};
+    bitbase->m_results.resize(bitbase->getSizeInBytes(), 0);
+    bitbase->m_data = bitbase->m_results.data();
+    return bitbase;
+}
+
+std::optional<Bitbase> Bitbase::load(const std::string& path)
+{
+    auto bitbase = fromName(std::filesystem::path(path).stem().string());
+    if (!bitbase.has_value()) {
+        CHESS_LOG_ERROR("{} is not a valid bitbase name.", path);
+        return {};
+    }
+
+    MappedFile mappedFile(path);
+    if (!mappedFile.isOpen())
+        return {};
+    if (mappedFile.size() != bitbase->getSizeInBytes()) {
+        CHESS_LOG_ERROR("Bitbase {} has invalid size.", path);
+        return {};
+    }
+    bitbase->m_mappedFile = std::move(mappedFile);
+    bitbase->m_data = reinterpret_cast<const uint8_t*>(bitbase->m_mappedFile.data());
+    return bitbase;
+}
+
+bool Bitbase::save(const std::string& path) const
+{
+    auto temporaryPath = path + ".tmp";
+    {
+        std::ofstream file(temporaryPath, std::ios::binary);
+        if (!file.is_open()) {
+            CHESS_LOG_ERROR("Couldn't open {} for writing.", temporaryPath);
+            return false;
+        }
+        file.write(reinterpret_cast<const char*>(m_data),
+                   static_cast<std::streamsize>(getSizeInBytes()));
+        if (!file) {
+            CHESS_LOG_ERROR("Couldn't write bitbase {}.", temporaryPath);
+            return false;
+        }
+    }
+
+    std::error_code error;
+    std::filesystem::rename(temporaryPath, path, error);
+    if (error) {
+        CHESS_LOG_ERROR("Couldn't rename {} to {}: {}", temporaryPath, path, error.message());
+        return false;
+    }
+    return true;
+}
+
+const std::string& Bitbase::getName() const
+{
+    return m_name;
+}
+
+const std::vector<BitbasePosition::Piece>& Bitbase::getPieces() const
+{
+    return m_pieces;
+}
+
+uint64_t Bitbase::getMaterialKey() const
+{
+    return m_materialKey;
+}
+
+uint64_t Bitbase::getFlippedMaterialKey() const
+{
+    return m_flippedMaterialKey;
+}
+
+bool Bitbase::hasPawns() const
+{
+    return m_hasPawns;
+}
+
+size_t Bitbase::size() const
+{
+    return m_size;
+}
+
+size_t Bitbase::getIndex(BitbasePosition position) const
+{
+    // Black has the stronger pieces, flip colors and the board vertically.
+    if (position.getMaterialKey() != m_materialKey) {
+        position.sideToMove = PieceType::getOppositeColor(position.sideToMove);
+        for (uint8_t i = 0; i < position.count; ++i) {
+            position.pieces[i].color = PieceType::getOppositeColor(position.pieces[i].color);
+            position.pieces[i].square ^= 56;
+        }
+    }
+
+    // Squares in index order.
+    std::array<uint8_t, maxPieces> squares{};
+    std::array<bool, maxPieces> assigned{};
+    for (uint8_t i = 0; i < position.count; ++i) {
+        const auto& piece = position.pieces[i];
+        for (size_t slot = 0; slot < m_pieces.size(); ++slot) {
+            if (!assigned[slot] && m_pieces[slot].color == piece.color &&
+                m_pieces[slot].figure == piece.figure) {
+                squares[slot] = piece.square;
+                assigned[slot] = true;
+                break;
+            }
+        }
+    }
+
+    // Move the white king to the a-d files, and to the triangle without pawns.
+    auto whiteKing = squares[0];
+    uint8_t flip = 0;
+    if (whiteKing % 8 > 3)
+        flip ^= 7;
+    if (!m_hasPawns && whiteKing / 8 > 3)
+        flip ^= 56;
+    for (size_t slot = 0; slot < m_pieces.size(); ++slot)
+        squares[slot] ^= flip;
+    // Mirror on the a8-h1 diagonal, decided by the first piece not on it, so positions with
+    // pieces on the diagonal have one index too.
+    if (!m_hasPawns) {
+        for (size_t slot = 0; slot < m_pieces.size(); ++slot) {
+            if (squares[slot] / 8 == squares[slot] % 8)
+                continue;
+            if (squares[slot] / 8 > squares[slot] % 8) {
+                for (auto& square : squares)
+                    square = transpose(square);
+            }
+            break;
+        }
+    }
+
+    size_t index = (position.sideToMove == PieceColor::White) ? 0 : 1;
+    if (m_hasPawns)
+        index = index * 32 + (squares[0] / 8) * 4 + squares[0] % 8;
+    else
+        index = index * kingTriangle.squares.size() + kingTriangle.indices[squares[0]];
+    for (size_t slot = 1; slot < m_pieces.size(); ++slot)
+        index = index * 64 + squares[slot];
+    return index;
+}
+
+BitbasePosition Bitbase::getPosition(size_t index) const
+{
+    BitbasePosition position;
+    position.count = static_cast<uint8_t>(m_pieces.size());
+    for (size_t slot = m_pieces.size() - 1; slot > 0; --slot) {
+        position.pieces[slot] = m_pieces[slot];
+        position.pieces[slot].square = static_cast<uint8_t>(index % 64);
+        index /= 64;
+    }
+
+    position.pieces[0] = m_pieces[0];
+    if (m_hasPawns) {
+        auto king = index % 32;
+        position.pieces[0].square = static_cast<uint8_t>((king / 4) * 8 + king % 4);
+        index /= 32;
+    }
+    else {
+        position.pieces[0].square = kingTriangle.squares[index % kingTriangle.squares.size()];
+        index /= kingTriangle.squares.size();
+    }
+    position.sideToMove = (index == 0) ? PieceColor::White : PieceColor::Black;
+    return position;
+}
+
+size_t Bitbase::getSizeInBytes() const
+{
+    return (m_size + 3) / 4;
+}
+
+Bitbase::Result Bitbase::getResult(size_t index) const
+{
+    return static_cast<Result>((m_data[index / 4] >> (2 * (index % 4))) & 3);
+}
+
+void Bitbase::setResult(size_t index, Result result)
+{
+    auto shift = 2 * (index % 4);
+    auto& byte = m_results[index / 4];
+    auto value = static_cast<unsigned int>(result) << shift;
+    byte = static_cast<uint8_t>((byte & ~(3u << shift)) | value);
+}
+
+namespace
+{
+
+// Immutable once published, Init replaces the whole set while searches may still probe the old
+// one. Accessed with std::atomic_load and std::atomic_store only.
+std::shared_ptr<const Bitbases> s_loaded;
+std::string s_loadedDirectory;
+std::mutex s_initMutex;
+
+} // namespace
+
+void Bitbases::add(Bitbase bitbase)
+{
+    m_bitbases.push_back(std::move(bitbase));
+}
+
+std::optional<Bitbase::Result> Bitbases::probe(const BitbasePosition& position) const
+{
+    if (position.count == 2)
+        return Bitbase::Result::Draw;
+
+    auto key = position.getMaterialKey();
+    for (const auto& bitbase : m_bitbases) {
+        if (bitbase.getMaterialKey() == key || bitbase.getFlippedMaterialKey() == key)
+            return bitbase.getResult(bitbase.getIndex(position));
+    }
+    return {};
+}
+
+size_t Bitbases::size() const
+{
+    return m_bitbases.size();
+}
+
+bool Bitbases::Init(const std::string& directory)
+{
+    std::lock_guard<std::mutex> lock(s_initMutex);
+    // Only successful loads are kept, a missing or empty directory is searched again (it may
+    // be created later, e.g. by the bitbase generator) and doesn't replace bitbases loaded before.
+    std::error_code error;
+    bool isDirectory = std::filesystem::is_directory(directory, error);
+    auto current = std::atomic_load(&s_loaded);
+    if (s_loadedDirectory == directory && current != nullptr && isDirectory)
+        return true;
+
+    auto loaded = std::make_shared<Bitbases>();
+    if (isDirectory) {
+        for (const auto& entry : std::filesystem::directory_iterator(directory, error)) {
+            if (entry.path().extension() != ".bbs")
+                continue;
+            auto bitbase = Bitbase::load(entry.path().string());
+            if (bitbase.has_value())
+                loaded->add(std::move(*bitbase));
+        }
+    }
+    if (loaded->size() == 0) {
+        if (current != nullptr)
+            CHESS_LOG_WARN("No bitbases in {}, keeping {} bitbases from {}.", directory,
+                           current->size(), s_loadedDirectory);
+        return false;
+    }
+
+    CHESS_LOG_INFO("Loaded {} bitbases from {}.", loaded->size(), directory);
+    std::atomic_store(&s_loaded, std::shared_ptr<const Bitbases>(std::move(loaded)));
+    s_loadedDirectory = directory;
+    return true;
+}
+
+bool Bitbases::isLoaded()
+{
+    return std::atomic_load(&s_loaded) != nullptr;
+}
+
+void Bitbases::clear()
+{
+    std::lock_guard<std::mutex> lock(s_initMutex);
+    std::atomic_store(&s_loaded, std::shared_ptr<const Bitbases>());
+    s_loadedDirectory.clear();
+}
+
+std::optional<Bitbase::Result> Bitbases::probe(const PieceBitBoards& bitBoards)
+{
+    auto position = BitbasePosition::fromBitBoards(bitBoards);
+    if (!position.has_value())
+        return {};
+
+    // Keeps the bitbases mapped until the probe is done, even if Init replaces them meanwhile.
+    auto loaded = std::atomic_load(&s_loaded);
+    if (loaded == nullptr)
+        return {};
+    return loaded->probe(*position);
+}
+
+} // namespace chessAi
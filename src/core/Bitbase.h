@@ -0,0 +1,208 @@
+#pragma once
+
+#include "MappedFile.h"
+#include "PieceType.h"
+
+#include <array>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace chessAi
+{
+
+struct PieceBitBoards;
+
+/**
+ * Position with few pieces, as used by bitbases. Squares use the engine's numbering (a8 = 0).
+ */
+struct BitbasePosition
+{
+    struct Piece
+    {
+        PieceColor color = PieceColor::White;
+        PieceFigure figure = PieceFigure::Empty;
+        uint8_t square = 0;
+    };
+
+    std::array<Piece, 4> pieces{};
+    uint8_t count = 0;
+    PieceColor sideToMove = PieceColor::White;
+
+    /**
+     * Position of the bit boards, empty optional if it has more than 4 pieces, castling rights or
+     * an en passant capture (not represented in bitbases).
+     */
+    static std::optional<BitbasePosition> fromBitBoards(const PieceBitBoards& bitBoards);
+
+    /**
+     * Counts of pieces by color and figure, 4 bits each. Positions with the same key have the
+     * same material.
+     */
+    uint64_t getMaterialKey() const;
+};
+
+/**
+ * Win, draw or loss of every position with one set of pieces (material), from the view of the
+ * side to move, with perfect play. Generated by retrograde analysis (BitbaseGenerator).
+ *
+ * Material is named by the white pieces followed by the black pieces, strongest first: KRK,
+ * KPK, KQKR, ... White is the stronger side, positions where black has the stronger pieces are
+ * looked up with colors flipped.
+ *
+ * Positions are indexed by side to move and the squares of all pieces. Symmetry reduces the
+ * white king to 10 squares (a8-d8-d5 triangle) in tables without pawns and to the a-d files in
+ * tables with pawns. Results take 2 bits per position, 4 positions in a byte. Files hold only the
+ * results, material is given by the file name (KRK.bbs).
+ *
+ * Loaded bitbases are memory mapped, pages are read from disk on first probe and only the probed
+ * parts of a file take memory.
+ */
+class Bitbase
+{
+public:
+    enum class Result : uint8_t
+    {
+        Draw = 0,
+        Win = 1,
+        Loss = 2
+    };
+
+    static constexpr unsigned int maxPieces = 4;
+
+    /**
+     * Letters of the figures besides kings in names of bitbases, strongest first. Names list the
+     * figures of each side in this order (KQRK, KRKP).
+     */
+    static constexpr std::string_view figureLetters = "QRBNP";
+
+    /**
+     * Empty bitbase (all positions draws) with material of the name.
+     *
+     * @return Empty optional if name is not valid.
+     */
+    static std::optional<Bitbase> create(std::string_view name);
+
+    /**
+     * Maps bitbase file into memory, material is taken from the file name. Loaded bitbase is read
+     * only, setResult must not be called.
+     *
+     * @return Empty optional if file is not valid, errors are logged.
+     */
+    static std::optional<Bitbase> load(const std::string& path);
+
+    /**
+     * Writes to a temporary file which is renamed to path when complete, so an interrupted save
+     * never leaves a truncated bitbase at path.
+     *
+     * @return true If successful.
+     */
+    bool save(const std::string& path) const;
+
+    const std::string& getName() const;
+
+    /**
+     * Pieces in index order: white king, black king, other white pieces, other black pieces.
+     */
+    const std::vector<BitbasePosition::Piece>& getPieces() const;
+
+    uint64_t getMaterialKey() const;
+
+    /**
+     * Material key with colors flipped (black has the stronger pieces).
+     */
+    uint64_t getFlippedMaterialKey() const;
+
+    bool hasPawns() const;
+
+    /**
+     * Number of indexed positions, including illegal ones.
+     */
+    size_t size() const;
+
+    /**
+     * Index of the position, which must have material of the bitbase (or flipped material).
+     */
+    size_t getIndex(BitbasePosition position) const;
+
+    /**
+     * Position of the index, pieces in index order. Pieces can share squares, it is not
+     * validated. Symmetric positions have one index, indices of their other orientations are not
+     * used: getIndex of their position is a different index.
+     */
+    BitbasePosition getPosition(size_t index) const;
+
+    Result getResult(size_t index) const;
+
+    void setResult(size_t index, Result result);
+
+private:
+    /**
+     * Bitbase with material of the name, without results.
+     */
+    static std::optional<Bitbase> fromName(std::string_view name);
+
+    size_t getSizeInBytes() const;
+
+private:
+    std::string m_name;
+    std::vector<BitbasePosition::Piece> m_pieces;
+    uint64_t m_materialKey = 0;
+    uint64_t m_flippedMaterialKey = 0;
+    bool m_hasPawns = false;
+    size_t m_size = 0;
+    /**
+     * Results of created bitbases, loaded bitbases use m_mappedFile.
+     */
+    std::vector<uint8_t> m_results;
+    MappedFile m_mappedFile;
+    const uint8_t* m_data = nullptr;
+};
+
+/**
+ * Set of bitbases, looked up by material.
+ *
+ * Engine uses the bitbases loaded with Init, shared by all engines.
+ */
+class Bitbases
+{
+public:
+    void add(Bitbase bitbase);
+
+    /**
+     * Result of the position from the view of the side to move, empty optional if there is no
+     * bitbase for its material. Position must be legal.
+     */
+    std::optional<Bitbase::Result> probe(const BitbasePosition& position) const;
+
+    size_t size() const;
+
+    /**
+     * Loads all bitbase files (.bbs) in the directory, replacing the bitbases loaded before.
+     * Bitbases are kept when called again with the same directory, if the directory still exists,
+     * and when the directory has no bitbases. Safe to call while other threads probe, they finish
+     * with the bitbases loaded before.
+     *
+     * @return true If at least one bitbase was loaded from the directory.
+     */
+    static bool Init(const std::string& directory = "bitbases");
+
+    static bool isLoaded();
+
+    /**
+     * Unloads the bitbases, engines created afterwards search without them.
+     */
+    static void clear();
+
+    /**
+     * Probes bitbases loaded with Init. Thread safe.
+     */
+    static std::optional<Bitbase::Result> probe(const PieceBitBoards& bitBoards);
+
+private:
+    std::vector<Bitbase> m_bitbases;
+};
+
+} // namespace chessAi
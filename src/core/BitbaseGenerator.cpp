@@ -0,0 +1,452 @@
+#include "BitbaseGenerator.h"
+#include "AttackMaps.h"
+#include "King.h"
+#include "Knight.h"
+#include "Pawn.h"
+
+#include <algorithm>
+#include <atomic>
+#include <thread>
+
+namespace chessAi
+{
+
+namespace
+{
+
+using Piece = BitbasePosition::Piece;
+
+enum State : uint8_t
+{
+    Unknown,
+    Win,
+    Loss,
+    Draw,
+    Invalid
+};
+
+uint64_t getOccupancy(const BitbasePosition& position)
+{
+    uint64_t occupancy = 0;
+    for (uint8_t i = 0; i < position.count; ++i)
+        occupancy |= 1ULL << position.pieces[i].square;
+    return occupancy;
+}
+
+uint64_t getOccupancy(const BitbasePosition& position, PieceColor color)
+{
+    uint64_t occupancy = 0;
+    for (uint8_t i = 0; i < position.count; ++i) {
+        if (position.pieces[i].color == color)
+            occupancy |= 1ULL << position.pieces[i].square;
+    }
+    return occupancy;
+}
+
+uint64_t getAttacks(const Piece& piece, uint64_t occupancy)
+{
+    const auto& magicAttacks = AttackMaps::getMagicAttacks();
+    auto square = static_cast<int>(piece.square);
+    switch (piece.figure) {
+    case PieceFigure::Pawn:
+        return (piece.color == PieceColor::White)
+                   ? Pawn<PieceColor::White>::originToAttacks[piece.square]
+                   : Pawn<PieceColor::Black>::originToAttacks[piece.square];
+    case PieceFigure::Knight:
+        return Knight::originToAttacks[piece.square];
+    case PieceFigure::Bishop:
+        return magicAttacks.Bishop(occupancy, square);
+    case PieceFigure::Rook:
+        return magicAttacks.Rook(occupancy, square);
+    case PieceFigure::Queen:
+        return magicAttacks.Queen(occupancy, square);
+    case PieceFigure::King:
+        return King::originToAttacks[piece.square];
+    default:
+        return 0;
+    }
+}
+
+/**
+ * Is king of the color attacked by the opponent.
+ */
+bool isInCheck(const BitbasePosition& position, PieceColor color, uint64_t occupancy)
+{
+    uint64_t king = 0;
+    uint64_t attacks = 0;
+    for (uint8_t i = 0; i < position.count; ++i) {
+        const auto& piece = position.pieces[i];
+        if (piece.color != color)
+            attacks |= getAttacks(piece, occupancy);
+        else if (piece.figure == PieceFigure::King)
+            king = 1ULL << piece.square;
+    }
+    return (attacks & king) != 0;
+}
+
+/**
+ * Pieces on different squares, no pawns on the first or last row and side not to move is not in
+ * check.
+ */
+bool isLegal(const BitbasePosition& position)
+{
+    auto occupancy = getOccupancy(position);
+    if (PieceBitBoards::countSetBits(occupancy) != position.count)
+        return false;
+    for (uint8_t i = 0; i < position.count; ++i) {
+        auto row = position.pieces[i].square / 8;
+        if (position.pieces[i].figure == PieceFigure::Pawn && (row == 0 || row == 7))
+            return false;
+    }
+    return !isInCheck(position, PieceType::getOppositeColor(position.sideToMove), occupancy);
+}
+
+/**
+ * Calls callback(child, leavesBitbase) for every legal move, until it returns false. Moves leave
+ * the bitbase if they capture or promote.
+ */
+template <typename TCallback>
+void forEachMove(const BitbasePosition& position, const TCallback& callback)
+{
+    auto color = position.sideToMove;
+    auto occupancy = getOccupancy(position);
+    auto ownPieces = getOccupancy(position, color);
+    auto opponentPieces = occupancy & ~ownPieces;
+
+    for (uint8_t i = 0; i < position.count; ++i) {
+        const auto& piece = position.pieces[i];
+        if (piece.color != color)
+            continue;
+
+        uint64_t targets = 0;
+        if (piece.figure == PieceFigure::Pawn) {
+            int direction = (color == PieceColor::White) ? -8 : 8;
+            auto push = static_cast<uint8_t>(piece.square + direction);
+            if (!PieceBitBoards::getBit(occupancy, push)) {
+                targets |= 1ULL << push;
+                auto startRow = (color == PieceColor::White) ? 6 : 1;
+                auto doublePush = static_cast<uint8_t>(push + direction);
+                if (piece.square / 8 == startRow && !PieceBitBoards::getBit(occupancy, doublePush))
+                    targets |= 1ULL << doublePush;
+            }
+            targets |= getAttacks(piece, occupancy) & opponentPieces;
+        }
+        else
+            targets = getAttacks(piece, occupancy) & ~ownPieces;
+
+        for (; targets; targets &= targets - 1) {
+            auto target = static_cast<uint8_t>(PieceBitBoards::getLeastSignificantSetBit(targets));
+            BitbasePosition child = position;
+            child.pieces[i].square = target;
+            child.sideToMove = PieceType::getOppositeColor(color);
+
+            bool capture = PieceBitBoards::getBit(opponentPieces, target);
+            if (capture) {
+                for (uint8_t j = 0; j < child.count; ++j) {
+                    if (j != i && child.pieces[j].square == target) {
+                        child.pieces[j] = child.pieces[--child.count];
+                        break;
+                    }
+                }
+            }
+            auto childOccupancy = getOccupancy(child);
+            if (isInCheck(child, color, childOccupancy))
+                continue;
+
+            bool promotion =
+                piece.figure == PieceFigure::Pawn && (target / 8 == 0 || target / 8 == 7);
+            if (!promotion) {
+                if (!callback(child, capture))
+                    return;
+                continue;
+            }
+
+            // Moved piece stays at index i, unless it was last and replaced the captured piece.
+            for (uint8_t j = 0; j < child.count; ++j) {
+                if (child.pieces[j].square != target)
+                    continue;
+                for (auto figure : {PieceFigure::Queen, PieceFigure::Rook, PieceFigure::Bishop,
+                                    PieceFigure::Knight}) {
+                    child.pieces[j].figure = figure;
+                    if (!callback(child, true))
+                        return;
+                }
+            }
+        }
+    }
+}
+
+/**
+ * Calls callback(predecessor) for every legal position, from which the side not to move reached
+ * the position with a quiet move (no capture or promotion).
+ */
+template <typename TCallback>
+void forEachPredecessor(const BitbasePosition& position, const TCallback& callback)
+{
+    auto color = PieceType::getOppositeColor(position.sideToMove);
+    auto occupancy = getOccupancy(position);
+
+    for (uint8_t i = 0; i < position.count; ++i) {
+        const auto& piece = position.pieces[i];
+        if (piece.color != color)
+            continue;
+
+        uint64_t origins = 0;
+        if (piece.figure == PieceFigure::Pawn) {
+            int direction = (color == PieceColor::White) ? 8 : -8;
+            auto origin = static_cast<uint8_t>(piece.square + direction);
+            auto originRow = origin / 8;
+            if (originRow >= 1 && originRow <= 6 && !PieceBitBoards::getBit(occupancy, origin)) {
+                origins |= 1ULL << origin;
+                auto doublePushRow = (color == PieceColor::White) ? 4 : 3;
+                auto doubleOrigin = static_cast<uint8_t>(origin + direction);
+                if (piece.square / 8 == doublePushRow &&
+                    !PieceBitBoards::getBit(occupancy, doubleOrigin))
+                    origins |= 1ULL << doubleOrigin;
+            }
+        }
+        else
+            origins = getAttacks(piece, occupancy) & ~occupancy;
+
+        for (; origins; origins &= origins - 1) {
+            BitbasePosition predecessor = position;
+            predecessor.pieces[i].square =
+                static_cast<uint8_t>(PieceBitBoards::getLeastSignificantSetBit(origins));
+            predecessor.sideToMove = color;
+            if (!isInCheck(predecessor, position.sideToMove, getOccupancy(predecessor)))
+                callback(predecessor);
+        }
+    }
+}
+
+/**
+ * Calls function(begin, end, threadIndex) on equal chunks of [0, count) in parallel.
+ */
+template <typename TFunction>
+void parallelFor(unsigned int numberOfThreads, size_t count, const TFunction& function)
+{
+    std::vector<std::thread> threads;
+    for (unsigned int i = 0; i < numberOfThreads; ++i) {
+        size_t begin = count * i / numberOfThreads;
+        size_t end = count * (i + 1) / numberOfThreads;
+        threads.emplace_back([&function, begin, end, i]() { function(begin, end, i); });
+    }
+    for (auto& thread : threads)
+        thread.join();
+}
+
+class Generator
+{
+public:
+    Generator(Bitbase& bitbase, const Bitbases& bitbases, unsigned int threads)
+        : m_bitbase(bitbase), m_bitbases(bitbases), m_threads(std::max(1u, threads)),
+          m_states(bitbase.size())
+    {
+    }
+
+    bool generate()
+    {
+        // Decided positions of the current layer, per thread.
+        std::vector<std::vector<size_t>> layers(m_threads);
+        parallelFor(m_threads, m_states.size(), [&](size_t begin, size_t end, unsigned int thread) {
+            for (size_t index = begin; index < end; ++index) {
+                auto state = getInitialState(index);
+                m_states[index].store(state, std::memory_order_relaxed);
+                if (state == Win || state == Loss)
+                    layers[thread].push_back(index);
+            }
+        });
+        if (m_missingBitbase) {
+            CHESS_LOG_ERROR("Bitbases needed for {} are missing.", m_bitbase.getName());
+            return false;
+        }
+
+        std::vector<size_t> layer;
+        while (true) {
+            layer.clear();
+            for (auto& threadLayer : layers) {
+                layer.insert(layer.end(), threadLayer.begin(), threadLayer.end());
+                threadLayer.clear();
+            }
+            if (layer.empty())
+                break;
+
+            auto propagateRange = [&](size_t begin, size_t end, unsigned int thread) {
+                for (size_t i = begin; i < end; ++i)
+                    propagate(layer[i], layers[thread]);
+            };
+            parallelFor(m_threads, layer.size(), propagateRange);
+        }
+
+        for (size_t index = 0; index < m_states.size(); ++index) {
+            auto state = m_states[index].load(std::memory_order_relaxed);
+            if (state == Win)
+                m_bitbase.setResult(index, Bitbase::Result::Win);
+            else if (state == Loss)
+                m_bitbase.setResult(index, Bitbase::Result::Loss);
+        }
+        return true;
+    }
+
+private:
+    State getInitialState(size_t index)
+    {
+        auto position = m_bitbase.getPosition(index);
+        if (!isLegal(position) || m_bitbase.getIndex(position) != index)
+            return Invalid;
+
+        bool hasMoves = false;
+        bool win = false;
+        bool allMovesLose = true;
+        forEachMove(position, [&](const BitbasePosition& child, bool leavesBitbase) {
+            hasMoves = true;
+            if (!leavesBitbase) {
+                allMovesLose = false;
+                return true;
+            }
+
+            auto result = m_bitbases.probe(child);
+            if (!result.has_value()) {
+                m_missingBitbase = true;
+                return false;
+            }
+            if (*result == Bitbase::Result::Loss) {
+                win = true;
+                return false;
+            }
+            allMovesLose &= *result == Bitbase::Result::Win;
+            return true;
+        });
+
+        if (!hasMoves)
+            return isInCheck(position, position.sideToMove, getOccupancy(position)) ? Loss : Draw;
+        if (win)
+            return Win;
+        return allMovesLose ? Loss : Unknown;
+    }
+
+    /**
+     * Decides undecided predecessors of the decided position.
+     */
+    void propagate(size_t index, std::vector<size_t>& decided)
+    {
+        auto state = m_states[index].load(std::memory_order_relaxed);
+        forEachPredecessor(m_bitbase.getPosition(index), [&](const BitbasePosition& predecessor) {
+            auto predecessorIndex = m_bitbase.getIndex(predecessor);
+            auto& predecessorState = m_states[predecessorIndex];
+            if (predecessorState.load(std::memory_order_relaxed) != Unknown)
+                return;
+
+            auto newState = (state == Loss) ? Win : Loss;
+            if (newState == Loss && !allMovesLose(predecessor))
+                return;
+
+            uint8_t expected = Unknown;
+            if (predecessorState.compare_exchange_strong(expected, newState))
+                decided.push_back(predecessorIndex);
+        });
+    }
+
+    /**
+     * All moves lead to wins of the opponent. Wins found by other threads in the current layer
+     * might not be seen yet, they are checked again when their layer is propagated.
+     */
+    bool allMovesLose(const BitbasePosition& position)
+    {
+        bool lose = true;
+        forEachMove(position, [&](const BitbasePosition& child, bool leavesBitbase) {
+            if (leavesBitbase)
+                lose = m_bitbases.probe(child) == Bitbase::Result::Win;
+            else
+                lose = m_states[m_bitbase.getIndex(child)].load(std::memory_order_relaxed) == Win;
+            return lose;
+        });
+        return lose;
+    }
+
+private:
+    Bitbase& m_bitbase;
+    const Bitbases& m_bitbases;
+    unsigned int m_threads;
+    std::vector<std::atomic<uint8_t>> m_states;
+    std::atomic<bool> m_missingBitbase{false};
+};
+
+/**
+ * Appends all multisets of count letters (strongest first) to names.
+ */
+void addPieceSets(size_t count, size_t firstLetter, std::string& pieces,
+                  std::vector<std::string>& sets)
+{
+    if (count == 0) {
+        sets.push_back(pieces);
+        return;
+    }
+    for (size_t letter = firstLetter; letter < Bitbase::figureLetters.size(); ++letter) {
+        pieces.push_back(Bitbase::figureLetters[letter]);
+        addPieceSets(count - 1, letter, pieces, sets);
+        pieces.pop_back();
+    }
+}
+
+/**
+ * Is the first set of pieces stronger or equal: more pieces, then stronger pieces.
+ */
+bool isStrongerOrEqual(const std::string& first, const std::string& second)
+{
+    if (first.size() != second.size())
+        return first.size() > second.size();
+    for (size_t i = 0; i < first.size(); ++i) {
+        if (first[i] != second[i])
+            return Bitbase::figureLetters.find(first[i]) < Bitbase::figureLetters.find(second[i]);
+    }
+    return true;
+}
+
+} // namespace
+
+std::vector<std::string> BitbaseGenerator::getNames(unsigned int maxPieces)
+{
+    std::vector<std::string> names;
+    for (size_t pieces = 3; pieces <= maxPieces; ++pieces) {
+        std::vector<std::string> sets;
+        std::string setPieces;
+        for (size_t count = 0; count <= pieces - 2; ++count)
+            addPieceSets(count, 0, setPieces, sets);
+
+        for (const auto& white : sets) {
+            for (const auto& black : sets) {
+                if (white.size() + black.size() == pieces - 2 && isStrongerOrEqual(white, black))
+                    names.push_back('K' + white + 'K' + black);
+            }
+        }
+    }
+
+    // Captures lead to fewer pieces, promotions to fewer pawns.
+    auto countPawns = [](const std::string& name) {
+        return std::count(name.begin(), name.end(), 'P');
+    };
+    std::stable_sort(names.begin(), names.end(), [&](const std::string& a, const std::string& b) {
+        if (a.size() != b.size())
+            return a.size() < b.size();
+        return countPawns(a) < countPawns(b);
+    });
+    return names;
+}
+
+std::optional<Bitbase> BitbaseGenerator::generate(std::string_view name, const Bitbases& bitbases,
+                                                  unsigned int threads)
+{
+    auto bitbase = Bitbase::create(name);
+    if (!bitbase.has_value()) {
+        CHESS_LOG_ERROR("{} is not a valid bitbase name.", name);
+        return {};
+    }
+
+    Generator generator(*bitbase, bitbases, threads);
+    if (!generator.generate())
+        return {};
+    return bitbase;
+}
+
+} // namespace chessAi
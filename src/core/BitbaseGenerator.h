@@ -0,0 +1,45 @@
+#pragma once
+
+#include "Bitbase.h"
+
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace chessAi
+{
+
+/**
+ * Generates bitbases by retrograde analysis.
+ *
+ * First every position is checked once: illegal positions are skipped, mates are losses,
+ * stalemates draws, and moves leaving the bitbase (captures and promotions) are looked up in the
+ * already generated bitbases. Then results are propagated backwards from decided positions, one
+ * layer at a time, by taking back quiet moves: predecessors of a loss are wins, predecessors of a
+ * win are losses once all their moves lead to wins of the opponent. Positions still undecided
+ * when no more positions change are draws.
+ *
+ * Every layer is split between threads. Positions are only ever decided once (atomic compare and
+ * swap), so threads don't need locks. En passant captures and castling are not considered.
+ */
+class BitbaseGenerator
+{
+public:
+    /**
+     * Names of all materials with up to maxPieces pieces (kings included) in the order they have
+     * to be generated: captures and promotions only lead to bitbases earlier in the list.
+     */
+    static std::vector<std::string> getNames(unsigned int maxPieces = Bitbase::maxPieces);
+
+    /**
+     * @param bitbases Must contain bitbases of all materials reachable by a capture or promotion.
+     * @param threads Number of threads used.
+     *
+     * @return Empty optional if name is not valid or a bitbase is missing, errors are logged.
+     */
+    static std::optional<Bitbase> generate(std::string_view name, const Bitbases& bitbases,
+                                           unsigned int threads);
+};
+
+} // namespace chessAi
@@ -0,0 +1,85 @@
+#include "BookBuilder.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace chessAi
+{
+
+size_t BookBuilder::KeyHash::operator()(const std::pair<uint64_t, uint16_t>& key) const
+{
+    // Zobrist keys are already random, mix in the move.
+    return static_cast<size_t>(key.first ^
+                               (static_cast<uint64_t>(key.second) * 0x9E3779B97F4A7C15ULL));
+}
+
+void BookBuilder::addMove(uint64_t zobristKey, Move move, PieceColor color, GameResult result)
+{
+    auto& statistics = m_moves[{zobristKey, OpeningBook::encodeMove(move)}];
+    statistics.games++;
+
+    auto win = (color == PieceColor::White) ? GameResult::WhiteWin : GameResult::BlackWin;
+    auto loss = (color == PieceColor::White) ? GameResult::BlackWin : GameResult::WhiteWin;
+    if (result == win)
+        statistics.wins++;
+    else if (result == loss)
+        statistics.losses++;
+}
+
+void BookBuilder::merge(const BookBuilder& other)
+{
+    for (const auto& [keyAndMove, otherStatistics] : other.m_moves) {
+        auto& statistics = m_moves[keyAndMove];
+        statistics.games += otherStatistics.games;
+        statistics.wins += otherStatistics.wins;
+        statistics.losses += otherStatistics.losses;
+    }
+}
+
+std::vector<BookEntry> BookBuilder::getEntries(uint32_t minCount) const
+{
+    // Games of the most played move of each position.
+    std::unordered_map<uint64_t, uint32_t> maxGames;
+    for (const auto& [keyAndMove, statistics] : m_moves) {
+        if (statistics.games < minCount)
+            continue;
+        auto& games = maxGames[keyAndMove.first];
+        games = std::max(games, statistics.games);
+    }
+
+    std::vector<BookEntry> entries;
+    for (const auto& [keyAndMove, statistics] : m_moves) {
+        if (statistics.games < minCount)
+            continue;
+
+        BookEntry entry;
+        entry.key = keyAndMove.first;
+        entry.move = keyAndMove.second;
+        // Weights of a position with more games than fit are scaled together, so the most played
+        // move gets UINT16_MAX and the ratios between moves stay the same. Rare moves keep weight
+        // 1, they are still in the book.
+        auto positionGames = maxGames[keyAndMove.first];
+        if (positionGames <= UINT16_MAX) {
+            entry.weight = static_cast<uint16_t>(statistics.games);
+        }
+        else {
+            auto weight = std::llround(static_cast<double>(statistics.games) * UINT16_MAX /
+                                       static_cast<double>(positionGames));
+            entry.weight = static_cast<uint16_t>(std::max<long long>(weight, 1));
+        }
+
+        // Scale results down with the weight, so the score stays the same.
+        auto scale = static_cast<double>(entry.weight) / static_cast<double>(statistics.games);
+        entry.setResults(static_cast<uint32_t>(statistics.wins * scale),
+                         static_cast<uint32_t>(statistics.losses * scale));
+        entries.push_back(entry);
+    }
+    return entries;
+}
+
+size_t BookBuilder::getNumberOfMoves() const
+{
+    return m_moves.size();
+}
+
+} // namespace chessAi
@@ -0,0 +1,61 @@
+#pragma once
+
+#include "OpeningBook.h"
+#include "PieceType.h"
+
+#include <unordered_map>
+
+namespace chessAi
+{
+
+enum class GameResult
+{
+    Unknown,
+    WhiteWin,
+    BlackWin,
+    Draw
+};
+
+/**
+ * Collects how often each move was played in each position and how the games ended, then
+ * produces opening book entries.
+ * Not thread safe, use one builder per thread and merge them.
+ */
+class BookBuilder
+{
+public:
+    /**
+     * @param color Color playing the move, results are stored from its view.
+     */
+    void addMove(uint64_t zobristKey, Move move, PieceColor color,
+                 GameResult result = GameResult::Unknown);
+
+    void merge(const BookBuilder& other);
+
+    /**
+     * @param minCount Moves played less often are left out.
+     */
+    std::vector<BookEntry> getEntries(uint32_t minCount = 1) const;
+
+    size_t getNumberOfMoves() const;
+
+private:
+    struct KeyHash
+    {
+        size_t operator()(const std::pair<uint64_t, uint16_t>& key) const;
+    };
+
+private:
+    struct MoveStatistics
+    {
+        uint32_t games = 0;
+        uint32_t wins = 0;
+        uint32_t losses = 0;
+    };
+
+private:
+    // Statistics for each position and encoded move.
+    std::unordered_map<std::pair<uint64_t, uint16_t>, MoveStatistics, KeyHash> m_moves;
+};
+
+} // namespace chessAi
@@ -2,9 +2,11 @@
 #include "Evaluate.h"
 #include "Move.h"
 #include "MoveGenerator.h"
+#include "Notation.h"
 #include "OpeningBook.h"
 #include "Pawn.h"
 #include "PieceBitBoards.h"
+#include "Profiler.h"
 
 #include <algorithm>
 
@@ -12,9 +14,13 @@ namespace chessAi
 {
 
 Engine::Engine(bool useBook, const std::chrono::milliseconds& timeLimit, unsigned int depthLimit)
-    : m_useOpeningBook(useBook), m_transpositionTable(), m_depthLimit(depthLimit),
-      m_currentIterativeDepth(0), m_depthSearched(0), m_countTranspositions(0),
-      m_countMaxCheckExtensions(0), m_timer(timeLimit), m_runSearch(false)
+    : m_useOpeningBook(useBook), m_useBitbases(Bitbases::isLoaded() || Bitbases::Init()),
+      m_probeBitbases(false), m_bitbaseProbeDepth(1), m_bookPolicy(BookPolicy::WeightedRandom),
+      m_transpositionTable(), m_multiPv(1),
+      m_pvTable(s_maxPly, std::vector<Move>(s_maxPly, Move(0, 0, 0, 0))), m_pvLength(),
+      m_depthLimit(depthLimit), m_currentIterativeDepth(0), m_depthSearched(0), m_statistics(),
+      m_evalCache(std::make_shared<EvalCache>()), m_nodeLimit(0), m_timer(timeLimit),
+      m_runSearch(false), m_pondering(false), m_stopRequested(false), m_stopTime()
 {
     if (m_useOpeningBook)
         m_useOpeningBook = OpeningBook::Init();
@@ -38,12 +44,30 @@ int Engine::evaluateEndGameType(const PieceBitBoards& bitBoards, int depth,
     }
 }
 
-int Engine::quiescenceSearch(const PieceBitBoards& bitBoards, int alpha, int beta, int depth)
+int Engine::evaluateBitbaseResult(const PieceBitBoards& bitBoards, Bitbase::Result result)
 {
+    if (result == Bitbase::Result::Draw)
+        return 0;
+
+    AttackMaps attackMaps(bitBoards);
+    auto evaluation = evaluate(bitBoards, attackMaps);
+    return (result == Bitbase::Result::Win) ? Evaluate::bitbaseWinScore + evaluation
+                                            : -Evaluate::bitbaseWinScore + evaluation;
+}
+
+int Engine::quiescenceSearch(const PieceBitBoards& bitBoards, int alpha, int beta,
+                             unsigned int ply, int depth)
+{
+    CHESS_PROFILE_ZONE("quiescenceSearch");
     if (!m_runSearch)
         return Evaluate::negativeInfinity;
 
-    auto evaluation = Evaluate::getEvaluation(bitBoards);
+    m_statistics.quiescenceNodes++;
+    m_statistics.selectiveDepth = std::max(m_statistics.selectiveDepth, ply);
+    checkLimits();
+    // Computed once and shared by evaluation and check detection in move generation.
+    AttackMaps attackMaps(bitBoards);
+    auto evaluation = evaluate(bitBoards, attackMaps);
 
     if (depth == 0)
         return evaluation;
@@ -52,11 +76,13 @@ int Engine::quiescenceSearch(const PieceBitBoards& bitBoards, int alpha, int bet
         return beta;
     alpha = std::max(evaluation, alpha);
 
+    auto captures =
+        MoveGeneratorWrapper::generateLegalMoves<MoveType::Capture>(bitBoards, attackMaps);
+
     PieceBitBoards tempBoards = bitBoards;
-    for (const auto& [moveScore, move] : orderMoves(
-             MoveGeneratorWrapper::generateLegalMoves<MoveType::Capture>(bitBoards), bitBoards)) {
+    for (const auto& [moveScore, move] : orderMoves(captures, bitBoards)) {
         tempBoards.applyMove(move);
-        evaluation = -quiescenceSearch(tempBoards, -beta, -alpha, depth - 1);
+        evaluation = -quiescenceSearch(tempBoards, -beta, -alpha, ply + 1, depth - 1);
         tempBoards = bitBoards;
 
         if (evaluation >= beta)
@@ -67,19 +93,32 @@ int Engine::quiescenceSearch(const PieceBitBoards& bitBoards, int alpha, int bet
     return alpha;
 }
 
-int Engine::negamax(const PieceBitBoards& bitBoards, unsigned int depth, int alpha, int beta,
-                    unsigned int numCheckExtensions,
+int Engine::negamax(const PieceBitBoards& bitBoards, unsigned int depth, unsigned int ply,
+                    int alpha, int beta, unsigned int numCheckExtensions,
                     const std::vector<uint64_t>& zobristKeysHistory)
 {
     if (!m_runSearch)
         return Evaluate::negativeInfinity;
 
+    m_statistics.nodes++;
+    m_statistics.selectiveDepth = std::max(m_statistics.selectiveDepth, ply);
+    checkLimits();
+    clearPrincipalVariation(ply);
+
+    if (m_probeBitbases && depth >= m_bitbaseProbeDepth) {
+        auto result = Bitbases::probe(bitBoards);
+        if (result.has_value()) {
+            m_statistics.bitbaseHits++;
+            return evaluateBitbaseResult(bitBoards, *result);
+        }
+    }
+
     int previousAlpha = alpha;
 
     auto tableEval = m_transpositionTable.getEntry(bitBoards.zobristKey);
 
     if (tableEval != nullptr && tableEval->depth >= depth) {
-        m_countTranspositions++;
+        m_statistics.transpositions++;
         if (tableEval->typeOfNode == TranspositionTable::TypeOfNode::exact) {
             return tableEval->evaluation;
         }
@@ -98,7 +137,7 @@ int Engine::negamax(const PieceBitBoards& bitBoards, unsigned int depth, int alp
 
     if (depth == 0)
         // We pass alpha, beta and not -beta, -alpha because it is still our move.
-        return quiescenceSearch(bitBoards, alpha, beta);
+        return quiescenceSearch(bitBoards, alpha, beta, ply);
 
     std::vector<Move> moves = MoveGeneratorWrapper::generateLegalMoves<MoveType::Normal>(bitBoards);
 
@@ -111,6 +150,7 @@ int Engine::negamax(const PieceBitBoards& bitBoards, unsigned int depth, int alp
 
     for (const auto& [moveScore, move] : orderMoves(moves, bitBoards)) {
         tempBoards.applyMove(move);
+        clearPrincipalVariation(ply + 1);
 
         int evaluation = 0;
 
@@ -125,18 +165,22 @@ int Engine::negamax(const PieceBitBoards& bitBoards, unsigned int depth, int alp
                                 ? MoveGenerator<PieceColor::White>::isKingInCheck(tempBoards)
                                 : MoveGenerator<PieceColor::Black>::isKingInCheck(tempBoards);
             }
-            m_countMaxCheckExtensions = std::max(numCheckExtensions, m_countMaxCheckExtensions);
+            m_statistics.maxCheckExtensions =
+                std::max(numCheckExtensions, m_statistics.maxCheckExtensions);
 
             // Minus sign is needed because we evaluate the position from the perspective of current
             // move color. Good for the opponent, bad for us.
-            evaluation = -negamax(tempBoards, depth - 1 + extension, -beta, -alpha,
+            evaluation = -negamax(tempBoards, depth - 1 + extension, ply + 1, -beta, -alpha,
                                   numCheckExtensions + extension, zobristKeysHistory);
         }
 
         if (evaluation > bestEvaluation) {
             bestEvaluation = evaluation;
             bestMove = move;
-            alpha = std::max(evaluation, alpha);
+            if (evaluation > alpha) {
+                alpha = evaluation;
+                updatePrincipalVariation(ply, move);
+            }
         }
 
         if (alpha >= beta)
@@ -158,20 +202,27 @@ int Engine::negamax(const PieceBitBoards& bitBoards, unsigned int depth, int alp
 }
 
 std::pair<Move, bool> Engine::iterativeDeepening(const PieceBitBoards& bitBoards,
+                                                 const std::vector<Move>& moves,
                                                  unsigned int depth,
-                                                 const std::vector<uint64_t>& zobristKeysHistory)
+                                                 const std::vector<uint64_t>& zobristKeysHistory,
+                                                 int& bestEvaluation)
 {
-    std::vector<Move> moves = MoveGeneratorWrapper::generateLegalMoves<MoveType::Normal>(bitBoards);
-
-    int bestEvaluation = Evaluate::negativeMateScore;
+    CHESS_PROFILE_ZONE("iterativeDeepening");
+    bestEvaluation = Evaluate::negativeMateScore;
     Move bestMove(0, 0, 0, 0);
     auto foundShortestMate = false;
     PieceBitBoards tempBoards = bitBoards;
+    std::vector<PrincipalVariation> lines;
+    // Scores of the best m_multiPv moves, descending. Moves must beat the last one to be exact.
+    std::vector<int> bestScores;
 
     // Here we must guarantee that the best move from the previous iteration is searched first.
     for (const auto& [moveScore, move] : orderMoves(moves, bitBoards)) {
         tempBoards.applyMove(move);
+        clearPrincipalVariation(1);
         int evaluation = 0;
+        int alpha = (bestScores.size() < m_multiPv) ? Evaluate::negativeMateScore
+                                                    : bestScores.back();
 
         // Detect 3 fold repetition.
         if (std::count(zobristKeysHistory.begin(), zobristKeysHistory.end(),
@@ -180,8 +231,8 @@ std::pair<Move, bool> Engine::iterativeDeepening(const PieceBitBoards& bitBoards
             bool extension = (tempBoards.currentMoveColor == PieceColor::White)
                                  ? MoveGenerator<PieceColor::White>::isKingInCheck(tempBoards)
                                  : MoveGenerator<PieceColor::Black>::isKingInCheck(tempBoards);
-            evaluation = -negamax(tempBoards, depth - 1 + extension, -Evaluate::infinity,
-                                  -bestEvaluation, extension, zobristKeysHistory);
+            evaluation = -negamax(tempBoards, depth - 1 + extension, 1, -Evaluate::infinity,
+                                  -alpha, extension, zobristKeysHistory);
         }
 
         // If search was canceled, evaluation from this negamax search didn't reach leaf nodes,
@@ -189,12 +240,27 @@ std::pair<Move, bool> Engine::iterativeDeepening(const PieceBitBoards& bitBoards
         if (!m_runSearch)
             break;
 
+        // Continuation is complete only for exact scores, others are cut off anyway.
+        PrincipalVariation line;
+        line.score = evaluation;
+        line.moves.push_back(move);
+        line.moves.insert(line.moves.end(), m_pvTable[1].begin() + 1,
+                          m_pvTable[1].begin() + m_pvLength[1]);
+        lines.push_back(std::move(line));
+        bestScores.insert(std::upper_bound(bestScores.begin(), bestScores.end(), evaluation,
+                                           std::greater<int>()),
+                          evaluation);
+        if (bestScores.size() > m_multiPv)
+            bestScores.pop_back();
+
         if (evaluation > bestEvaluation) {
             bestEvaluation = evaluation;
             bestMove = move;
         }
 
-        if (bestEvaluation >= Evaluate::mateScore - static_cast<int>(m_currentIterativeDepth)) {
+        // Other lines still need an exact score in multi-PV mode.
+        if (m_multiPv == 1 &&
+            bestEvaluation >= Evaluate::mateScore - static_cast<int>(m_currentIterativeDepth)) {
             foundShortestMate = true;
             break;
         }
@@ -208,56 +274,176 @@ std::pair<Move, bool> Engine::iterativeDeepening(const PieceBitBoards& bitBoards
         m_transpositionTable.store(bitBoards.zobristKey, bestEvaluation, depth,
                                    TranspositionTable::TypeOfNode::exact, bestMove);
         CHESS_LOG_INFO("Iterative deepening depth {} search evaluation: {}", depth, bestEvaluation);
+        updatePrincipalVariations(lines);
+        reportSearchInfo();
     }
 
     return {bestMove, foundShortestMate};
 }
 
-namespace
+void Engine::updatePrincipalVariations(std::vector<PrincipalVariation>& lines)
+{
+    // Stable, so equal scores keep the search order (best move of the iteration first).
+    std::stable_sort(lines.begin(), lines.end(),
+                     [](const auto& a, const auto& b) { return a.score > b.score; });
+    if (lines.size() > m_multiPv)
+        lines.erase(lines.begin() + m_multiPv, lines.end());
+    m_principalVariations = std::move(lines);
+
+    if (m_multiPv == 1)
+        return;
+    for (size_t i = 0; i < m_principalVariations.size(); ++i) {
+        std::string moves;
+        for (auto move : m_principalVariations[i].moves)
+            moves += (moves.empty() ? "" : " ") + Notation::moveToUci(move);
+        CHESS_LOG_INFO("Line {}: score {}, {}", i + 1, m_principalVariations[i].score, moves);
+    }
+}
+
+void Engine::clearPrincipalVariation(unsigned int ply)
+{
+    if (ply < s_maxPly)
+        m_pvLength[ply] = ply;
+}
+
+void Engine::updatePrincipalVariation(unsigned int ply, Move move)
 {
+    if (ply + 1 >= s_maxPly)
+        return;
+    m_pvTable[ply][ply] = move;
+    for (unsigned int i = ply + 1; i < m_pvLength[ply + 1]; ++i)
+        m_pvTable[ply][i] = m_pvTable[ply + 1][i];
+    m_pvLength[ply] = std::max(m_pvLength[ply + 1], ply + 1);
+}
 
-std::optional<Move> getBookMove(const std::vector<Move>& movesHistory,
-                                const PieceBitBoards& bitBoards)
+void Engine::reportSearchInfo()
 {
-    try {
-        auto bookMove = OpeningBook::getBookMove(movesHistory);
+    if (!m_infoCallback)
+        return;
+
+    SearchInfo info;
+    info.depth = m_currentIterativeDepth;
+    info.selectiveDepth = m_statistics.selectiveDepth;
+    info.score = m_principalVariations.empty() ? 0 : m_principalVariations.front().score;
+    info.nodes = m_statistics.nodes + m_statistics.quiescenceNodes;
+    info.time = std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::high_resolution_clock::now() - m_searchStart);
+    info.nodesPerSecond = info.nodes * 1000 / std::max<uint64_t>(1, info.time.count());
+    info.hashFull = m_transpositionTable.getHashFull();
+    info.lines = m_principalVariations;
+    m_infoCallback(info);
+}
 
-        if (!bookMove.has_value())
-            return {};
+void Engine::filterBitbaseRootMoves(const PieceBitBoards& bitBoards, std::vector<Move>& moves)
+{
+    auto rootResult = Bitbases::probe(bitBoards);
+    if (!rootResult.has_value())
+        return;
+
+    m_statistics.bitbaseRootHit = true;
+    // Search without probes, all positions would be found in bitbases and no progress was made.
+    m_probeBitbases = false;
+    if (*rootResult == Bitbase::Result::Loss)
+        return;
+
+    auto keepsResult = [&bitBoards, &rootResult](const Move& move) {
+        PieceBitBoards child = bitBoards;
+        child.applyMove(move);
+        auto result = Bitbases::probe(child);
+        if (!result.has_value())
+            return true;
+        return (*rootResult == Bitbase::Result::Win) ? *result == Bitbase::Result::Loss
+                                                     : *result != Bitbase::Result::Win;
+    };
+    auto kept = std::stable_partition(moves.begin(), moves.end(), keepsResult);
+    m_statistics.bitbaseRootMovesExcluded = static_cast<size_t>(moves.end() - kept);
+    moves.erase(kept, moves.end());
+    CHESS_LOG_INFO("Root position in bitbases ({}), {} moves keep the result.",
+                   (*rootResult == Bitbase::Result::Win) ? "win" : "draw", moves.size());
+}
 
-        // Check if legal. Return generated move which has flags set.
-        for (const auto& generatedMove :
-             MoveGeneratorWrapper::generateLegalMoves<MoveType::Normal>(bitBoards)) {
-            SpecialMoveCompare compare(*bookMove);
-            if (compare(generatedMove))
-                return generatedMove;
+std::pair<std::optional<Move>, unsigned int> Engine::findBestMove(
+    const PieceBitBoards& bitBoards, const std::vector<uint64_t>& zobristKeysHistory)
+{
+    {
+        std::lock_guard<std::mutex> lock(m_searchMutex);
+        // Stopped before the search started.
+        if (m_stopRequested) {
+            m_stopRequested = false;
+            m_pondering = false;
+            m_statistics = SearchStatistics();
+            m_principalVariations.clear();
+            return {std::nullopt, 0};
         }
-        CHESS_LOG_WARN("Book move is not legal.");
-        return {};
+        m_runSearch = true;
+        m_timer.resetStartTime();
     }
-    catch (const std::exception& ex) {
-        CHESS_LOG_ERROR("Unhandled error when getting book move: {}", ex.what());
-        return {};
+    m_searchStart = std::chrono::high_resolution_clock::now();
+
+    auto result = searchBestMove(bitBoards, zobristKeysHistory);
+
+    std::lock_guard<std::mutex> lock(m_searchMutex);
+    if (m_stopRequested) {
+        m_statistics.stopLatency = std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now() - m_stopTime);
+        CHESS_LOG_INFO("Search stopped, latency {} us", m_statistics.stopLatency.count());
     }
+    m_runSearch = false;
+    m_stopRequested = false;
+    m_pondering = false;
+    return result;
 }
 
-} // namespace
-
-std::pair<std::optional<Move>, unsigned int> Engine::findBestMove(
-    const PieceBitBoards& bitBoards, const std::vector<uint64_t>& zobristKeysHistory,
-    const std::vector<Move>& movesHistory)
+std::pair<std::optional<Move>, unsigned int> Engine::searchBestMove(
+    const PieceBitBoards& bitBoards, const std::vector<uint64_t>& zobristKeysHistory)
 {
     CHESS_LOG_INFO("Half move count: {}", bitBoards.halfMoveCount);
 
+    m_statistics = SearchStatistics();
+    m_principalVariations.clear();
     if (m_useOpeningBook) {
-        auto move = getBookMove(movesHistory, bitBoards);
-        if (move.has_value())
+        auto bookStart = std::chrono::high_resolution_clock::now();
+        auto entries = OpeningBook::getEntries(bitBoards.zobristKey);
+        std::optional<Move> move;
+        if (!entries.empty())
+            move = OpeningBook::decodeMove(OpeningBook::selectEntry(entries, m_bookPolicy).move,
+                                           bitBoards);
+
+        m_statistics.bookMoves = entries.size();
+        m_statistics.bookLookupTime = std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::high_resolution_clock::now() - bookStart);
+        if (move.has_value()) {
+            m_statistics.bookMovePlayed = true;
+            CHESS_LOG_INFO("Book move played ({} book moves, lookup {} us).", entries.size(),
+                           m_statistics.bookLookupTime.count());
             return {*move, 0};
+        }
+        if (!entries.empty())
+            CHESS_LOG_WARN("Book move is not legal.");
     }
 
-    m_runSearch = true;
-    m_timer.resetStartTime();
-    m_timerThread = std::thread(&Engine::runTimer, this);
+    std::vector<Move> rootMoves =
+        MoveGeneratorWrapper::generateLegalMoves<MoveType::Normal>(bitBoards);
+    if (rootMoves.empty()) {
+        // Positions without kings have no moves either (error logged by move generation).
+        if (bitBoards.whiteKingPositions.empty() || bitBoards.blackKingPositions.empty())
+            return {std::nullopt, 0};
+        bool inCheck = bitBoards.currentMoveColor == PieceColor::White
+                           ? MoveGenerator<PieceColor::White>::isKingInCheck(bitBoards)
+                           : MoveGenerator<PieceColor::Black>::isKingInCheck(bitBoards);
+        m_statistics.checkmate = inCheck;
+        m_statistics.stalemate = !inCheck;
+        m_statistics.score = inCheck ? Evaluate::negativeMateScore : 0;
+        CHESS_LOG_INFO("No legal moves, {}.", inCheck ? "checkmate" : "stalemate");
+        return {std::nullopt, 0};
+    }
+    m_probeBitbases = m_useBitbases;
+    if (m_useBitbases)
+        filterBitbaseRootMoves(bitBoards, rootMoves);
+    if (m_statistics.bitbaseRootHit && rootMoves.size() == 1) {
+        CHESS_LOG_INFO("Only bitbase move played.");
+        return {rootMoves.front(), 0};
+    }
 
     Move bestMove(0, 0, 0, 0);
 
@@ -266,8 +452,9 @@ std::pair<std::optional<Move>, unsigned int> Engine::findBestMove(
         if (!m_runSearch)
             break;
         m_currentIterativeDepth = depth;
+        int evaluation = 0;
         auto [bestMoveThisIteration, isShortestMate] =
-            iterativeDeepening(bitBoards, depth, zobristKeysHistory);
+            iterativeDeepening(bitBoards, rootMoves, depth, zobristKeysHistory, evaluation);
 
         m_depthSearched = depth;
         // We can update previous move even if search was canceled, because best move from
@@ -277,14 +464,30 @@ std::pair<std::optional<Move>, unsigned int> Engine::findBestMove(
         if (bestMoveThisIteration == Move(0, 0, 0, 0))
             continue;
         bestMove = bestMoveThisIteration;
+        m_statistics.score = evaluation;
         if (isShortestMate)
             break;
     }
 
-    CHESS_LOG_INFO("Number of transpositions: {}", m_countTranspositions);
-    CHESS_LOG_INFO("Number of max check extension: {}", m_countMaxCheckExtensions);
-    m_runSearch = false;
-    m_timerThread.join();
+    m_statistics.time = std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::high_resolution_clock::now() - m_searchStart);
+
+    CHESS_LOG_INFO("Number of transpositions: {}", m_statistics.transpositions);
+    CHESS_LOG_INFO("Number of max check extension: {}", m_statistics.maxCheckExtensions);
+    CHESS_LOG_INFO("Nodes: {}, quiescence nodes: {}", m_statistics.nodes,
+                   m_statistics.quiescenceNodes);
+    if (m_statistics.bitbaseHits > 0)
+        CHESS_LOG_INFO("Bitbase hits: {}", m_statistics.bitbaseHits);
+    if (m_statistics.bitbaseRootMovesExcluded > 0)
+        CHESS_LOG_INFO("Root moves excluded by bitbases: {}",
+                       m_statistics.bitbaseRootMovesExcluded);
+    if (m_statistics.evalCacheProbes > 0)
+        CHESS_LOG_INFO("Eval cache hit rate: {:.1f} %",
+                       100.0 * static_cast<double>(m_statistics.evalCacheHits) /
+                           static_cast<double>(m_statistics.evalCacheProbes));
+    // Search stopped before the first iteration finished.
+    if (bestMove == Move(0, 0, 0, 0))
+        return {std::nullopt, m_depthSearched};
     return {bestMove, m_depthSearched};
 }
 
@@ -333,6 +536,7 @@ void pawnDefendedScore(Move move, int& moveScore, const PieceBitBoards& boards,
 [[nodiscard]] std::multimap<int, Move, std::greater<int>> Engine::orderMoves(
     const std::vector<Move>& moves, const PieceBitBoards& boards, bool useTranspositions)
 {
+    CHESS_PROFILE_ZONE("orderMoves");
     Move bestMove(0, 0, 0, 0);
 
     // Important so best move from previous search is searched first.
@@ -373,16 +577,114 @@ void pawnDefendedScore(Move move, int& moveScore, const PieceBitBoards& boards,
     return sortedMoves;
 }
 
-void Engine::runTimer()
+int Engine::evaluate(const PieceBitBoards& bitBoards, const AttackMaps& attackMaps)
 {
-    // Check in case it is modified elsewhere.
-    while (m_runSearch) {
-        if (m_timer.timeUp()) {
-            m_runSearch = false;
-            return;
-        }
-        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    CHESS_PROFILE_ZONE("evaluate");
+    if (m_evalCache == nullptr)
+        return Evaluate::getEvaluation(bitBoards, attackMaps);
+
+    m_statistics.evalCacheProbes++;
+    auto cached = m_evalCache->probe(bitBoards.zobristKey);
+    if (cached.has_value()) {
+        m_statistics.evalCacheHits++;
+        return *cached;
     }
+
+    auto evaluation = Evaluate::getEvaluation(bitBoards, attackMaps);
+    m_evalCache->store(bitBoards.zobristKey, evaluation);
+    return evaluation;
+}
+
+void Engine::setEvalCache(std::shared_ptr<EvalCache> evalCache)
+{
+    m_evalCache = std::move(evalCache);
+}
+
+void Engine::setBookPolicy(BookPolicy policy)
+{
+    m_bookPolicy = policy;
+}
+
+void Engine::setNodeLimit(uint64_t nodeLimit)
+{
+    m_nodeLimit = nodeLimit;
+}
+
+void Engine::setDepthLimit(unsigned int depthLimit)
+{
+    m_depthLimit = depthLimit;
+}
+
+void Engine::setMultiPv(unsigned int count)
+{
+    m_multiPv = std::max(1u, count);
+}
+
+const std::vector<Engine::PrincipalVariation>& Engine::getPrincipalVariations() const
+{
+    return m_principalVariations;
+}
+
+void Engine::setInfoCallback(InfoCallback callback)
+{
+    m_infoCallback = std::move(callback);
+}
+
+void Engine::setBitbaseProbeDepth(unsigned int depth)
+{
+    m_bitbaseProbeDepth = depth;
+}
+
+const Engine::SearchStatistics& Engine::getSearchStatistics() const
+{
+    return m_statistics;
+}
+
+void Engine::prepareSearch(bool pondering)
+{
+    std::lock_guard<std::mutex> lock(m_searchMutex);
+    m_stopRequested = false;
+    m_pondering = pondering;
+}
+
+void Engine::ponderHit()
+{
+    std::lock_guard<std::mutex> lock(m_searchMutex);
+    if (!m_pondering)
+        return;
+    // Timer is written before the search sees the end of pondering and starts reading it.
+    m_timer.resetStartTime();
+    m_pondering = false;
+}
+
+void Engine::stop()
+{
+    std::lock_guard<std::mutex> lock(m_searchMutex);
+    if (!m_stopRequested)
+        m_stopTime = std::chrono::steady_clock::now();
+    m_stopRequested = true;
+    m_runSearch = false;
+}
+
+void Engine::newGame()
+{
+    m_transpositionTable.clear();
+}
+
+void Engine::setTimeLimit(std::chrono::milliseconds timeLimit)
+{
+    m_timer.setTimeLimit(timeLimit);
+}
+
+void Engine::checkLimits()
+{
+    auto nodes = m_statistics.nodes + m_statistics.quiescenceNodes;
+    if (m_nodeLimit != 0 && nodes >= m_nodeLimit)
+        m_runSearch = false;
+    // Reading the clock in every node would slow down search. Pondering search has no time limit
+    // until the expected move is played.
+    if (nodes % s_timeCheckInterval == 0 && !m_pondering && m_timer.timeUp())
+        m_runSearch = false;
 }
 
 Timer::Timer(std::chrono::milliseconds timeLimit)
@@ -396,6 +698,16 @@ bool Timer::timeUp() const
                std::chrono::high_resolution_clock::now() - m_startTime) >= m_timeLimit;
 }
 
+std::chrono::time_point<std::chrono::high_resolution_clock> Timer::getEndTime() const
+{
+    return m_startTime + m_timeLimit;
+}
+
+void Timer::setTimeLimit(std::chrono::milliseconds timeLimit)
+{
+    m_timeLimit = timeLimit;
+}
+
 void Timer::resetStartTime()
 {
     m_startTime = std::chrono::high_resolution_clock::now();
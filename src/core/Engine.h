@@ -1,10 +1,20 @@
 #pragma once
 
+#include "Bitbase.h"
+#include "EvalCache.h"
 #include "Move.h"
+#include "OpeningBook.h"
 #include "TranspositionTable.h"
 
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <functional>
 #include <map>
+#include <memory>
+#include <mutex>
 #include <optional>
+#include <vector>
 
 namespace chessAi
 {
@@ -13,14 +23,17 @@ class Timer
 {
 public:
     Timer(std::chrono::milliseconds timeLimit);
+    void setTimeLimit(std::chrono::milliseconds timeLimit);
     void resetStartTime();
     bool timeUp() const;
+    std::chrono::time_point<std::chrono::high_resolution_clock> getEndTime() const;
 
 private:
     std::chrono::milliseconds m_timeLimit;
     std::chrono::time_point<std::chrono::high_resolution_clock> m_startTime;
 };
 
+struct AttackMaps;
 struct PieceBitBoards;
 
 /**
@@ -30,11 +43,103 @@ struct PieceBitBoards;
  *      Alpha-Beta pruning with move ordering.
  *      Transposition tables (Zobrist hashing).
  *      Iterative deepening.
+ *      Endgame bitbases, if available: the ones loaded with Bitbases::Init before the engine is
+ *      created, or from the default directory if none are loaded. Probed in search and at the
+ *      root, where only moves keeping the result are searched.
  *
  * Evaluation is done with Evaluate class.
  */
 class Engine
 {
+public:
+    /**
+     * Counters of the last findBestMove call.
+     */
+    struct SearchStatistics
+    {
+        /**
+         * Evaluation of the best move from the view of the side to move.
+         */
+        int score = 0;
+        uint64_t nodes = 0;
+        uint64_t quiescenceNodes = 0;
+        uint64_t transpositions = 0;
+        uint64_t evalCacheProbes = 0;
+        uint64_t evalCacheHits = 0;
+        unsigned int maxCheckExtensions = 0;
+        /**
+         * Highest ply reached, quiescence search included.
+         */
+        unsigned int selectiveDepth = 0;
+        /**
+         * Nodes resolved by a bitbase probe.
+         */
+        uint64_t bitbaseHits = 0;
+        /**
+         * Root position was found in bitbases, search is then done without probes.
+         */
+        bool bitbaseRootHit = false;
+        /**
+         * Root moves not searched, because they change the bitbase result.
+         */
+        size_t bitbaseRootMovesExcluded = 0;
+        /**
+         * Number of book moves in the position, search is skipped if there are any.
+         */
+        size_t bookMoves = 0;
+        bool bookMovePlayed = false;
+        std::chrono::microseconds bookLookupTime{0};
+        std::chrono::milliseconds time{0};
+        /**
+         * Time from stop() to the return of findBestMove, zero if the search wasn't stopped.
+         */
+        std::chrono::microseconds stopLatency{0};
+        /**
+         * Side to move has no legal moves, no move is returned. Score is a mate score for
+         * checkmate and 0 for stalemate.
+         */
+        bool checkmate = false;
+        bool stalemate = false;
+    };
+
+    /**
+     * Root move with its score and expected continuation, moves[0] is the root move.
+     */
+    struct PrincipalVariation
+    {
+        int score = 0;
+        std::vector<Move> moves;
+    };
+
+    /**
+     * Progress of the search, reported after every completed iteration.
+     */
+    struct SearchInfo
+    {
+        unsigned int depth = 0;
+        unsigned int selectiveDepth = 0;
+        /**
+         * Score of the best line from the view of the side to move.
+         */
+        int score = 0;
+        /**
+         * Nodes including quiescence nodes.
+         */
+        uint64_t nodes = 0;
+        uint64_t nodesPerSecond = 0;
+        /**
+         * Used part of the transposition table in permille.
+         */
+        unsigned int hashFull = 0;
+        std::chrono::milliseconds time{0};
+        /**
+         * Best lines, more than one in multi-PV mode.
+         */
+        std::vector<PrincipalVariation> lines;
+    };
+
+    using InfoCallback = std::function<void(const SearchInfo&)>;
+
 public:
     /**
      * Engine that terminates search at depth or time limit. Which ever is reached first.
@@ -44,14 +149,93 @@ public:
 
     /**
      * @param zobristKeysHistory Used to detect 3 fold repetition.
-     * @param movesHistory Used for book moves.
      *
      * @return Best move and depth to which the search was done.
-     * Depth search is from iterative deepening.
+     * Depth search is from iterative deepening. No move if the side to move has no legal moves
+     * (see SearchStatistics::checkmate and stalemate) or the search was stopped before the first
+     * iteration finished.
      */
     std::pair<std::optional<Move>, unsigned int> findBestMove(
-        const PieceBitBoards& bitBoards, const std::vector<uint64_t>& zobristKeysHistory,
-        const std::vector<Move>& movesHistory);
+        const PieceBitBoards& bitBoards, const std::vector<uint64_t>& zobristKeysHistory);
+
+    /**
+     * Resets stop requests and sets whether the next findBestMove is pondering: searching the
+     * position after the expected reply of the opponent, without time limit until ponderHit. Call
+     * before the search starts, from the thread that calls stop and ponderHit, so they can't come
+     * before the search (see EngineWorker).
+     */
+    void prepareSearch(bool pondering);
+
+    /**
+     * Opponent played the expected move. Pondering search continues as normal search, with the
+     * whole time limit counted from now. Thread safe.
+     */
+    void ponderHit();
+
+    /**
+     * Stops the running search, findBestMove returns the best move found so far. If no search
+     * is running, the next one returns at once without a move, unless prepareSearch is called
+     * first. Thread safe.
+     */
+    void stop();
+
+    /**
+     * Forgets searched positions (transposition table) from the previous game.
+     */
+    void newGame();
+
+    /**
+     * Time limit of the following searches.
+     */
+    void setTimeLimit(std::chrono::milliseconds timeLimit);
+
+    /**
+     * Share evaluation cache between engines (for example engines searching in different
+     * threads). Set to nullptr to disable caching of static evaluations.
+     */
+    void setEvalCache(std::shared_ptr<EvalCache> evalCache);
+
+    /**
+     * How book moves are chosen, BookPolicy::WeightedRandom by default.
+     */
+    void setBookPolicy(BookPolicy policy);
+
+    /**
+     * Search stops after this many nodes (quiescence nodes included), in addition to the depth
+     * and time limit. 0 for no limit.
+     */
+    void setNodeLimit(uint64_t nodeLimit);
+
+    /**
+     * Maximum depth of iterative deepening of the following searches.
+     */
+    void setDepthLimit(unsigned int depthLimit);
+
+    /**
+     * Number of best root moves searched with exact scores (multi-PV), 1 by default. Other root
+     * moves are only proven worse than these, so search gets slower with more lines.
+     */
+    void setMultiPv(unsigned int count);
+
+    /**
+     * Best root moves from the last completed iteration of the last search, best first. Up to
+     * setMultiPv lines, empty if a book move or the only move keeping bitbase result was played.
+     */
+    const std::vector<PrincipalVariation>& getPrincipalVariations() const;
+
+    /**
+     * Called from the searching thread after every completed iteration of findBestMove. Callback
+     * should return quickly, search waits for it. Empty function disables it.
+     */
+    void setInfoCallback(InfoCallback callback);
+
+    /**
+     * Bitbases are probed in negamax nodes with at least this remaining depth, 1 by default.
+     * Higher depth probes less often, which is faster if bitbase files are not in memory.
+     */
+    void setBitbaseProbeDepth(unsigned int depth);
+
+    const SearchStatistics& getSearchStatistics() const;
 
 private:
     /**
@@ -60,19 +244,49 @@ private:
      *
      * If search is canceled during the search, return positive or negative infinity evaluation.
      */
-    int negamax(const PieceBitBoards& bitBoards, unsigned int depth, int alpha, int beta,
-                unsigned int numCheckExtensions, const std::vector<uint64_t>& zobristKeysHistory);
+    int negamax(const PieceBitBoards& bitBoards, unsigned int depth, unsigned int ply, int alpha,
+                int beta, unsigned int numCheckExtensions,
+                const std::vector<uint64_t>& zobristKeysHistory);
 
     /**
-     * Run iterative deepening, with ordered moves from previous search.
+     * Run iterative deepening of the root moves, with ordered moves from previous search.
      * Return best move and true if move is shortest mate.
      *
      * Because we order moves, best move from previous search is searched first. In that case we can
      * update best move even if search for this iteration depth was not completed fully. Current
      * move is better than previous best move.
      */
-    std::pair<Move, bool> iterativeDeepening(const PieceBitBoards& bitBoards, unsigned int depth,
-                                             const std::vector<uint64_t>& zobristKeysHistory);
+    std::pair<Move, bool> iterativeDeepening(const PieceBitBoards& bitBoards,
+                                             const std::vector<Move>& moves, unsigned int depth,
+                                             const std::vector<uint64_t>& zobristKeysHistory,
+                                             int& bestEvaluation);
+
+    /**
+     * Sorts lines of the root moves and keeps the best m_multiPv of them as principal variations.
+     */
+    void updatePrincipalVariations(std::vector<PrincipalVariation>& lines);
+
+    /**
+     * Starts empty principal variation at the ply, before the node is searched.
+     */
+    void clearPrincipalVariation(unsigned int ply);
+
+    /**
+     * Move raised alpha at the ply, principal variation is the move followed by the one of the
+     * next ply.
+     */
+    void updatePrincipalVariation(unsigned int ply, Move move);
+
+    /**
+     * Calls info callback with the current iteration.
+     */
+    void reportSearchInfo();
+
+    /**
+     * If the root position is in bitbases, removes moves that don't keep its result (win or
+     * draw) and disables probes in search, so search looks for the fastest way to keep it.
+     */
+    void filterBitbaseRootMoves(const PieceBitBoards& bitBoards, std::vector<Move>& moves);
 
     /**
      * Order from best to worst. We can (hopefully) prune more
@@ -90,25 +304,72 @@ private:
     int evaluateEndGameType(const PieceBitBoards& boards, int depth,
                             unsigned int numCheckExtensions);
 
+    /**
+     * Score of a position found in bitbases.
+     */
+    int evaluateBitbaseResult(const PieceBitBoards& bitBoards, Bitbase::Result result);
+
     /**
      * Search position until quite and then return evaluation. Depth is the limit of captures
      * search.
      */
-    int quiescenceSearch(const PieceBitBoards& bitBoards, int alpha, int beta, int depth = 20);
+    int quiescenceSearch(const PieceBitBoards& bitBoards, int alpha, int beta, unsigned int ply,
+                         int depth = 20);
+
+    /**
+     * Static evaluation, looked up in evaluation cache first.
+     */
+    int evaluate(const PieceBitBoards& bitBoards, const AttackMaps& attackMaps);
+
+    /**
+     * findBestMove without handling of stop requests.
+     */
+    std::pair<std::optional<Move>, unsigned int> searchBestMove(
+        const PieceBitBoards& bitBoards, const std::vector<uint64_t>& zobristKeysHistory);
 
-    void runTimer();
+    /**
+     * Stops search when node limit is reached or time is up. Time starts with ponder hit when
+     * pondering.
+     */
+    void checkLimits();
 
 private:
     bool m_useOpeningBook;
+    bool m_useBitbases;
+    bool m_probeBitbases;
+    unsigned int m_bitbaseProbeDepth;
+    BookPolicy m_bookPolicy;
     TranspositionTable m_transpositionTable;
+    unsigned int m_multiPv;
+    std::vector<PrincipalVariation> m_principalVariations;
+    /**
+     * Triangular principal variation table, m_pvTable[ply] holds moves from ply to
+     * m_pvLength[ply] of the best line found at the ply.
+     */
+    inline static constexpr unsigned int s_maxPly = 128;
+    std::vector<std::vector<Move>> m_pvTable;
+    std::array<unsigned int, s_maxPly> m_pvLength;
+    InfoCallback m_infoCallback;
     unsigned int m_depthLimit;
     unsigned int m_currentIterativeDepth;
     unsigned int m_depthSearched;
-    unsigned int m_countTranspositions;
-    unsigned int m_countMaxCheckExtensions;
+    SearchStatistics m_statistics;
+    std::shared_ptr<EvalCache> m_evalCache;
+    uint64_t m_nodeLimit;
     Timer m_timer;
-    std::thread m_timerThread;
+    std::chrono::high_resolution_clock::time_point m_searchStart;
+    /**
+     * Clock is read once per this many nodes.
+     */
+    inline static constexpr uint64_t s_timeCheckInterval = 1024;
+    std::mutex m_searchMutex;
     std::atomic<bool> m_runSearch;
+    /**
+     * Search has no time limit. Written under m_searchMutex as m_stopRequested.
+     */
+    std::atomic<bool> m_pondering;
+    bool m_stopRequested;
+    std::chrono::steady_clock::time_point m_stopTime;
 };
 
 } // namespace chessAi
\ No newline at end of file
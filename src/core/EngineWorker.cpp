@@ -0,0 +1,234 @@
+#include "EngineWorker.h"
+
+namespace chessAi
+{
+
+EngineWorker::EngineWorker(bool useBook, const std::chrono::milliseconds& timeLimit,
+                           unsigned int depthLimit)
+    : m_engine(useBook, timeLimit, depthLimit), m_current(std::nullopt), m_currentId(0),
+      m_lastId(0), m_stopped(false), m_quit(false), m_thread(&EngineWorker::run, this)
+{
+}
+
+EngineWorker::~EngineWorker()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_quit = true;
+    }
+    stop();
+    m_requestAdded.notify_one();
+    m_thread.join();
+}
+
+unsigned int EngineWorker::search(const PieceBitBoards& bitBoards,
+                                  const std::vector<uint64_t>& zobristKeysHistory,
+                                  ResultCallback callback, Engine::InfoCallback progress)
+{
+    Request request;
+    request.type = Request::Type::Search;
+    request.bitBoards = bitBoards;
+    request.zobristKeysHistory = zobristKeysHistory;
+    request.callback = std::move(callback);
+    request.progress = std::move(progress);
+    return addRequest(std::move(request));
+}
+
+SearchHandle EngineWorker::startSearch(const PieceBitBoards& bitBoards,
+                                       const std::vector<uint64_t>& zobristKeysHistory,
+                                       Engine::InfoCallback progress)
+{
+    auto promise = std::make_shared<std::promise<Result>>();
+    std::shared_future<Result> future = promise->get_future().share();
+    auto request = search(
+        bitBoards, zobristKeysHistory,
+        [promise](const Result& result) { promise->set_value(result); }, std::move(progress));
+    return SearchHandle(*this, request, std::move(future));
+}
+
+unsigned int EngineWorker::ponder(const PieceBitBoards& bitBoards,
+                                  const std::vector<uint64_t>& zobristKeysHistory,
+                                  ResultCallback callback)
+{
+    Request request;
+    request.type = Request::Type::Ponder;
+    request.bitBoards = bitBoards;
+    request.zobristKeysHistory = zobristKeysHistory;
+    request.callback = std::move(callback);
+    return addRequest(std::move(request));
+}
+
+void EngineWorker::ponderHit()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    for (auto& request : m_requests) {
+        if (request.type == Request::Type::Ponder)
+            request.type = Request::Type::Search;
+    }
+    if (m_current == Request::Type::Ponder) {
+        m_current = Request::Type::Search;
+        m_engine.ponderHit();
+    }
+}
+
+void EngineWorker::stop()
+{
+    stopRequests([](unsigned int) { return true; });
+}
+
+void EngineWorker::stop(unsigned int request)
+{
+    stopRequests([request](unsigned int id) { return id == request; });
+}
+
+void EngineWorker::newGame()
+{
+    post([](Engine& engine) { engine.newGame(); });
+}
+
+void EngineWorker::post(std::function<void(Engine&)> function)
+{
+    Request request;
+    request.type = Request::Type::Function;
+    request.function = std::move(function);
+    addRequest(std::move(request));
+}
+
+void EngineWorker::wait()
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_idle.wait(lock, [this]() { return m_requests.empty() && !m_current.has_value(); });
+}
+
+unsigned int EngineWorker::addRequest(Request request)
+{
+    unsigned int id = 0;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        id = ++m_lastId;
+        request.id = id;
+        m_requests.push_back(std::move(request));
+    }
+    m_requestAdded.notify_one();
+    return id;
+}
+
+void EngineWorker::stopRequests(const std::function<bool(unsigned int)>& isStopped)
+{
+    std::deque<Request> dropped;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        std::deque<Request> kept;
+        for (auto& request : m_requests) {
+            if (request.type != Request::Type::Function && isStopped(request.id))
+                dropped.push_back(std::move(request));
+            else
+                kept.push_back(std::move(request));
+        }
+        m_requests = std::move(kept);
+
+        // Engine was prepared for the search when it was taken from the queue, stop can't be
+        // lost or stop the following search.
+        if ((m_current == Request::Type::Search || m_current == Request::Type::Ponder) &&
+            isStopped(m_currentId)) {
+            m_stopped = true;
+            m_engine.stop();
+        }
+        if (m_requests.empty() && !m_current.has_value())
+            m_idle.notify_all();
+    }
+
+    Result result;
+    result.stopped = true;
+    for (const auto& request : dropped) {
+        if (request.callback)
+            request.callback(result);
+    }
+}
+
+void EngineWorker::run()
+{
+    while (true) {
+        Request request;
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_requestAdded.wait(lock, [this]() { return m_quit || !m_requests.empty(); });
+            if (m_quit)
+                return;
+            request = std::move(m_requests.front());
+            m_requests.pop_front();
+            m_current = request.type;
+            m_currentId = request.id;
+            m_stopped = false;
+            if (request.type != Request::Type::Function)
+                m_engine.prepareSearch(request.type == Request::Type::Ponder);
+        }
+
+        if (request.type == Request::Type::Function) {
+            request.function(m_engine);
+        }
+        else {
+            m_engine.setInfoCallback(request.progress);
+            auto result = search(request);
+            m_engine.setInfoCallback(nullptr);
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                result.stopped = m_stopped;
+            }
+            if (request.callback)
+                request.callback(result);
+        }
+
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_current = std::nullopt;
+        m_currentId = 0;
+        if (m_requests.empty())
+            m_idle.notify_all();
+    }
+}
+
+EngineWorker::Result EngineWorker::search(const Request& request)
+{
+    Result result;
+    auto [move, depth] = m_engine.findBestMove(request.bitBoards, request.zobristKeysHistory);
+    result.move = move;
+    result.depth = depth;
+    result.statistics = m_engine.getSearchStatistics();
+    result.lines = m_engine.getPrincipalVariations();
+    if (!result.lines.empty() && result.lines.front().moves.size() > 1)
+        result.ponderMove = result.lines.front().moves[1];
+    return result;
+}
+
+SearchHandle::SearchHandle(EngineWorker& worker, unsigned int request,
+                           std::shared_future<EngineWorker::Result> result)
+    : m_worker(&worker), m_request(request), m_result(std::move(result))
+{
+}
+
+void SearchHandle::stop()
+{
+    m_worker->stop(m_request);
+}
+
+bool SearchHandle::isReady() const
+{
+    return waitFor(std::chrono::milliseconds(0));
+}
+
+bool SearchHandle::waitFor(std::chrono::milliseconds timeout) const
+{
+    return m_result.wait_for(timeout) == std::future_status::ready;
+}
+
+const EngineWorker::Result& SearchHandle::get() const
+{
+    return m_result.get();
+}
+
+const std::shared_future<EngineWorker::Result>& SearchHandle::getFuture() const
+{
+    return m_result;
+}
+
+} // namespace chessAi
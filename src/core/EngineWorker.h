@@ -0,0 +1,206 @@
+#pragma once
+
+#include "Engine.h"
+#include "PieceBitBoards.h"
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <future>
+#include <mutex>
+#include <thread>
+
+namespace chessAi
+{
+
+class SearchHandle;
+
+/**
+ * Engine running in one long-lived thread, reused for every move and game, so no thread is
+ * created per search and the transposition table and caches stay allocated and warm.
+ *
+ * Requests are queued and run in order. Results are passed to callbacks called from the worker
+ * thread, callbacks should only store them (for example for the GUI thread to pick up), or to
+ * futures of search handles (see startSearch).
+ */
+class EngineWorker
+{
+public:
+    struct Result
+    {
+        std::optional<Move> move;
+        unsigned int depth = 0;
+        /**
+         * Expected reply of the opponent (second move of the principal variation), to ponder on.
+         */
+        std::optional<Move> ponderMove;
+        Engine::SearchStatistics statistics;
+        std::vector<Engine::PrincipalVariation> lines;
+        /**
+         * Search was stopped with stop() (result of a pondering search that missed) or dropped
+         * from the queue before it started.
+         */
+        bool stopped = false;
+    };
+
+    using ResultCallback = std::function<void(const Result&)>;
+
+public:
+    /**
+     * Creates engine (see Engine constructor) and starts the worker thread.
+     */
+    EngineWorker(bool useBook, const std::chrono::milliseconds& timeLimit,
+                 unsigned int depthLimit = 100);
+
+    /**
+     * Stops running search, drops queued requests and joins the worker thread.
+     */
+    ~EngineWorker();
+
+    EngineWorker(const EngineWorker&) = delete;
+    EngineWorker& operator=(const EngineWorker&) = delete;
+
+    /**
+     * Queues search of the best move in the position, as Engine::findBestMove. Progress callback
+     * is set as engine info callback for this search (called from the worker thread after every
+     * iteration).
+     *
+     * @return Id of the request, for stop(request).
+     */
+    unsigned int search(const PieceBitBoards& bitBoards,
+                        const std::vector<uint64_t>& zobristKeysHistory, ResultCallback callback,
+                        Engine::InfoCallback progress = nullptr);
+
+    /**
+     * Queues search as search(), result is passed to the future of the returned handle.
+     */
+    SearchHandle startSearch(const PieceBitBoards& bitBoards,
+                             const std::vector<uint64_t>& zobristKeysHistory,
+                             Engine::InfoCallback progress = nullptr);
+
+    /**
+     * Queues pondering search, without time limit until ponderHit() or stop(). Position is
+     * usually the one after Result::ponderMove.
+     *
+     * @return Id of the request, for stop(request).
+     */
+    unsigned int ponder(const PieceBitBoards& bitBoards,
+                        const std::vector<uint64_t>& zobristKeysHistory, ResultCallback callback);
+
+    /**
+     * Opponent played the expected move, pondering search (running or queued) becomes a normal
+     * search with the whole time limit from now. Its callback gets the move.
+     */
+    void ponderHit();
+
+    /**
+     * Drops queued searches and stops the running one. Callbacks of dropped searches are called
+     * from this thread, the stopped search calls its callback from the worker thread once search
+     * unwinds (see Engine::SearchStatistics::stopLatency). Both get Result::stopped set.
+     */
+    void stop();
+
+    /**
+     * Stops one search as stop(), other requests are kept.
+     */
+    void stop(unsigned int request);
+
+    /**
+     * Queues clearing of the transposition table before the next game.
+     */
+    void newGame();
+
+    /**
+     * Queues function called from the worker thread with the engine, to change its settings
+     * between searches (time limit, multi-PV, ...).
+     */
+    void post(std::function<void(Engine&)> function);
+
+    /**
+     * Blocks until all queued requests are done.
+     */
+    void wait();
+
+private:
+    struct Request
+    {
+        enum class Type
+        {
+            Search,
+            Ponder,
+            Function
+        };
+
+        unsigned int id = 0;
+        Type type = Type::Function;
+        PieceBitBoards bitBoards;
+        std::vector<uint64_t> zobristKeysHistory;
+        ResultCallback callback;
+        Engine::InfoCallback progress;
+        std::function<void(Engine&)> function;
+    };
+
+    unsigned int addRequest(Request request);
+
+    /**
+     * Removes queued searches with stopped ids and stops the current one if its id is stopped.
+     */
+    void stopRequests(const std::function<bool(unsigned int)>& isStopped);
+
+    void run();
+
+    Result search(const Request& request);
+
+private:
+    Engine m_engine;
+    std::mutex m_mutex;
+    std::condition_variable m_requestAdded;
+    std::condition_variable m_idle;
+    std::deque<Request> m_requests;
+    /**
+     * Type of the request taken from the queue and not finished yet.
+     */
+    std::optional<Request::Type> m_current;
+    unsigned int m_currentId;
+    unsigned int m_lastId;
+    bool m_stopped;
+    bool m_quit;
+    std::thread m_thread;
+};
+
+/**
+ * Search queued in EngineWorker. Result is available through the future once the search ends,
+ * also when it was stopped. Worker must outlive calls of stop().
+ */
+class SearchHandle
+{
+public:
+    SearchHandle(EngineWorker& worker, unsigned int request,
+                 std::shared_future<EngineWorker::Result> result);
+
+    /**
+     * Stops the search (or drops it if it didn't start), result is the best move found so far.
+     */
+    void stop();
+
+    bool isReady() const;
+
+    /**
+     * @return True if the result is ready before the timeout.
+     */
+    bool waitFor(std::chrono::milliseconds timeout) const;
+
+    /**
+     * Blocks until the search ends.
+     */
+    const EngineWorker::Result& get() const;
+
+    const std::shared_future<EngineWorker::Result>& getFuture() const;
+
+private:
+    EngineWorker* m_worker;
+    unsigned int m_request;
+    std::shared_future<EngineWorker::Result> m_result;
+};
+
+} // namespace chessAi
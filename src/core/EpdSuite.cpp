@@ -0,0 +1,66 @@
+#include "EpdSuite.h"
+#include "Fen.h"
+#include "Notation.h"
+
+#include <algorithm>
+
+namespace chessAi
+{
+
+bool EpdSuite::Position::hasExpectedMoves() const
+{
+    return !bestMoves.empty() || !avoidMoves.empty();
+}
+
+bool EpdSuite::Position::isSolvedBy(Move move) const
+{
+    auto isBestMove = std::find(bestMoves.begin(), bestMoves.end(), move) != bestMoves.end();
+    if (!bestMoves.empty() && !isBestMove)
+        return false;
+    return std::find(avoidMoves.begin(), avoidMoves.end(), move) == avoidMoves.end();
+}
+
+std::optional<std::vector<EpdSuite::Position>> EpdSuite::load(const std::string& path)
+{
+    std::vector<Position> positions;
+    auto lines = Fen::forEachEpdLine(
+        path, [&positions](const PieceBitBoards& bitBoards, std::string_view operations) {
+            Position position;
+            position.bitBoards = bitBoards;
+            auto id = Fen::getEpdOperation(operations, "id");
+            position.id = id.has_value() ? std::string(*id) : std::to_string(positions.size() + 1);
+            if (auto bestMoves = Fen::getEpdOperation(operations, "bm"))
+                position.bestMoves = parseMoves(*bestMoves, bitBoards);
+            if (auto avoidMoves = Fen::getEpdOperation(operations, "am"))
+                position.avoidMoves = parseMoves(*avoidMoves, bitBoards);
+            positions.push_back(std::move(position));
+        });
+    if (!lines.has_value()) {
+        CHESS_LOG_ERROR("EPD file {} couldn't be opened.", path);
+        return {};
+    }
+    return positions;
+}
+
+std::vector<Move> EpdSuite::parseMoves(std::string_view moves, const PieceBitBoards& bitBoards)
+{
+    std::vector<Move> parsed;
+    while (!moves.empty()) {
+        auto end = moves.find(' ');
+        auto notation = moves.substr(0, end);
+        moves.remove_prefix((end == std::string_view::npos) ? moves.size() : end + 1);
+        if (notation.empty())
+            continue;
+
+        auto move = Notation::sanToMove(notation, bitBoards);
+        if (!move.has_value())
+            move = Notation::uciToMove(notation, bitBoards);
+        if (move.has_value())
+            parsed.push_back(*move);
+        else
+            CHESS_LOG_WARN("Expected move {} is not legal in the position.", notation);
+    }
+    return parsed;
+}
+
+} // namespace chessAi
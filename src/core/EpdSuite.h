@@ -0,0 +1,53 @@
+#pragma once
+
+#include "Move.h"
+#include "PieceBitBoards.h"
+
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace chessAi
+{
+
+/**
+ * Test suite of EPD positions with expected moves: "bm" (best moves, one of them must be played)
+ * and "am" (moves to avoid), in SAN or UCI notation. Positions without them are plain analysis
+ * positions.
+ */
+class EpdSuite
+{
+public:
+    struct Position
+    {
+        /**
+         * EPD "id" operation, or the line number.
+         */
+        std::string id;
+        PieceBitBoards bitBoards;
+        std::vector<Move> bestMoves;
+        std::vector<Move> avoidMoves;
+
+        bool hasExpectedMoves() const;
+
+        /**
+         * Move is one of the best moves (if any) and none of the moves to avoid.
+         */
+        bool isSolvedBy(Move move) const;
+    };
+
+    /**
+     * Loads positions of the EPD (or FEN per line) file. Invalid lines are skipped, expected
+     * moves which are not legal in the position are logged and ignored.
+     *
+     * @return Empty optional if the file couldn't be opened.
+     */
+    static std::optional<std::vector<Position>> load(const std::string& path);
+
+    /**
+     * Parses moves separated by spaces, in SAN or UCI notation.
+     */
+    static std::vector<Move> parseMoves(std::string_view moves, const PieceBitBoards& bitBoards);
+};
+
+} // namespace chessAi
@@ -0,0 +1,54 @@
+#include "EvalCache.h"
+
+namespace chessAi
+{
+
+namespace
+{
+
+uint64_t packEntry(uint64_t zobristKey, int evaluation)
+{
+    return (zobristKey & 0xFFFFFFFF00000000ULL) |
+           static_cast<uint64_t>(static_cast<uint32_t>(evaluation));
+}
+
+} // namespace
+
+EvalCache::EvalCache(size_t sizeInMegaBytes) : m_mask(0), m_table(nullptr)
+{
+    size_t maxEntries = sizeInMegaBytes * 1024 * 1024 / sizeof(std::atomic<uint64_t>);
+    size_t numberOfEntries = 1;
+    while (numberOfEntries * 2 <= maxEntries)
+        numberOfEntries *= 2;
+
+    m_mask = numberOfEntries - 1;
+    m_table = std::make_unique<std::atomic<uint64_t>[]>(numberOfEntries);
+    clear();
+}
+
+std::optional<int> EvalCache::probe(uint64_t zobristKey) const
+{
+    uint64_t entry = m_table[zobristKey & m_mask].load(std::memory_order_relaxed);
+    if (entry == 0 || (entry & 0xFFFFFFFF00000000ULL) != (zobristKey & 0xFFFFFFFF00000000ULL))
+        return {};
+    return static_cast<int>(static_cast<uint32_t>(entry));
+}
+
+void EvalCache::store(uint64_t zobristKey, int evaluation)
+{
+    m_table[zobristKey & m_mask].store(packEntry(zobristKey, evaluation),
+                                       std::memory_order_relaxed);
+}
+
+void EvalCache::clear()
+{
+    for (size_t i = 0; i <= m_mask; ++i)
+        m_table[i].store(0, std::memory_order_relaxed);
+}
+
+size_t EvalCache::getNumberOfEntries() const
+{
+    return m_mask + 1;
+}
+
+} // namespace chessAi
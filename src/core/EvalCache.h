@@ -0,0 +1,43 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <optional>
+
+namespace chessAi
+{
+
+/**
+ * Cache of static evaluations (Evaluate::getEvaluation) keyed by zobrist key.
+ *
+ * Each entry is a single 64 bit atomic word: upper 32 bits of the zobrist key are used for
+ * verification, lower 32 bits hold the evaluation. Lower bits of the key select the slot, so
+ * reads and writes never tear and the cache can be shared between engines running in different
+ * threads without locks. Colliding positions overwrite each other (always replace).
+ *
+ * Hit statistics are counted by the caller (see Engine::SearchStatistics), so threads sharing
+ * the cache do not fight over counters.
+ */
+class EvalCache
+{
+public:
+    /**
+     * @param sizeInMegaBytes Number of entries is rounded down to a power of two.
+     */
+    explicit EvalCache(size_t sizeInMegaBytes = 4);
+
+    std::optional<int> probe(uint64_t zobristKey) const;
+
+    void store(uint64_t zobristKey, int evaluation);
+
+    void clear();
+
+    size_t getNumberOfEntries() const;
+
+private:
+    size_t m_mask;
+    std::unique_ptr<std::atomic<uint64_t>[]> m_table;
+};
+
+} // namespace chessAi
@@ -1,23 +1,111 @@
 #include "Evaluate.h"
+#include "King.h"
 
 #include <algorithm>
 
 namespace chessAi
 {
 
-int Evaluate::mopUpEvaluation(const PieceBitBoards& boards)
+namespace
 {
-    if (std::abs(s_endgameWeight) < 0.01f)
-        return 0;
 
-    int evaluation = 0;
+/**
+ * Sums parameter * coefficient, each term truncated to int as the evaluation always did.
+ */
+class ScoreAccumulator
+{
+public:
+    explicit ScoreAccumulator(const EvaluationParameters& parameters)
+        : m_parameters(parameters), m_score(0)
+    {
+    }
+
+    void add(size_t index, int coefficient)
+    {
+        m_score += m_parameters[index] * coefficient;
+    }
+
+    void addScaled(size_t index, float coefficient)
+    {
+        m_score += static_cast<int>(coefficient * static_cast<float>(m_parameters[index]));
+    }
+
+    void addConstant(int value)
+    {
+        m_score += value;
+    }
+
+    int get(size_t index) const
+    {
+        return m_parameters[index];
+    }
+
+    int getScore() const
+    {
+        return m_score;
+    }
+
+private:
+    const EvaluationParameters& m_parameters;
+    int m_score;
+};
+
+/**
+ * Collects the coefficients of parameters instead of their values.
+ */
+class TraceAccumulator
+{
+public:
+    TraceAccumulator(const EvaluationParameters& parameters, EvaluationTrace& trace)
+        : m_parameters(parameters), m_trace(trace)
+    {
+    }
+
+    void add(size_t index, int coefficient)
+    {
+        m_trace.coefficients[index] += static_cast<float>(coefficient);
+    }
+
+    void addScaled(size_t index, float coefficient)
+    {
+        m_trace.coefficients[index] += coefficient;
+    }
+
+    void addConstant(int value)
+    {
+        m_trace.constant += static_cast<float>(value);
+    }
+
+    int get(size_t index) const
+    {
+        return m_parameters[index];
+    }
+
+private:
+    const EvaluationParameters& m_parameters;
+    EvaluationTrace& m_trace;
+};
+
+int countPieces(const std::vector<uint16_t>& positions)
+{
+    return static_cast<int>(positions.size());
+}
+
+} // namespace
+
+template <typename TAccumulator>
+void Evaluate::mopUpEvaluation(const PieceBitBoards& boards, float endgameWeight, int sign,
+                               TAccumulator& accumulator)
+{
+    if (std::abs(endgameWeight) < 0.01f)
+        return;
 
     unsigned int kingPosition = 0;
     unsigned int opponentsKingPosition = 0;
 
     if (boards.whiteKingPositions.empty() || boards.blackKingPositions.empty()) {
         CHESS_LOG_ERROR("Empty king position.");
-        return 0;
+        return;
     }
 
     if (boards.currentMoveColor == PieceColor::White) {
@@ -29,132 +117,177 @@ int Evaluate::mopUpEvaluation(const PieceBitBoards& boards)
         opponentsKingPosition = boards.whiteKingPositions[0];
     }
 
-    evaluation += static_cast<int>(
-        1.6f * static_cast<float>(14 - s_manhattanDistance[kingPosition][opponentsKingPosition]));
-
-    evaluation += static_cast<int>(
-        4.7f * static_cast<float>(s_centerManhattanDistance[opponentsKingPosition]));
-    return static_cast<int>(s_endgameWeight * static_cast<float>(evaluation));
+    // Weights are in tenths.
+    auto scale = static_cast<float>(sign) * endgameWeight / 10.f;
+    accumulator.addScaled(
+        EvaluationParameters::MopUpKingDistance,
+        scale * static_cast<float>(14 - s_manhattanDistance[kingPosition][opponentsKingPosition]));
+    accumulator.addScaled(
+        EvaluationParameters::MopUpCenterDistance,
+        scale * static_cast<float>(s_centerManhattanDistance[opponentsKingPosition]));
 }
 
-int Evaluate::pieceSquareTableEvaluation(const PieceBitBoards& boards)
+template <typename TAccumulator>
+void Evaluate::pieceSquareTableEvaluation(const PieceBitBoards& boards, float endgameWeight,
+                                          TAccumulator& accumulator)
 {
-    int evaluation = 0;
-
     for (unsigned int position : boards.whitePawnPositions) {
-        evaluation += s_pawnSquareValues[position];
+        accumulator.add(EvaluationParameters::PawnSquareValues + position, 1);
     }
     for (unsigned int position : boards.whiteKnightPositions) {
-        evaluation += s_knightSquareValues[position];
+        accumulator.add(EvaluationParameters::KnightSquareValues + position, 1);
     }
     for (unsigned int position : boards.whiteBishopPositions) {
-        evaluation += s_bishopSquareValues[position];
+        accumulator.add(EvaluationParameters::BishopSquareValues + position, 1);
     }
     for (unsigned int position : boards.whiteRookPositions) {
-        evaluation += s_rookSquareValues[position];
+        accumulator.add(EvaluationParameters::RookSquareValues + position, 1);
     }
     for (unsigned int position : boards.whiteQueenPositions) {
-        evaluation += s_queenSquareValues[position];
+        accumulator.add(EvaluationParameters::QueenSquareValues + position, 1);
     }
 
     if (boards.whiteKingPositions.empty() || boards.blackKingPositions.empty()) {
         CHESS_LOG_ERROR("Empty king position.");
-        return 0;
+        return;
     }
 
-    evaluation +=
-        static_cast<int>(
-            (1 - s_endgameWeight) *
-            static_cast<float>(s_kingMiddleGameSquareValues[boards.whiteKingPositions[0]])) +
-        static_cast<int>(
-            s_endgameWeight *
-            static_cast<float>(s_kingEndGameSquareValues[boards.whiteKingPositions[0]]));
+    accumulator.addScaled(
+        EvaluationParameters::KingMiddleGameSquareValues + boards.whiteKingPositions[0],
+        1 - endgameWeight);
+    accumulator.addScaled(
+        EvaluationParameters::KingEndGameSquareValues + boards.whiteKingPositions[0],
+        endgameWeight);
 
     // Black
     for (unsigned int position : boards.blackPawnPositions) {
-        evaluation -= s_pawnSquareValues[63 - position];
+        accumulator.add(EvaluationParameters::PawnSquareValues + 63 - position, -1);
     }
     for (unsigned int position : boards.blackKnightPositions) {
-        evaluation -= s_knightSquareValues[63 - position];
+        accumulator.add(EvaluationParameters::KnightSquareValues + 63 - position, -1);
     }
     for (unsigned int position : boards.blackBishopPositions) {
-        evaluation -= s_bishopSquareValues[63 - position];
+        accumulator.add(EvaluationParameters::BishopSquareValues + 63 - position, -1);
     }
     for (unsigned int position : boards.blackRookPositions) {
-        evaluation -= s_rookSquareValues[63 - position];
+        accumulator.add(EvaluationParameters::RookSquareValues + 63 - position, -1);
     }
     for (unsigned int position : boards.blackQueenPositions) {
-        evaluation -= s_queenSquareValues[63 - position];
+        accumulator.add(EvaluationParameters::QueenSquareValues + 63 - position, -1);
     }
 
-    evaluation -=
-        static_cast<int>(
-            (1 - s_endgameWeight) *
-            static_cast<float>(s_kingMiddleGameSquareValues[63 - boards.blackKingPositions[0]])) +
-        static_cast<int>(
-            s_endgameWeight *
-            static_cast<float>(s_kingEndGameSquareValues[63 - boards.blackKingPositions[0]]));
+    accumulator.addScaled(
+        EvaluationParameters::KingMiddleGameSquareValues + 63 - boards.blackKingPositions[0],
+        endgameWeight - 1);
+    accumulator.addScaled(
+        EvaluationParameters::KingEndGameSquareValues + 63 - boards.blackKingPositions[0],
+        -endgameWeight);
+}
 
-    return evaluation;
+template <typename TAccumulator>
+void Evaluate::evaluateTerms(const PieceBitBoards& boards, const AttackMaps& attackMaps,
+                             TAccumulator& accumulator)
+{
+    auto weight = endgameWeight(boards);
+
+    int pawns = countPieces(boards.whitePawnPositions) - countPieces(boards.blackPawnPositions);
+    int bishops =
+        countPieces(boards.whiteBishopPositions) - countPieces(boards.blackBishopPositions);
+    int knights =
+        countPieces(boards.whiteKnightPositions) - countPieces(boards.blackKnightPositions);
+    int rooks = countPieces(boards.whiteRookPositions) - countPieces(boards.blackRookPositions);
+    int queens = countPieces(boards.whiteQueenPositions) - countPieces(boards.blackQueenPositions);
+
+    accumulator.add(EvaluationParameters::PawnValue, pawns);
+    accumulator.add(EvaluationParameters::BishopValue, bishops);
+    accumulator.add(EvaluationParameters::KnightValue, knights);
+    accumulator.add(EvaluationParameters::RookValue, rooks);
+    accumulator.add(EvaluationParameters::QueenValue, queens);
+
+    int materialDifference = pawns * accumulator.get(EvaluationParameters::PawnValue) +
+                             bishops * accumulator.get(EvaluationParameters::BishopValue) +
+                             knights * accumulator.get(EvaluationParameters::KnightValue) +
+                             rooks * accumulator.get(EvaluationParameters::RookValue) +
+                             queens * accumulator.get(EvaluationParameters::QueenValue);
+    int mopUpMargin = 2 * accumulator.get(EvaluationParameters::PawnValue);
+
+    if (materialDifference > mopUpMargin)
+        mopUpEvaluation(boards, weight, 1, accumulator);
+    else if (materialDifference < -mopUpMargin)
+        mopUpEvaluation(boards, weight, -1, accumulator);
+
+    pieceSquareTableEvaluation(boards, weight, accumulator);
+    kingPawnShield(boards, weight, accumulator);
+    mobilityEvaluation(attackMaps, accumulator);
+    accumulator.addConstant(kingSafetyEvaluation(boards, attackMaps, weight));
+    threatEvaluation(boards, attackMaps, accumulator);
 }
 
 int Evaluate::getEvaluation(const PieceBitBoards& boards)
 {
-    s_endgameWeight = endgameWeight(boards);
-
-    int whiteEvaluation = 0;
-    int blackEvaluation = 0;
-
-    whiteEvaluation += static_cast<int>(boards.whitePawnPositions.size()) * s_pawnValue;
-    whiteEvaluation += static_cast<int>(boards.whiteBishopPositions.size()) * s_bishopValue;
-    whiteEvaluation += static_cast<int>(boards.whiteKnightPositions.size()) * s_knightValue;
-    whiteEvaluation += static_cast<int>(boards.whiteRookPositions.size()) * s_rookValue;
-    whiteEvaluation += static_cast<int>(boards.whiteQueenPositions.size()) * s_queenValue;
-
-    blackEvaluation += static_cast<int>(boards.blackPawnPositions.size()) * s_pawnValue;
-    blackEvaluation += static_cast<int>(boards.blackBishopPositions.size()) * s_bishopValue;
-    blackEvaluation += static_cast<int>(boards.blackKnightPositions.size()) * s_knightValue;
-    blackEvaluation += static_cast<int>(boards.blackRookPositions.size()) * s_rookValue;
-    blackEvaluation += static_cast<int>(boards.blackQueenPositions.size()) * s_queenValue;
-
-    int evaluation = whiteEvaluation - blackEvaluation;
-
-    if (whiteEvaluation > blackEvaluation + 2 * s_pawnValue)
-        evaluation += mopUpEvaluation(boards);
-    else if (blackEvaluation > whiteEvaluation + 2 * s_pawnValue)
-        evaluation -= mopUpEvaluation(boards);
+    return getEvaluation(boards, AttackMaps(boards));
+}
 
-    evaluation += pieceSquareTableEvaluation(boards);
-    evaluation += kingPawnShield(boards);
+int Evaluate::getEvaluation(const PieceBitBoards& boards, const AttackMaps& attackMaps)
+{
+    ScoreAccumulator accumulator(s_parameters);
+    evaluateTerms(boards, attackMaps, accumulator);
 
+    int evaluation = accumulator.getScore();
     return (boards.currentMoveColor == PieceColor::White) ? evaluation : -evaluation;
 }
 
+EvaluationTrace Evaluate::getEvaluationTrace(const PieceBitBoards& boards)
+{
+    EvaluationTrace trace;
+    TraceAccumulator accumulator(s_parameters, trace);
+    evaluateTerms(boards, AttackMaps(boards), accumulator);
+    return trace;
+}
+
 int Evaluate::getFigureValue(PieceFigure figure)
 {
     switch (figure) {
     case PieceFigure::Pawn:
-        return s_pawnValue;
+        return s_parameters[EvaluationParameters::PawnValue];
     case PieceFigure::Bishop:
-        return s_bishopValue;
+        return s_parameters[EvaluationParameters::BishopValue];
     case PieceFigure::Knight:
-        return s_knightValue;
+        return s_parameters[EvaluationParameters::KnightValue];
     case PieceFigure::Rook:
-        return s_rookValue;
+        return s_parameters[EvaluationParameters::RookValue];
     case PieceFigure::Queen:
-        return s_queenValue;
+        return s_parameters[EvaluationParameters::QueenValue];
     default:
         return 0;
     }
 }
 
-int Evaluate::kingPawnShield(const PieceBitBoards& boards)
+const EvaluationParameters& Evaluate::getParameters()
 {
-    int evaluation = 0;
+    return s_parameters;
+}
 
+void Evaluate::setParameters(const EvaluationParameters& parameters)
+{
+    s_parameters = parameters;
+}
+
+bool Evaluate::loadParameters(const std::string& path)
+{
+    return s_parameters.load(path);
+}
+
+template <typename TAccumulator>
+void Evaluate::kingPawnShield(const PieceBitBoards& boards, float endgameWeight,
+                              TAccumulator& accumulator)
+{
     // If in endgame, pawn shield is not evaluated.
-    if (std::abs(s_endgameWeight) > 0.f)
-        return evaluation;
+    if (std::abs(endgameWeight) > 0.f)
+        return;
+
+    int whiteMissingPawns = 0;
+    int blackMissingPawns = 0;
 
     // If the king is castled, we add a penalty if no pawn shield.
     // King on g1: pawn must be on f2; pawn must be on either of g2 or g3; pawn must be on
@@ -164,75 +297,159 @@ int Evaluate::kingPawnShield(const PieceBitBoards& boards)
     if (boards.whiteKing & 0b1100000000000000000000000000000000000000000000000000000000000000) {
         // f2
         if ((boards.whitePawns & 0b00100000000000000000000000000000000000000000000000000000) == 0)
-            evaluation -= 40;
+            ++whiteMissingPawns;
         // g2 or g3
         if ((boards.whitePawns & 0b01000000010000000000000000000000000000000000000000000000) == 0)
-            evaluation -= 40;
+            ++whiteMissingPawns;
         // h2 or h3
         if ((boards.whitePawns & 0b10000000100000000000000000000000000000000000000000000000) == 0)
-            evaluation -= 40;
+            ++whiteMissingPawns;
     }
     // White queen side castle
     else if (boards.whiteKing & 0b11100000000000000000000000000000000000000000000000000000000) {
         // a2 or a3
         if ((boards.whitePawns & 0b1000000010000000000000000000000000000000000000000) == 0)
-            evaluation -= 40;
+            ++whiteMissingPawns;
         // b2
         if ((boards.whitePawns & 0b10000000000000000000000000000000000000000000000000) == 0)
-            evaluation -= 40;
+            ++whiteMissingPawns;
         // c2
         if ((boards.whitePawns & 0b100000000000000000000000000000000000000000000000000) == 0)
-            evaluation -= 40;
+            ++whiteMissingPawns;
         // d2
         if ((boards.whitePawns & 0b1000000000000000000000000000000000000000000000000000) == 0)
-            evaluation -= 40;
+            ++whiteMissingPawns;
     }
 
     // Black king side castle
     if (boards.blackKing & 0b11000000) {
         // f7
         if ((boards.blackPawns & 0b10000000000000) == 0)
-            evaluation += 40;
+            ++blackMissingPawns;
         // g2 or g3
         if ((boards.blackPawns & 0b010000000100000000000000) == 0)
-            evaluation += 40;
+            ++blackMissingPawns;
         // h2 or h3
         if ((boards.blackPawns & 0b100000001000000000000000) == 0)
-            evaluation += 40;
+            ++blackMissingPawns;
     }
     // Black queen side castle
     else if (boards.blackKing & 0b111) {
         // a7 or a6
         if ((boards.blackPawns & 0b10000000100000000) == 0)
-            evaluation += 40;
+            ++blackMissingPawns;
         // b7
         if ((boards.blackPawns & 0b1000000000) == 0)
-            evaluation += 40;
+            ++blackMissingPawns;
         // c7
         if ((boards.blackPawns & 0b10000000000) == 0)
-            evaluation += 40;
+            ++blackMissingPawns;
         // d7
         if ((boards.blackPawns & 0b100000000000) == 0)
-            evaluation += 40;
+            ++blackMissingPawns;
+    }
+
+    accumulator.add(EvaluationParameters::PawnShieldPenalty,
+                    blackMissingPawns - whiteMissingPawns);
+}
+
+template <typename TAccumulator>
+void Evaluate::mobilityEvaluation(const AttackMaps& attackMaps, TAccumulator& accumulator)
+{
+    const auto& white = attackMaps.get<PieceColor::White>();
+    const auto& black = attackMaps.get<PieceColor::Black>();
+
+    for (size_t figure = 0; figure < white.mobility.size(); ++figure) {
+        accumulator.add(EvaluationParameters::MobilityValues + figure,
+                        static_cast<int>(white.mobility[figure]) - black.mobility[figure]);
+    }
+}
+
+namespace
+{
+
+int kingZoneAttackUnits(uint64_t kingZone, const AttackMaps::ColorAttacks& opponentAttacks,
+                        const EvaluationParameters& parameters)
+{
+    int units = 0;
+    for (size_t figure = 0; figure < opponentAttacks.byFigure.size(); ++figure) {
+        units += parameters[EvaluationParameters::KingAttackWeights + figure] *
+                 PieceBitBoards::countSetBits(opponentAttacks.byFigure[figure] & kingZone);
+    }
+    return units;
+}
+
+} // namespace
+
+int Evaluate::kingSafetyEvaluation(const PieceBitBoards& boards, const AttackMaps& attackMaps,
+                                   float endgameWeight)
+{
+    // King safety matters less when there is no material left to attack with.
+    if (endgameWeight > 0.99f)
+        return 0;
+
+    if (boards.whiteKingPositions.empty() || boards.blackKingPositions.empty()) {
+        CHESS_LOG_ERROR("Empty king position.");
+        return 0;
     }
 
-    return evaluation;
+    auto whiteKingZone = King::originToAttacks[boards.whiteKingPositions[0]] | boards.whiteKing;
+    auto blackKingZone = King::originToAttacks[boards.blackKingPositions[0]] | boards.blackKing;
+
+    // Penalty grows quadratically, many attackers are much more dangerous than one.
+    auto maxPenalty = s_parameters[EvaluationParameters::MaxKingAttackPenalty];
+    auto penalty = [maxPenalty](int units) { return std::min(units * units / 4, maxPenalty); };
+    int whiteUnits =
+        kingZoneAttackUnits(whiteKingZone, attackMaps.get<PieceColor::Black>(), s_parameters);
+    int blackUnits =
+        kingZoneAttackUnits(blackKingZone, attackMaps.get<PieceColor::White>(), s_parameters);
+
+    return static_cast<int>((1 - endgameWeight) *
+                            static_cast<float>(penalty(blackUnits) - penalty(whiteUnits)));
+}
+
+template <typename TAccumulator>
+void Evaluate::threatEvaluation(const PieceBitBoards& boards, const AttackMaps& attackMaps,
+                                TAccumulator& accumulator)
+{
+    const auto& white = attackMaps.get<PieceColor::White>();
+    const auto& black = attackMaps.get<PieceColor::Black>();
+
+    auto whitePieces = boards.getAllPiecesBoard<PieceColor::White>() & ~boards.whiteKing;
+    auto blackPieces = boards.getAllPiecesBoard<PieceColor::Black>() & ~boards.blackKing;
+
+    auto whitePawnAttacks = white.byFigure[static_cast<size_t>(PieceFigure::Pawn)];
+    auto blackPawnAttacks = black.byFigure[static_cast<size_t>(PieceFigure::Pawn)];
+
+    accumulator.add(
+        EvaluationParameters::PawnThreatPenalty,
+        PieceBitBoards::countSetBits(blackPieces & ~boards.blackPawns & whitePawnAttacks) -
+            PieceBitBoards::countSetBits(whitePieces & ~boards.whitePawns & blackPawnAttacks));
+
+    accumulator.add(EvaluationParameters::HangingPiecePenalty,
+                    PieceBitBoards::countSetBits(blackPieces & white.all & ~black.all) -
+                        PieceBitBoards::countSetBits(whitePieces & black.all & ~white.all));
 }
 
 float Evaluate::endgameWeight(const PieceBitBoards& boards)
 {
+    auto bishopValue = s_parameters[EvaluationParameters::BishopValue];
+    auto knightValue = s_parameters[EvaluationParameters::KnightValue];
+    auto rookValue = s_parameters[EvaluationParameters::RookValue];
+    auto queenValue = s_parameters[EvaluationParameters::QueenValue];
+
     float endGameStart =
-        1 / static_cast<float>(s_rookValue + s_bishopValue + s_knightValue + s_knightValue);
+        1 / static_cast<float>(rookValue + bishopValue + knightValue + knightValue);
 
     int materialCountNoPawns =
-        std::min(static_cast<int>(boards.whiteKnightPositions.size()) * s_knightValue +
-                     static_cast<int>(boards.whiteBishopPositions.size()) * s_bishopValue +
-                     static_cast<int>(boards.whiteRookPositions.size()) * s_rookValue +
-                     static_cast<int>(boards.whiteQueenPositions.size()) * s_queenValue,
-                 static_cast<int>(boards.blackKnightPositions.size()) * s_knightValue +
-                     static_cast<int>(boards.blackBishopPositions.size()) * s_bishopValue +
-                     static_cast<int>(boards.blackRookPositions.size()) * s_rookValue +
-                     static_cast<int>(boards.blackQueenPositions.size()) * s_queenValue);
+        std::min(countPieces(boards.whiteKnightPositions) * knightValue +
+                     countPieces(boards.whiteBishopPositions) * bishopValue +
+                     countPieces(boards.whiteRookPositions) * rookValue +
+                     countPieces(boards.whiteQueenPositions) * queenValue,
+                 countPieces(boards.blackKnightPositions) * knightValue +
+                     countPieces(boards.blackBishopPositions) * bishopValue +
+                     countPieces(boards.blackRookPositions) * rookValue +
+                     countPieces(boards.blackQueenPositions) * queenValue);
 
     return 1.f - std::min(1.f, endGameStart * static_cast<float>(materialCountNoPawns));
 }
@@ -1,10 +1,25 @@
 #pragma once
 
+#include "AttackMaps.h"
+#include "EvaluationParameters.h"
 #include "PieceBitBoards.h"
 
+#include <string>
+
 namespace chessAi
 {
 
+/**
+ * Evaluation split into coefficients of the linear parameters (see EvaluationParameters), from the
+ * perspective of white: evaluation = sum(coefficients[i] * parameters[i]) + constant. The constant
+ * holds terms which are not linear in the parameters (king safety).
+ */
+struct EvaluationTrace
+{
+    std::array<float, EvaluationParameters::NumberOfParameters> coefficients{};
+    float constant = 0.f;
+};
+
 class Evaluate
 {
 public:
@@ -12,6 +27,11 @@ public:
     inline static constexpr int negativeInfinity = -infinity;
     inline static constexpr int mateScore = infinity / 10;
     inline static constexpr int negativeMateScore = -mateScore;
+    /**
+     * Score of positions won according to bitbases, below mate scores. Static evaluation is added
+     * so search still makes progress towards the mate.
+     */
+    inline static constexpr int bitbaseWinScore = mateScore / 10;
 
 public:
     /**
@@ -20,98 +40,64 @@ public:
      */
     static int getEvaluation(const PieceBitBoards& boards);
 
+    /**
+     * Same as above, with attack maps already computed for this position.
+     */
+    static int getEvaluation(const PieceBitBoards& boards, const AttackMaps& attackMaps);
+
+    /**
+     * Coefficients of the evaluation parameters for this position, used by the tuner.
+     */
+    static EvaluationTrace getEvaluationTrace(const PieceBitBoards& boards);
+
     static int getFigureValue(PieceFigure figure);
 
+    static const EvaluationParameters& getParameters();
+
+    /**
+     * Must not be called while a search is running.
+     */
+    static void setParameters(const EvaluationParameters& parameters);
+
+    /**
+     * Load parameters from file, current parameters are kept if loading fails.
+     */
+    static bool loadParameters(const std::string& path);
+
 private:
+    /**
+     * All evaluation terms, written once for both the integer evaluation and the trace.
+     * TAccumulator collects parameter[index] * coefficient for each term.
+     */
+    template <typename TAccumulator>
+    static void evaluateTerms(const PieceBitBoards& boards, const AttackMaps& attackMaps,
+                              TAccumulator& accumulator);
+
     static float endgameWeight(const PieceBitBoards& boards);
-    static int pieceSquareTableEvaluation(const PieceBitBoards& boards);
-    static int mopUpEvaluation(const PieceBitBoards& boards);
-    static int kingPawnShield(const PieceBitBoards& boards);
+
+    template <typename TAccumulator>
+    static void pieceSquareTableEvaluation(const PieceBitBoards& boards, float endgameWeight,
+                                           TAccumulator& accumulator);
+    template <typename TAccumulator>
+    static void mopUpEvaluation(const PieceBitBoards& boards, float endgameWeight, int sign,
+                                TAccumulator& accumulator);
+    template <typename TAccumulator>
+    static void kingPawnShield(const PieceBitBoards& boards, float endgameWeight,
+                               TAccumulator& accumulator);
+    template <typename TAccumulator>
+    static void mobilityEvaluation(const AttackMaps& attackMaps, TAccumulator& accumulator);
+    static int kingSafetyEvaluation(const PieceBitBoards& boards, const AttackMaps& attackMaps,
+                                    float endgameWeight);
+    template <typename TAccumulator>
+    static void threatEvaluation(const PieceBitBoards& boards, const AttackMaps& attackMaps,
+                                 TAccumulator& accumulator);
 
     static std::array<std::array<int, 64>, 64> precalculateManhattanDistance();
 
 private:
-    inline static float s_endgameWeight = 0.f;
-
-    inline static const int s_pawnValue = 100;
-    inline static const int s_bishopValue = 300;
-    inline static const int s_knightValue = 300;
-    inline static const int s_rookValue = 500;
-    inline static const int s_queenValue = 900;
+    inline static EvaluationParameters s_parameters;
 
     // clang-format off
-    // Orientated with white at the bottom.
-    inline static const std::array<int, 64> s_pawnSquareValues = {
-         0,  0,  0,  0,  0,  0,  0,  0,
-        50, 50, 50, 50, 50, 50, 50, 50,
-        10, 10, 20, 30, 30, 20, 10, 10,
-         5,  5, 10, 25, 25, 10,  5,  5,
-         0,  0,  0, 20, 20,  0,  0,  0,
-         5, -5,-10,  0,  0,-10, -5,  5,
-         5, 10, 10,-20,-20, 10, 10,  5,
-         0,  0,  0,  0,  0,  0,  0,  0
-    };
-    inline static const std::array<int, 64> s_knightSquareValues = {
-        -50,-40,-30,-30,-30,-30,-40,-50,
-        -40,-20,  0,  0,  0,  0,-20,-40,
-        -30,  0, 10, 15, 15, 10,  0,-30,
-        -30,  5, 15, 20, 20, 15,  5,-30,
-        -30,  0, 15, 20, 20, 15,  0,-30,
-        -30,  5, 10, 15, 15, 10,  5,-30,
-        -40,-20,  0,  5,  5,  0,-20,-40,
-        -50,-40,-30,-30,-30,-30,-40,-50
-    };
-    inline static const std::array<int, 64> s_bishopSquareValues = {
-        -50,-40,-30,-30,-30,-30,-40,-50,
-        -40,-20,  0,  0,  0,  0,-20,-40,
-        -30,  0, 10, 15, 15, 10,  0,-30,
-        -30,  5, 15, 20, 20, 15,  5,-30,
-        -30,  0, 15, 20, 20, 15,  0,-30,
-        -30,  5, 10, 15, 15, 10,  5,-30,
-        -40,-20,  0,  5,  5,  0,-20,-40,
-        -50,-40,-30,-30,-30,-30,-40,-50
-    };
-    inline static const std::array<int, 64> s_rookSquareValues = {
-        0,  0,  0,  0,  0,  0,  0,  0,
-         5, 10, 10, 10, 10, 10, 10,  5,
-        -5,  0,  0,  0,  0,  0,  0, -5,
-        -5,  0,  0,  0,  0,  0,  0, -5,
-        -5,  0,  0,  0,  0,  0,  0, -5,
-        -5,  0,  0,  0,  0,  0,  0, -5,
-        -5,  0,  0,  0,  0,  0,  0, -5,
-         0,  0,  0,  5,  5,  0,  0,  0
-    };
-    inline static const std::array<int, 64> s_queenSquareValues = {
-        -20,-10,-10, -5, -5,-10,-10,-20,
-        -10,  0,  0,  0,  0,  0,  0,-10,
-        -10,  0,  5,  5,  5,  5,  0,-10,
-         -5,  0,  5,  5,  5,  5,  0, -5,
-          0,  0,  5,  5,  5,  5,  0, -5,
-        -10,  5,  5,  5,  5,  5,  0,-10,
-        -10,  0,  5,  0,  0,  0,  0,-10,
-        -20,-10,-10, -5, -5,-10,-10,-20
-    };
-    inline static const std::array<int, 64> s_kingMiddleGameSquareValues = {
-        -30,-40,-40,-50,-50,-40,-40,-30,
-        -30,-40,-40,-50,-50,-40,-40,-30,
-        -30,-40,-40,-50,-50,-40,-40,-30,
-        -30,-40,-40,-50,-50,-40,-40,-30,
-        -20,-30,-30,-40,-40,-30,-30,-20,
-        -10,-20,-20,-20,-20,-20,-20,-10,
-         20, 20,  0,  0,  0,  0, 20, 20,
-         20, 30, 10,  0,  0, 10, 30, 20
-    };
-    inline static const std::array<int, 64> s_kingEndGameSquareValues = {
-        -50,-40,-30,-20,-20,-30,-40,-50,
-        -30,-20,-10,  0,  0,-10,-20,-30,
-        -30,-10, 20, 30, 30, 20,-10,-30,
-        -30,-10, 30, 40, 40, 30,-10,-30,
-        -30,-10, 30, 40, 40, 30,-10,-30,
-        -30,-10, 20, 30, 30, 20,-10,-30,
-        -30,-30,  0,  0,  0,  0,-30,-30,
-        -50,-30,-30,-30,-30,-30,-30,-50
-    };
-
     // Distance from the center.
     inline static const std::array<int, 64> s_centerManhattanDistance = {
         6, 5, 4, 3, 3, 4, 5, 6,
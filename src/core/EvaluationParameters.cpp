@@ -0,0 +1,198 @@
+#include "EvaluationParameters.h"
+#include "logger/Logger.h"
+
+#include <algorithm>
+#include <fstream>
+#include <initializer_list>
+#include <sstream>
+
+namespace chessAi
+{
+
+namespace
+{
+
+void setTable(std::array<int, EvaluationParameters::NumberOfParameters>& values, size_t first,
+              std::initializer_list<int> table)
+{
+    std::copy(table.begin(), table.end(), values.begin() + static_cast<std::ptrdiff_t>(first));
+}
+
+} // namespace
+
+EvaluationParameters::EvaluationParameters() : m_values()
+{
+    m_values[PawnValue] = 100;
+    m_values[BishopValue] = 300;
+    m_values[KnightValue] = 300;
+    m_values[RookValue] = 500;
+    m_values[QueenValue] = 900;
+
+    // clang-format off
+    setTable(m_values, PawnSquareValues, {
+         0,  0,  0,  0,  0,  0,  0,  0,
+        50, 50, 50, 50, 50, 50, 50, 50,
+        10, 10, 20, 30, 30, 20, 10, 10,
+         5,  5, 10, 25, 25, 10,  5,  5,
+         0,  0,  0, 20, 20,  0,  0,  0,
+         5, -5,-10,  0,  0,-10, -5,  5,
+         5, 10, 10,-20,-20, 10, 10,  5,
+         0,  0,  0,  0,  0,  0,  0,  0
+    });
+    setTable(m_values, KnightSquareValues, {
+        -50,-40,-30,-30,-30,-30,-40,-50,
+        -40,-20,  0,  0,  0,  0,-20,-40,
+        -30,  0, 10, 15, 15, 10,  0,-30,
+        -30,  5, 15, 20, 20, 15,  5,-30,
+        -30,  0, 15, 20, 20, 15,  0,-30,
+        -30,  5, 10, 15, 15, 10,  5,-30,
+        -40,-20,  0,  5,  5,  0,-20,-40,
+        -50,-40,-30,-30,-30,-30,-40,-50
+    });
+    setTable(m_values, BishopSquareValues, {
+        -50,-40,-30,-30,-30,-30,-40,-50,
+        -40,-20,  0,  0,  0,  0,-20,-40,
+        -30,  0, 10, 15, 15, 10,  0,-30,
+        -30,  5, 15, 20, 20, 15,  5,-30,
+        -30,  0, 15, 20, 20, 15,  0,-30,
+        -30,  5, 10, 15, 15, 10,  5,-30,
+        -40,-20,  0,  5,  5,  0,-20,-40,
+        -50,-40,-30,-30,-30,-30,-40,-50
+    });
+    setTable(m_values, RookSquareValues, {
+        0,  0,  0,  0,  0,  0,  0,  0,
+         5, 10, 10, 10, 10, 10, 10,  5,
+        -5,  0,  0,  0,  0,  0,  0, -5,
+        -5,  0,  0,  0,  0,  0,  0, -5,
+        -5,  0,  0,  0,  0,  0,  0, -5,
+        -5,  0,  0,  0,  0,  0,  0, -5,
+        -5,  0,  0,  0,  0,  0,  0, -5,
+         0,  0,  0,  5,  5,  0,  0,  0
+    });
+    setTable(m_values, QueenSquareValues, {
+        -20,-10,-10, -5, -5,-10,-10,-20,
+        -10,  0,  0,  0,  0,  0,  0,-10,
+        -10,  0,  5,  5,  5,  5,  0,-10,
+         -5,  0,  5,  5,  5,  5,  0, -5,
+          0,  0,  5,  5,  5,  5,  0, -5,
+        -10,  5,  5,  5,  5,  5,  0,-10,
+        -10,  0,  5,  0,  0,  0,  0,-10,
+        -20,-10,-10, -5, -5,-10,-10,-20
+    });
+    setTable(m_values, KingMiddleGameSquareValues, {
+        -30,-40,-40,-50,-50,-40,-40,-30,
+        -30,-40,-40,-50,-50,-40,-40,-30,
+        -30,-40,-40,-50,-50,-40,-40,-30,
+        -30,-40,-40,-50,-50,-40,-40,-30,
+        -20,-30,-30,-40,-40,-30,-30,-20,
+        -10,-20,-20,-20,-20,-20,-20,-10,
+         20, 20,  0,  0,  0,  0, 20, 20,
+         20, 30, 10,  0,  0, 10, 30, 20
+    });
+    setTable(m_values, KingEndGameSquareValues, {
+        -50,-40,-30,-20,-20,-30,-40,-50,
+        -30,-20,-10,  0,  0,-10,-20,-30,
+        -30,-10, 20, 30, 30, 20,-10,-30,
+        -30,-10, 30, 40, 40, 30,-10,-30,
+        -30,-10, 30, 40, 40, 30,-10,-30,
+        -30,-10, 20, 30, 30, 20,-10,-30,
+        -30,-30,  0,  0,  0,  0,-30,-30,
+        -50,-30,-30,-30,-30,-30,-30,-50
+    });
+    // clang-format on
+
+    m_values[PawnShieldPenalty] = 40;
+    m_values[MopUpKingDistance] = 16;
+    m_values[MopUpCenterDistance] = 47;
+    setTable(m_values, MobilityValues, {0, 0, 4, 4, 2, 0, 1});
+    m_values[PawnThreatPenalty] = 30;
+    m_values[HangingPiecePenalty] = 20;
+    setTable(m_values, KingAttackWeights, {0, 1, 2, 2, 3, 0, 5});
+    m_values[MaxKingAttackPenalty] = 250;
+}
+
+const std::array<EvaluationParameters::Group, 20>& EvaluationParameters::getGroups()
+{
+    static const std::array<Group, 20> groups = {{
+        {"pawnValue", PawnValue, 1, true},
+        {"bishopValue", BishopValue, 1, true},
+        {"knightValue", KnightValue, 1, true},
+        {"rookValue", RookValue, 1, true},
+        {"queenValue", QueenValue, 1, true},
+        {"pawnSquareValues", PawnSquareValues, 64, true},
+        {"knightSquareValues", KnightSquareValues, 64, true},
+        {"bishopSquareValues", BishopSquareValues, 64, true},
+        {"rookSquareValues", RookSquareValues, 64, true},
+        {"queenSquareValues", QueenSquareValues, 64, true},
+        {"kingMiddleGameSquareValues", KingMiddleGameSquareValues, 64, true},
+        {"kingEndGameSquareValues", KingEndGameSquareValues, 64, true},
+        {"pawnShieldPenalty", PawnShieldPenalty, 1, true},
+        {"mopUpKingDistance", MopUpKingDistance, 1, true},
+        {"mopUpCenterDistance", MopUpCenterDistance, 1, true},
+        {"mobilityValues", MobilityValues, 7, true},
+        {"pawnThreatPenalty", PawnThreatPenalty, 1, true},
+        {"hangingPiecePenalty", HangingPiecePenalty, 1, true},
+        {"kingAttackWeights", KingAttackWeights, 7, false},
+        {"maxKingAttackPenalty", MaxKingAttackPenalty, 1, false},
+    }};
+    return groups;
+}
+
+bool EvaluationParameters::load(const std::string& path)
+{
+    std::ifstream file(path);
+    if (!file.is_open()) {
+        CHESS_LOG_ERROR("Couldn't open evaluation parameters file {}.", path);
+        return false;
+    }
+
+    auto values = m_values;
+    std::string line;
+    while (std::getline(file, line)) {
+        if (line.empty() || line[0] == '#')
+            continue;
+
+        std::istringstream stream(line);
+        std::string name;
+        stream >> name;
+
+        const auto& groups = getGroups();
+        auto group = std::find_if(groups.begin(), groups.end(),
+                                  [&name](const Group& group) { return name == group.name; });
+        if (group == groups.end()) {
+            CHESS_LOG_ERROR("Unknown evaluation parameter {} in {}.", name, path);
+            return false;
+        }
+
+        for (size_t i = 0; i < group->size; ++i) {
+            if (!(stream >> values[group->first + i])) {
+                CHESS_LOG_ERROR("Evaluation parameter {} must have {} values.", name,
+                                group->size);
+                return false;
+            }
+        }
+    }
+
+    m_values = values;
+    return true;
+}
+
+bool EvaluationParameters::save(const std::string& path) const
+{
+    std::ofstream file(path);
+    if (!file.is_open()) {
+        CHESS_LOG_ERROR("Couldn't open evaluation parameters file {} for writing.", path);
+        return false;
+    }
+
+    file << "# Chess engine evaluation parameters.\n";
+    for (const auto& group : getGroups()) {
+        file << group.name;
+        for (size_t i = 0; i < group.size; ++i)
+            file << ' ' << m_values[group.first + i];
+        file << '\n';
+    }
+    return static_cast<bool>(file);
+}
+
+} // namespace chessAi
@@ -0,0 +1,94 @@
+#pragma once
+
+#include <array>
+#include <string>
+
+namespace chessAi
+{
+
+/**
+ * All evaluation weights stored as one flat array, so they can be tuned (see tools/texelTuner),
+ * saved to and loaded from a text file.
+ *
+ * Index enum names single values and first indices of tables. Tables are orientated with white
+ * at the bottom, indexed by board position (a8 = 0).
+ */
+class EvaluationParameters
+{
+public:
+    enum Index : size_t
+    {
+        PawnValue = 0,
+        BishopValue,
+        KnightValue,
+        RookValue,
+        QueenValue,
+        PawnSquareValues,
+        KnightSquareValues = PawnSquareValues + 64,
+        BishopSquareValues = KnightSquareValues + 64,
+        RookSquareValues = BishopSquareValues + 64,
+        QueenSquareValues = RookSquareValues + 64,
+        KingMiddleGameSquareValues = QueenSquareValues + 64,
+        KingEndGameSquareValues = KingMiddleGameSquareValues + 64,
+        PawnShieldPenalty = KingEndGameSquareValues + 64,
+        // Mop-up weights are in tenths of a centipawn per square of distance.
+        MopUpKingDistance,
+        MopUpCenterDistance,
+        // Indexed by PieceFigure: Empty, Pawn, Bishop, Knight, Rook, King, Queen.
+        MobilityValues,
+        PawnThreatPenalty = MobilityValues + 7,
+        HangingPiecePenalty,
+        // Indexed by PieceFigure.
+        KingAttackWeights,
+        MaxKingAttackPenalty = KingAttackWeights + 7,
+        NumberOfParameters
+    };
+
+    /**
+     * Named range of parameters, used for the file format and to select tunable parameters.
+     * Parameters which enter the evaluation non linearly are not tunable.
+     */
+    struct Group
+    {
+        const char* name;
+        size_t first;
+        size_t size;
+        bool tunable;
+    };
+
+public:
+    /**
+     * Default (hand-set) values.
+     */
+    EvaluationParameters();
+
+    int operator[](size_t index) const;
+    int& operator[](size_t index);
+
+    static const std::array<Group, 20>& getGroups();
+
+    /**
+     * File has one group per line: name followed by its values. Groups missing in the file keep
+     * their current value. Lines starting with # are comments.
+     *
+     * @return true If successful.
+     */
+    bool load(const std::string& path);
+
+    bool save(const std::string& path) const;
+
+private:
+    std::array<int, NumberOfParameters> m_values;
+};
+
+inline int EvaluationParameters::operator[](size_t index) const
+{
+    return m_values[index];
+}
+
+inline int& EvaluationParameters::operator[](size_t index)
+{
+    return m_values[index];
+}
+
+} // namespace chessAi
@@ -0,0 +1,339 @@
+#include "Fen.h"
+#include "AttackMaps.h"
+#include "King.h"
+#include "Knight.h"
+#include "MappedFile.h"
+#include "Notation.h"
+#include "Pawn.h"
+#include "PieceBitBoards.h"
+
+#include <algorithm>
+#include <array>
+
+namespace chessAi
+{
+
+namespace
+{
+
+/**
+ * Piece letters in order of PieceType::getPieceIndex.
+ */
+constexpr std::string_view pieceLetters = "PBNRKQpbnrkq";
+
+bool isSpace(char c)
+{
+    return c == ' ' || c == '\t' || c == '\r' || c == '\n';
+}
+
+std::string_view trimLeft(std::string_view text)
+{
+    while (!text.empty() && isSpace(text.front()))
+        text.remove_prefix(1);
+    return text;
+}
+
+std::string_view trim(std::string_view text)
+{
+    text = trimLeft(text);
+    while (!text.empty() && isSpace(text.back()))
+        text.remove_suffix(1);
+    return text;
+}
+
+/**
+ * Removes next space separated field from the text and returns it.
+ */
+std::string_view nextField(std::string_view& text)
+{
+    text = trimLeft(text);
+    size_t end = 0;
+    while (end < text.size() && !isSpace(text[end]))
+        ++end;
+    auto field = text.substr(0, end);
+    text.remove_prefix(end);
+    return field;
+}
+
+std::optional<unsigned int> parseNumber(std::string_view field)
+{
+    if (field.empty() || field.size() > 9)
+        return {};
+
+    unsigned int value = 0;
+    for (char c : field) {
+        if (c < '0' || c > '9')
+            return {};
+        value = value * 10 + static_cast<unsigned int>(c - '0');
+    }
+    return value;
+}
+
+bool parsePlacement(std::string_view placement, std::array<uint64_t, 12>& pieceBitBoards)
+{
+    unsigned int row = 0;
+    unsigned int column = 0;
+    for (char c : placement) {
+        if (c == '/') {
+            if (column != 8 || row == 7)
+                return false;
+            ++row;
+            column = 0;
+        }
+        else if (c >= '1' && c <= '8') {
+            column += static_cast<unsigned int>(c - '0');
+            if (column > 8)
+                return false;
+        }
+        else {
+            auto index = pieceLetters.find(c);
+            if (index == std::string_view::npos || column >= 8)
+                return false;
+            pieceBitBoards[index] |= 1ULL << (row * 8 + column);
+            ++column;
+        }
+    }
+    return row == 7 && column == 8;
+}
+
+/**
+ * Checks the king of the color on square is attacked, on bit boards in order of pieceLetters.
+ */
+template <PieceColor TColor>
+bool isKingAttacked(const std::array<uint64_t, 12>& pieceBitBoards, unsigned int square)
+{
+    // Opponent pieces start at index 6 for white, 0 for black.
+    constexpr size_t opponent = (TColor == PieceColor::White) ? 6 : 0;
+    const auto& magicAttacks = AttackMaps::getMagicAttacks();
+    uint64_t occupancy = 0;
+    for (auto bitBoard : pieceBitBoards)
+        occupancy |= bitBoard;
+
+    auto diagonal = pieceBitBoards[opponent + 1] | pieceBitBoards[opponent + 5];
+    auto straight = pieceBitBoards[opponent + 3] | pieceBitBoards[opponent + 5];
+    // Pawns attacking the square are on the squares a pawn of this color attacks from it.
+    return (Pawn<TColor>::originToAttacks[square] & pieceBitBoards[opponent]) ||
+           (Knight::originToAttacks[square] & pieceBitBoards[opponent + 2]) ||
+           (King::originToAttacks[square] & pieceBitBoards[opponent + 4]) ||
+           (magicAttacks.Bishop(occupancy, static_cast<int>(square)) & diagonal) ||
+           (magicAttacks.Rook(occupancy, static_cast<int>(square)) & straight);
+}
+
+/**
+ * One king per side and the side which just moved is not in check.
+ */
+bool isLegalPosition(const std::array<uint64_t, 12>& pieceBitBoards, PieceColor activeColor)
+{
+    auto whiteKing = pieceBitBoards[4];
+    auto blackKing = pieceBitBoards[10];
+    if (PieceBitBoards::countSetBits(whiteKing) != 1 ||
+        PieceBitBoards::countSetBits(blackKing) != 1)
+        return false;
+
+    if (activeColor == PieceColor::White)
+        return !isKingAttacked<PieceColor::Black>(
+            pieceBitBoards, PieceBitBoards::getLeastSignificantSetBit(blackKing));
+    return !isKingAttacked<PieceColor::White>(
+        pieceBitBoards, PieceBitBoards::getLeastSignificantSetBit(whiteKing));
+}
+
+} // namespace
+
+bool Fen::parse(std::string_view fen, PieceBitBoards& bitBoards, std::string_view* rest)
+{
+    std::array<uint64_t, 12> pieceBitBoards{};
+    if (!parsePlacement(nextField(fen), pieceBitBoards))
+        return false;
+
+    auto activeColor = nextField(fen);
+    if (activeColor != "w" && activeColor != "b")
+        return false;
+    auto color = (activeColor == "w") ? PieceColor::White : PieceColor::Black;
+    if (!isLegalPosition(pieceBitBoards, color))
+        return false;
+
+    auto castlingRights = nextField(fen);
+    bool castling[4] = {false, false, false, false};
+    if (castlingRights != "-") {
+        if (castlingRights.empty())
+            return false;
+        for (char c : castlingRights) {
+            auto index = std::string_view("KQkq").find(c);
+            if (index == std::string_view::npos)
+                return false;
+            castling[index] = true;
+        }
+    }
+
+    uint16_t enPassantTargetSquare = 0;
+    auto enPassant = nextField(fen);
+    if (enPassant != "-") {
+        auto position = Notation::fieldToPosition(enPassant);
+        // Target square is on the 6th rank for white, 3rd for black.
+        if (!position.has_value() || (*position / 8 != 2 && *position / 8 != 5))
+            return false;
+        enPassantTargetSquare = *position;
+    }
+
+    // Optional half move clock and full move number, missing in EPD.
+    unsigned int fullMoveNumber = 1;
+    auto clocks = fen;
+    if (parseNumber(nextField(clocks)).has_value()) {
+        fen = clocks;
+        if (auto number = parseNumber(nextField(clocks)); number.has_value()) {
+            fen = clocks;
+            fullMoveNumber = std::max(1u, *number);
+        }
+    }
+
+    bitBoards.setBitBoardsByPieceIndex(pieceBitBoards);
+    bitBoards.currentMoveColor = color;
+    bitBoards.whiteKingSideCastle = castling[0];
+    bitBoards.whiteQueenSideCastle = castling[1];
+    bitBoards.blackKingSideCastle = castling[2];
+    bitBoards.blackQueenSideCastle = castling[3];
+    bitBoards.enPassantTargetSquare = enPassantTargetSquare;
+    bitBoards.halfMoveCount =
+        2 * (fullMoveNumber - 1) + ((bitBoards.currentMoveColor == PieceColor::Black) ? 1 : 0);
+    bitBoards.updatePiecePositions();
+
+    if (rest)
+        *rest = trim(fen);
+    return true;
+}
+
+size_t Fen::write(const PieceBitBoards& bitBoards, char* buffer)
+{
+    std::array<char, 64> squares{};
+    auto pieceBitBoards = bitBoards.getBitBoardsByPieceIndex();
+    for (size_t index = 0; index < pieceBitBoards.size(); ++index) {
+        for (auto bitBoard = pieceBitBoards[index]; bitBoard; bitBoard &= bitBoard - 1)
+            squares[PieceBitBoards::getLeastSignificantSetBit(bitBoard)] = pieceLetters[index];
+    }
+
+    char* out = buffer;
+    for (unsigned int row = 0; row < 8; ++row) {
+        char empty = '0';
+        for (unsigned int column = 0; column < 8; ++column) {
+            char piece = squares[row * 8 + column];
+            if (!piece) {
+                ++empty;
+                continue;
+            }
+            if (empty != '0')
+                *out++ = empty;
+            empty = '0';
+            *out++ = piece;
+        }
+        if (empty != '0')
+            *out++ = empty;
+        if (row != 7)
+            *out++ = '/';
+    }
+
+    *out++ = ' ';
+    *out++ = (bitBoards.currentMoveColor == PieceColor::White) ? 'w' : 'b';
+
+    *out++ = ' ';
+    char* castlingStart = out;
+    if (bitBoards.whiteKingSideCastle)
+        *out++ = 'K';
+    if (bitBoards.whiteQueenSideCastle)
+        *out++ = 'Q';
+    if (bitBoards.blackKingSideCastle)
+        *out++ = 'k';
+    if (bitBoards.blackQueenSideCastle)
+        *out++ = 'q';
+    if (out == castlingStart)
+        *out++ = '-';
+
+    *out++ = ' ';
+    if (bitBoards.enPassantTargetSquare != 0) {
+        *out++ = static_cast<char>('a' + bitBoards.enPassantTargetSquare % 8);
+        *out++ = static_cast<char>('8' - bitBoards.enPassantTargetSquare / 8);
+    }
+    else
+        *out++ = '-';
+
+    *out++ = ' ';
+    *out++ = '0';
+    *out++ = ' ';
+
+    // Digits of the full move number are written in reverse, then flipped.
+    auto fullMoveNumber = bitBoards.halfMoveCount / 2 + 1;
+    char* numberStart = out;
+    do {
+        *out++ = static_cast<char>('0' + fullMoveNumber % 10);
+        fullMoveNumber /= 10;
+    } while (fullMoveNumber > 0);
+    std::reverse(numberStart, out);
+
+    return static_cast<size_t>(out - buffer);
+}
+
+std::string Fen::toString(const PieceBitBoards& bitBoards)
+{
+    char buffer[maxLength];
+    return std::string(buffer, write(bitBoards, buffer));
+}
+
+std::optional<std::string_view> Fen::getEpdOperation(std::string_view operations,
+                                                     std::string_view opcode)
+{
+    while (true) {
+        auto currentOpcode = nextField(operations);
+        if (currentOpcode.empty())
+            return {};
+
+        std::string_view operand;
+        if (currentOpcode.back() == ';') {
+            // Operation without operands.
+            currentOpcode.remove_suffix(1);
+        }
+        else {
+            // Operand ends at ';' which is not inside quotes.
+            size_t end = 0;
+            bool quoted = false;
+            while (end < operations.size() && (quoted || operations[end] != ';')) {
+                if (operations[end] == '"')
+                    quoted = !quoted;
+                ++end;
+            }
+            operand = trim(operations.substr(0, end));
+            operations.remove_prefix(std::min(end + 1, operations.size()));
+        }
+        if (currentOpcode != opcode)
+            continue;
+
+        if (operand.size() >= 2 && operand.front() == '"' && operand.back() == '"')
+            operand = operand.substr(1, operand.size() - 2);
+        return operand;
+    }
+}
+
+std::optional<size_t> Fen::forEachEpdLine(
+    const std::string& path,
+    const std::function<void(const PieceBitBoards&, std::string_view operations)>& callback)
+{
+    MappedFile file(path);
+    if (!file.isOpen())
+        return {};
+
+    std::string_view text(file.data(), file.size());
+    PieceBitBoards bitBoards;
+    size_t validLines = 0;
+    while (!text.empty()) {
+        auto end = text.find('\n');
+        auto line = text.substr(0, end);
+        text.remove_prefix((end == std::string_view::npos) ? text.size() : end + 1);
+
+        std::string_view operations;
+        if (trim(line).empty() || !parse(line, bitBoards, &operations))
+            continue;
+        callback(bitBoards, operations);
+        ++validLines;
+    }
+    return validLines;
+}
+
+} // namespace chessAi
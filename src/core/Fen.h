@@ -0,0 +1,73 @@
+#pragma once
+
+#include <cstddef>
+#include <functional>
+#include <optional>
+#include <string>
+#include <string_view>
+
+namespace chessAi
+{
+
+struct PieceBitBoards;
+
+/**
+ * Reading and writing positions in FEN and EPD notation.
+ *
+ * Parsing works on string views and writes into existing bit boards, reusing their memory, so
+ * loading many positions into the same bit boards does not allocate. Writing uses a caller
+ * provided buffer.
+ */
+class Fen
+{
+public:
+    /**
+     * Longest possible FEN written by write.
+     */
+    static constexpr size_t maxLength = 96;
+
+    static constexpr std::string_view startingPosition =
+        "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1";
+
+    /**
+     * Parses piece placement, active color, castling rights and en passant square, followed by
+     * optional half move clock and full move number. Full move number sets
+     * PieceBitBoards::halfMoveCount.
+     *
+     * @param rest Set to the text after the parsed fields (EPD operations), if not nullptr.
+     *
+     * @return false If FEN is not valid, or the position is not legal: not exactly one king per
+     * side or the side not to move is in check. Bit boards are left unchanged.
+     */
+    static bool parse(std::string_view fen, PieceBitBoards& bitBoards,
+                      std::string_view* rest = nullptr);
+
+    /**
+     * Writes FEN of the position to buffer, which must have at least maxLength characters. Half
+     * move clock is not tracked by the engine and written as 0.
+     *
+     * @return Length of the written FEN.
+     */
+    static size_t write(const PieceBitBoards& bitBoards, char* buffer);
+
+    static std::string toString(const PieceBitBoards& bitBoards);
+
+    /**
+     * Operand of the EPD operation (bm, am, id, ...), without quotes and the terminating ';'.
+     * Multiple operands are returned as one string separated by spaces.
+     */
+    static std::optional<std::string_view> getEpdOperation(std::string_view operations,
+                                                           std::string_view opcode);
+
+    /**
+     * Memory maps the EPD (or FEN per line) file and parses it in place, calling callback for
+     * every valid line with the position and its EPD operations. Invalid lines are skipped.
+     *
+     * @return Number of valid lines, empty optional if file couldn't be opened.
+     */
+    static std::optional<size_t> forEachEpdLine(
+        const std::string& path,
+        const std::function<void(const PieceBitBoards&, std::string_view operations)>& callback);
+};
+
+} // namespace chessAi
@@ -0,0 +1,450 @@
+#include "Json.h"
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+
+namespace chessAi
+{
+
+namespace
+{
+
+class Parser
+{
+public:
+    explicit Parser(std::string_view text) : m_text(text), m_position(0) {}
+
+    bool parseDocument(JsonValue& value)
+    {
+        if (!parseValue(value, 0))
+            return false;
+        skipWhitespace();
+        return m_position == m_text.size();
+    }
+
+private:
+    // Deeper documents are rejected instead of overflowing the stack.
+    inline static constexpr unsigned int s_maxDepth = 64;
+
+    void skipWhitespace()
+    {
+        while (m_position < m_text.size() &&
+               (m_text[m_position] == ' ' || m_text[m_position] == '\t' ||
+                m_text[m_position] == '\n' || m_text[m_position] == '\r'))
+            ++m_position;
+    }
+
+    bool consume(std::string_view token)
+    {
+        if (m_text.substr(m_position, token.size()) != token)
+            return false;
+        m_position += token.size();
+        return true;
+    }
+
+    bool parseValue(JsonValue& value, unsigned int depth)
+    {
+        skipWhitespace();
+        if (m_position >= m_text.size() || depth > s_maxDepth)
+            return false;
+
+        char c = m_text[m_position];
+        if (c == '{')
+            return parseObject(value, depth);
+        if (c == '[')
+            return parseArray(value, depth);
+        if (c == '"') {
+            std::string string;
+            if (!parseString(string))
+                return false;
+            value = JsonValue(std::move(string));
+            return true;
+        }
+        if (consume("true"))
+            value = JsonValue(true);
+        else if (consume("false"))
+            value = JsonValue(false);
+        else if (consume("null"))
+            value = JsonValue(nullptr);
+        else
+            return parseNumber(value);
+        return true;
+    }
+
+    bool parseObject(JsonValue& value, unsigned int depth)
+    {
+        ++m_position;
+        value = JsonValue(JsonValue::Object());
+        skipWhitespace();
+        if (consume("}"))
+            return true;
+
+        while (true) {
+            skipWhitespace();
+            std::string key;
+            if (!parseString(key))
+                return false;
+            skipWhitespace();
+            if (!consume(":") || !parseValue(value[key], depth + 1))
+                return false;
+            skipWhitespace();
+            if (consume("}"))
+                return true;
+            if (!consume(","))
+                return false;
+        }
+    }
+
+    bool parseArray(JsonValue& value, unsigned int depth)
+    {
+        ++m_position;
+        value = JsonValue(JsonValue::Array());
+        skipWhitespace();
+        if (consume("]"))
+            return true;
+
+        while (true) {
+            JsonValue element;
+            if (!parseValue(element, depth + 1))
+                return false;
+            value.push(std::move(element));
+            skipWhitespace();
+            if (consume("]"))
+                return true;
+            if (!consume(","))
+                return false;
+        }
+    }
+
+    bool parseString(std::string& string)
+    {
+        if (!consume("\""))
+            return false;
+
+        while (m_position < m_text.size()) {
+            char c = m_text[m_position++];
+            if (c == '"')
+                return true;
+            if (c != '\\') {
+                string += c;
+                continue;
+            }
+            if (m_position >= m_text.size())
+                return false;
+            char escaped = m_text[m_position++];
+            switch (escaped) {
+            case '"':
+            case '\\':
+            case '/':
+                string += escaped;
+                break;
+            case 'b':
+                string += '\b';
+                break;
+            case 'f':
+                string += '\f';
+                break;
+            case 'n':
+                string += '\n';
+                break;
+            case 'r':
+                string += '\r';
+                break;
+            case 't':
+                string += '\t';
+                break;
+            case 'u': {
+                auto codePoint = parseHex();
+                if (!codePoint.has_value())
+                    return false;
+                appendUtf8(string, *codePoint);
+                break;
+            }
+            default:
+                return false;
+            }
+        }
+        return false;
+    }
+
+    std::optional<unsigned int> parseHex()
+    {
+        if (m_position + 4 > m_text.size())
+            return {};
+        unsigned int value = 0;
+        for (int i = 0; i < 4; ++i) {
+            char c = m_text[m_position++];
+            value <<= 4;
+            if (c >= '0' && c <= '9')
+                value |= static_cast<unsigned int>(c - '0');
+            else if (c >= 'a' && c <= 'f')
+                value |= static_cast<unsigned int>(c - 'a' + 10);
+            else if (c >= 'A' && c <= 'F')
+                value |= static_cast<unsigned int>(c - 'A' + 10);
+            else
+                return {};
+        }
+        return value;
+    }
+
+    /**
+     * Surrogate pairs are not combined, tools only use ASCII.
+     */
+    static void appendUtf8(std::string& string, unsigned int codePoint)
+    {
+        if (codePoint < 0x80) {
+            string += static_cast<char>(codePoint);
+        }
+        else if (codePoint < 0x800) {
+            string += static_cast<char>(0xC0 | (codePoint >> 6));
+            string += static_cast<char>(0x80 | (codePoint & 0x3F));
+        }
+        else {
+            string += static_cast<char>(0xE0 | (codePoint >> 12));
+            string += static_cast<char>(0x80 | ((codePoint >> 6) & 0x3F));
+            string += static_cast<char>(0x80 | (codePoint & 0x3F));
+        }
+    }
+
+    bool parseNumber(JsonValue& value)
+    {
+        auto start = m_position;
+        while (m_position < m_text.size() &&
+               std::string_view("+-0123456789.eE").find(m_text[m_position]) !=
+                   std::string_view::npos)
+            ++m_position;
+        if (start == m_position)
+            return false;
+
+        std::string number(m_text.substr(start, m_position - start));
+        char* end = nullptr;
+        double parsed = std::strtod(number.c_str(), &end);
+        if (end != number.c_str() + number.size())
+            return false;
+        value = JsonValue(parsed);
+        return true;
+    }
+
+private:
+    std::string_view m_text;
+    size_t m_position;
+};
+
+void writeString(std::string& out, const std::string& string)
+{
+    out += '"';
+    for (char c : string) {
+        switch (c) {
+        case '"':
+            out += "\\\"";
+            break;
+        case '\\':
+            out += "\\\\";
+            break;
+        case '\n':
+            out += "\\n";
+            break;
+        case '\r':
+            out += "\\r";
+            break;
+        case '\t':
+            out += "\\t";
+            break;
+        default:
+            if (static_cast<unsigned char>(c) < 0x20) {
+                char escaped[8];
+                std::snprintf(escaped, sizeof(escaped), "\\u%04x", static_cast<unsigned int>(c));
+                out += escaped;
+            }
+            else {
+                out += c;
+            }
+        }
+    }
+    out += '"';
+}
+
+void writeNumber(std::string& out, double value)
+{
+    if (!std::isfinite(value)) {
+        out += "null";
+        return;
+    }
+    char number[32];
+    // Integers (node counts, scores) are written without exponent or fraction.
+    if (value == std::floor(value) && std::abs(value) < 1e15)
+        std::snprintf(number, sizeof(number), "%lld", static_cast<long long>(value));
+    else
+        std::snprintf(number, sizeof(number), "%.10g", value);
+    out += number;
+}
+
+const JsonValue::Array s_emptyArray;
+const JsonValue::Object s_emptyObject;
+
+} // namespace
+
+JsonValue::JsonValue() : m_value(nullptr) {}
+
+JsonValue::JsonValue(std::nullptr_t) : m_value(nullptr) {}
+
+JsonValue::JsonValue(bool value) : m_value(value) {}
+
+JsonValue::JsonValue(double value) : m_value(value) {}
+
+JsonValue::JsonValue(int value) : m_value(static_cast<double>(value)) {}
+
+JsonValue::JsonValue(unsigned int value) : m_value(static_cast<double>(value)) {}
+
+JsonValue::JsonValue(int64_t value) : m_value(static_cast<double>(value)) {}
+
+JsonValue::JsonValue(uint64_t value) : m_value(static_cast<double>(value)) {}
+
+JsonValue::JsonValue(std::string value) : m_value(std::move(value)) {}
+
+JsonValue::JsonValue(const char* value) : m_value(std::string(value)) {}
+
+JsonValue::JsonValue(Array value) : m_value(std::move(value)) {}
+
+JsonValue::JsonValue(Object value) : m_value(std::move(value)) {}
+
+std::optional<JsonValue> JsonValue::parse(std::string_view text)
+{
+    JsonValue value;
+    if (!Parser(text).parseDocument(value))
+        return {};
+    return value;
+}
+
+std::string JsonValue::toString() const
+{
+    std::string out;
+    write(out);
+    return out;
+}
+
+void JsonValue::write(std::string& out) const
+{
+    if (isNull()) {
+        out += "null";
+    }
+    else if (isBool()) {
+        out += std::get<bool>(m_value) ? "true" : "false";
+    }
+    else if (isNumber()) {
+        writeNumber(out, std::get<double>(m_value));
+    }
+    else if (isString()) {
+        writeString(out, std::get<std::string>(m_value));
+    }
+    else if (isArray()) {
+        out += '[';
+        bool first = true;
+        for (const auto& value : std::get<Array>(m_value)) {
+            if (!first)
+                out += ',';
+            first = false;
+            value.write(out);
+        }
+        out += ']';
+    }
+    else {
+        out += '{';
+        bool first = true;
+        for (const auto& [key, value] : std::get<Object>(m_value)) {
+            if (!first)
+                out += ',';
+            first = false;
+            writeString(out, key);
+            out += ':';
+            value.write(out);
+        }
+        out += '}';
+    }
+}
+
+bool JsonValue::isNull() const
+{
+    return std::holds_alternative<std::nullptr_t>(m_value);
+}
+
+bool JsonValue::isBool() const
+{
+    return std::holds_alternative<bool>(m_value);
+}
+
+bool JsonValue::isNumber() const
+{
+    return std::holds_alternative<double>(m_value);
+}
+
+bool JsonValue::isString() const
+{
+    return std::holds_alternative<std::string>(m_value);
+}
+
+bool JsonValue::isArray() const
+{
+    return std::holds_alternative<Array>(m_value);
+}
+
+bool JsonValue::isObject() const
+{
+    return std::holds_alternative<Object>(m_value);
+}
+
+bool JsonValue::getBool(bool defaultValue) const
+{
+    return isBool() ? std::get<bool>(m_value) : defaultValue;
+}
+
+double JsonValue::getNumber(double defaultValue) const
+{
+    return isNumber() ? std::get<double>(m_value) : defaultValue;
+}
+
+std::string JsonValue::getString(const std::string& defaultValue) const
+{
+    return isString() ? std::get<std::string>(m_value) : defaultValue;
+}
+
+const JsonValue::Array& JsonValue::getArray() const
+{
+    return isArray() ? std::get<Array>(m_value) : s_emptyArray;
+}
+
+const JsonValue::Object& JsonValue::getObject() const
+{
+    return isObject() ? std::get<Object>(m_value) : s_emptyObject;
+}
+
+const JsonValue* JsonValue::find(const std::string& key) const
+{
+    if (!isObject())
+        return nullptr;
+    const auto& object = std::get<Object>(m_value);
+    auto it = object.find(key);
+    return it != object.end() ? &it->second : nullptr;
+}
+
+JsonValue& JsonValue::operator[](const std::string& key)
+{
+    if (!isObject())
+        m_value = Object();
+    return std::get<Object>(m_value)[key];
+}
+
+void JsonValue::push(JsonValue value)
+{
+    if (!isArray())
+        m_value = Array();
+    std::get<Array>(m_value).push_back(std::move(value));
+}
+
+bool JsonValue::operator==(const JsonValue& other) const
+{
+    return m_value == other.m_value;
+}
+
+} // namespace chessAi
@@ -0,0 +1,90 @@
+#pragma once
+
+#include <cstdint>
+#include <map>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <variant>
+#include <vector>
+
+namespace chessAi
+{
+
+/**
+ * Minimal JSON value for line based protocols and tool output (analysis server, batch analysis,
+ * benchmark results). Numbers are doubles, object keys are sorted.
+ */
+class JsonValue
+{
+public:
+    using Array = std::vector<JsonValue>;
+    using Object = std::map<std::string, JsonValue>;
+
+public:
+    JsonValue();
+    JsonValue(std::nullptr_t);
+    JsonValue(bool value);
+    JsonValue(double value);
+    JsonValue(int value);
+    JsonValue(unsigned int value);
+    JsonValue(int64_t value);
+    JsonValue(uint64_t value);
+    JsonValue(std::string value);
+    JsonValue(const char* value);
+    JsonValue(Array value);
+    JsonValue(Object value);
+
+    /**
+     * Parses one JSON document, surrounding whitespace is allowed.
+     *
+     * @return Empty optional if the text is not valid JSON.
+     */
+    static std::optional<JsonValue> parse(std::string_view text);
+
+    /**
+     * Compact JSON text, without new lines.
+     */
+    std::string toString() const;
+
+    bool isNull() const;
+    bool isBool() const;
+    bool isNumber() const;
+    bool isString() const;
+    bool isArray() const;
+    bool isObject() const;
+
+    /**
+     * Getters return the default value if the type doesn't match.
+     */
+    bool getBool(bool defaultValue = false) const;
+    double getNumber(double defaultValue = 0.0) const;
+    std::string getString(const std::string& defaultValue = "") const;
+    const Array& getArray() const;
+    const Object& getObject() const;
+
+    /**
+     * Member of an object, nullptr if missing or not an object.
+     */
+    const JsonValue* find(const std::string& key) const;
+
+    /**
+     * Member of an object, the value becomes an object if it is not one.
+     */
+    JsonValue& operator[](const std::string& key);
+
+    /**
+     * Appends to an array, the value becomes an array if it is not one.
+     */
+    void push(JsonValue value);
+
+    bool operator==(const JsonValue& other) const;
+
+private:
+    void write(std::string& out) const;
+
+private:
+    std::variant<std::nullptr_t, bool, double, std::string, Array, Object> m_value;
+};
+
+} // namespace chessAi
@@ -0,0 +1,183 @@
+#include "MappedFile.h"
+
+#include <utility>
+
+#ifdef _WIN32
+    #define WIN32_LEAN_AND_MEAN
+    #define NOMINMAX
+    #include <windows.h>
+#else
+    #include <fcntl.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <unistd.h>
+#endif
+
+namespace chessAi
+{
+
+#ifdef _WIN32
+
+MappedFile::MappedFile(const std::string& path)
+{
+    HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+                              FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE) {
+        CHESS_LOG_ERROR("Couldn't open {}.", path);
+        return;
+    }
+    m_file = file;
+
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(file, &size)) {
+        CHESS_LOG_ERROR("Couldn't get size of {}.", path);
+        close();
+        return;
+    }
+    m_size = static_cast<size_t>(size.QuadPart);
+    // Empty files can't be mapped, but are valid.
+    if (m_size == 0)
+        return;
+
+    m_mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (m_mapping == nullptr) {
+        CHESS_LOG_ERROR("Couldn't map {}.", path);
+        close();
+        return;
+    }
+
+    m_data = static_cast<const char*>(MapViewOfFile(m_mapping, FILE_MAP_READ, 0, 0, 0));
+    if (m_data == nullptr) {
+        CHESS_LOG_ERROR("Couldn't map {}.", path);
+        close();
+    }
+}
+
+void MappedFile::close()
+{
+    if (m_data != nullptr)
+        UnmapViewOfFile(m_data);
+    if (m_mapping != nullptr)
+        CloseHandle(m_mapping);
+    if (m_file != nullptr)
+        CloseHandle(m_file);
+
+    m_data = nullptr;
+    m_mapping = nullptr;
+    m_file = nullptr;
+    m_size = 0;
+}
+
+bool MappedFile::isOpen() const
+{
+    return m_file != nullptr;
+}
+
+MappedFile::MappedFile(MappedFile&& other) noexcept
+    : m_data(std::exchange(other.m_data, nullptr)), m_size(std::exchange(other.m_size, 0)),
+      m_file(std::exchange(other.m_file, nullptr)),
+      m_mapping(std::exchange(other.m_mapping, nullptr))
+{
+}
+
+MappedFile& MappedFile::operator=(MappedFile&& other) noexcept
+{
+    if (this != &other) {
+        close();
+        m_data = std::exchange(other.m_data, nullptr);
+        m_size = std::exchange(other.m_size, 0);
+        m_file = std::exchange(other.m_file, nullptr);
+        m_mapping = std::exchange(other.m_mapping, nullptr);
+    }
+    return *this;
+}
+
+#else
+
+namespace
+{
+
+// Marks an open empty file, mmap of zero bytes is not allowed.
+const char s_emptyFile = 0;
+
+} // namespace
+
+MappedFile::MappedFile(const std::string& path)
+{
+    int file = ::open(path.c_str(), O_RDONLY);
+    if (file < 0) {
+        CHESS_LOG_ERROR("Couldn't open {}.", path);
+        return;
+    }
+
+    struct stat status;
+    if (fstat(file, &status) != 0) {
+        CHESS_LOG_ERROR("Couldn't get size of {}.", path);
+        ::close(file);
+        return;
+    }
+
+    m_size = static_cast<size_t>(status.st_size);
+    if (m_size == 0) {
+        m_data = &s_emptyFile;
+        ::close(file);
+        return;
+    }
+
+    void* data = mmap(nullptr, m_size, PROT_READ, MAP_SHARED, file, 0);
+    // Mapping stays valid after the descriptor is closed.
+    ::close(file);
+    if (data == MAP_FAILED) {
+        CHESS_LOG_ERROR("Couldn't map {}.", path);
+        m_size = 0;
+        return;
+    }
+    m_data = static_cast<const char*>(data);
+}
+
+void MappedFile::close()
+{
+    if (m_data != nullptr && m_data != &s_emptyFile)
+        munmap(const_cast<char*>(m_data), m_size);
+    m_data = nullptr;
+    m_size = 0;
+}
+
+bool MappedFile::isOpen() const
+{
+    return m_data != nullptr;
+}
+
+MappedFile::MappedFile(MappedFile&& other) noexcept
+    : m_data(std::exchange(other.m_data, nullptr)), m_size(std::exchange(other.m_size, 0))
+{
+}
+
+MappedFile& MappedFile::operator=(MappedFile&& other) noexcept
+{
+    if (this != &other) {
+        close();
+        m_data = std::exchange(other.m_data, nullptr);
+        m_size = std::exchange(other.m_size, 0);
+    }
+    return *this;
+}
+
+#endif
+
+MappedFile::~MappedFile()
+{
+    close();
+}
+
+const char* MappedFile::data() const
+{
+    return m_data;
+}
+
+size_t MappedFile::size() const
+{
+    return m_size;
+}
+
+} // namespace chessAi
@@ -0,0 +1,49 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+
+namespace chessAi
+{
+
+/**
+ * Read only memory mapping of a whole file. Pages are loaded by the OS on first access, so
+ * opening is constant time regardless of file size and the mapping is shared between processes.
+ * Safe to read from many threads.
+ */
+class MappedFile
+{
+public:
+    MappedFile() = default;
+
+    /**
+     * Check isOpen() for success, errors are logged.
+     */
+    explicit MappedFile(const std::string& path);
+
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+    MappedFile(MappedFile&& other) noexcept;
+    MappedFile& operator=(MappedFile&& other) noexcept;
+
+    bool isOpen() const;
+
+    const char* data() const;
+
+    size_t size() const;
+
+private:
+    void close();
+
+private:
+    const char* m_data = nullptr;
+    size_t m_size = 0;
+#ifdef _WIN32
+    void* m_file = nullptr;
+    void* m_mapping = nullptr;
+#endif
+};
+
+} // namespace chessAi
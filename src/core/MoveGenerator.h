@@ -1,11 +1,13 @@
 #pragma once
 
+#include "AttackMaps.h"
 #include "King.h"
 #include "Knight.h"
 #include "Move.h"
 #include "Pawn.h"
 #include "PieceBitBoards.h"
 #include "PieceType.h"
+#include "Profiler.h"
 #include "magic-bits-master/include/magic_bits.hpp"
 
 #include <algorithm>
@@ -25,6 +27,18 @@ class MoveGeneratorWrapper
 public:
     template <MoveType TMoveType>
     static std::vector<Move> generateLegalMoves(const PieceBitBoards& bitBoards);
+
+    /**
+     * Same as above, but check detection of current position uses already computed attack maps.
+     */
+    template <MoveType TMoveType>
+    static std::vector<Move> generateLegalMoves(const PieceBitBoards& bitBoards,
+                                                const AttackMaps& attackMaps);
+
+private:
+    template <MoveType TMoveType>
+    static std::vector<Move> generateLegalMoves(const PieceBitBoards& bitBoards,
+                                                bool kingIsInCheck);
 };
 
 template <PieceColor TColor>
@@ -76,7 +90,7 @@ private:
     inline static std::vector<Move> generateSlidingPieceMoves(const PieceBitBoards& bitBoards,
                                                               uint16_t origin);
 
-    inline static const std::unique_ptr<magic_bits::Attacks>& getMagicAttacks();
+    inline static const magic_bits::Attacks& getMagicAttacks();
 
     inline static uint64_t generateAttacksOfAllOppositePieces(const PieceBitBoards& bitBoards);
 
@@ -86,18 +100,12 @@ private:
      */
     inline static void appendMoveIfNoCheckHappens(std::vector<Move>& moves, Move move,
                                                   const PieceBitBoards& bitBoards);
-
-private:
-    inline static std::unique_ptr<magic_bits::Attacks> magicAttacks = nullptr;
 };
 
 template <PieceColor TColor>
-const std::unique_ptr<magic_bits::Attacks>& MoveGenerator<TColor>::getMagicAttacks()
+const magic_bits::Attacks& MoveGenerator<TColor>::getMagicAttacks()
 {
-    if (magicAttacks != nullptr)
-        return magicAttacks;
-    magicAttacks = std::make_unique<magic_bits::Attacks>();
-    return magicAttacks;
+    return AttackMaps::getMagicAttacks();
 }
 
 template <PieceColor TColor>
@@ -312,12 +320,11 @@ inline std::vector<Move> MoveGenerator<TColor>::generateSlidingPieceMoves(
 {
     uint64_t attacks = 0;
     if constexpr (TFigure == PieceFigure::Bishop)
-        attacks =
-            getMagicAttacks()->Bishop(bitBoards.getAllPiecesBoard(), static_cast<int>(origin));
+        attacks = getMagicAttacks().Bishop(bitBoards.getAllPiecesBoard(), static_cast<int>(origin));
     else if constexpr (TFigure == PieceFigure::Rook)
-        attacks = getMagicAttacks()->Rook(bitBoards.getAllPiecesBoard(), static_cast<int>(origin));
+        attacks = getMagicAttacks().Rook(bitBoards.getAllPiecesBoard(), static_cast<int>(origin));
     else if constexpr (TFigure == PieceFigure::Queen)
-        attacks = getMagicAttacks()->Queen(bitBoards.getAllPiecesBoard(), static_cast<int>(origin));
+        attacks = getMagicAttacks().Queen(bitBoards.getAllPiecesBoard(), static_cast<int>(origin));
 
     uint64_t maskOfAvailableSquares = 0;
     if constexpr (TMoveType == MoveType::Capture) {
@@ -350,16 +357,16 @@ uint64_t MoveGenerator<TColor>::generateAttacksOfAllOppositePieces(const PieceBi
             attacks |= Knight::originToAttacks[position];
         }
         for (auto position : bitBoards.blackBishopPositions) {
-            attacks |= getMagicAttacks()->Bishop(bitBoards.getAllPiecesBoard(),
-                                                 static_cast<int>(position));
+            attacks |= getMagicAttacks().Bishop(bitBoards.getAllPiecesBoard(),
+                                                static_cast<int>(position));
         }
         for (auto position : bitBoards.blackRookPositions) {
             attacks |=
-                getMagicAttacks()->Rook(bitBoards.getAllPiecesBoard(), static_cast<int>(position));
+                getMagicAttacks().Rook(bitBoards.getAllPiecesBoard(), static_cast<int>(position));
         }
         for (auto position : bitBoards.blackQueenPositions) {
             attacks |=
-                getMagicAttacks()->Queen(bitBoards.getAllPiecesBoard(), static_cast<int>(position));
+                getMagicAttacks().Queen(bitBoards.getAllPiecesBoard(), static_cast<int>(position));
         }
         if (!bitBoards.blackKingPositions.empty())
             attacks |= King::originToAttacks[bitBoards.blackKingPositions[0]];
@@ -372,16 +379,16 @@ uint64_t MoveGenerator<TColor>::generateAttacksOfAllOppositePieces(const PieceBi
             attacks |= Knight::originToAttacks[position];
         }
         for (auto position : bitBoards.whiteBishopPositions) {
-            attacks |= getMagicAttacks()->Bishop(bitBoards.getAllPiecesBoard(),
-                                                 static_cast<int>(position));
+            attacks |= getMagicAttacks().Bishop(bitBoards.getAllPiecesBoard(),
+                                                static_cast<int>(position));
         }
         for (auto position : bitBoards.whiteRookPositions) {
             attacks |=
-                getMagicAttacks()->Rook(bitBoards.getAllPiecesBoard(), static_cast<int>(position));
+                getMagicAttacks().Rook(bitBoards.getAllPiecesBoard(), static_cast<int>(position));
         }
         for (auto position : bitBoards.whiteQueenPositions) {
             attacks |=
-                getMagicAttacks()->Queen(bitBoards.getAllPiecesBoard(), static_cast<int>(position));
+                getMagicAttacks().Queen(bitBoards.getAllPiecesBoard(), static_cast<int>(position));
         }
         if (!bitBoards.whiteKingPositions.empty())
             attacks |= King::originToAttacks[bitBoards.whiteKingPositions[0]];
@@ -414,6 +421,29 @@ void MoveGenerator<TColor>::appendMoveIfNoCheckHappens(std::vector<Move>& moves,
 template <MoveType TMoveType>
 std::vector<Move> MoveGeneratorWrapper::generateLegalMoves(const PieceBitBoards& bitBoards)
 {
+    if (bitBoards.currentMoveColor == PieceColor::White)
+        return generateLegalMoves<TMoveType>(
+            bitBoards, MoveGenerator<PieceColor::White>::isKingInCheck(bitBoards));
+    return generateLegalMoves<TMoveType>(
+        bitBoards, MoveGenerator<PieceColor::Black>::isKingInCheck(bitBoards));
+}
+
+template <MoveType TMoveType>
+std::vector<Move> MoveGeneratorWrapper::generateLegalMoves(const PieceBitBoards& bitBoards,
+                                                           const AttackMaps& attackMaps)
+{
+    if (bitBoards.currentMoveColor == PieceColor::White)
+        return generateLegalMoves<TMoveType>(
+            bitBoards, attackMaps.isKingInCheck<PieceColor::White>(bitBoards));
+    return generateLegalMoves<TMoveType>(bitBoards,
+                                         attackMaps.isKingInCheck<PieceColor::Black>(bitBoards));
+}
+
+template <MoveType TMoveType>
+std::vector<Move> MoveGeneratorWrapper::generateLegalMoves(const PieceBitBoards& bitBoards,
+                                                           bool kingIsInCheck)
+{
+    CHESS_PROFILE_ZONE("generateLegalMoves");
     std::vector<Move> moves;
 
     if (bitBoards.whiteKingPositions.empty() || bitBoards.blackKingPositions.empty()) {
@@ -458,8 +488,7 @@ std::vector<Move> MoveGeneratorWrapper::generateLegalMoves(const PieceBitBoards&
         }
 
         for (auto move : MoveGenerator<PieceColor::White>::generateKingMoves<TMoveType>(
-                 bitBoards, bitBoards.whiteKingPositions[0],
-                 MoveGenerator<PieceColor::White>::isKingInCheck(bitBoards))) {
+                 bitBoards, bitBoards.whiteKingPositions[0], kingIsInCheck)) {
             moves.push_back(std::move(move));
         }
     }
@@ -500,8 +529,7 @@ std::vector<Move> MoveGeneratorWrapper::generateLegalMoves(const PieceBitBoards&
         }
 
         for (auto move : MoveGenerator<PieceColor::Black>::generateKingMoves<TMoveType>(
-                 bitBoards, bitBoards.blackKingPositions[0],
-                 MoveGenerator<PieceColor::Black>::isKingInCheck(bitBoards))) {
+                 bitBoards, bitBoards.blackKingPositions[0], kingIsInCheck)) {
             moves.push_back(std::move(move));
         }
     }
@@ -0,0 +1,199 @@
+#include "Notation.h"
+#include "MoveGenerator.h"
+#include "PieceBitBoards.h"
+
+namespace chessAi
+{
+
+namespace
+{
+
+constexpr std::string_view promotionLetters = "nbrq";
+
+std::optional<uint16_t> promotionFromLetter(char letter)
+{
+    auto index = promotionLetters.find(static_cast<char>(std::tolower(letter)));
+    if (index == std::string_view::npos)
+        return {};
+    return static_cast<uint16_t>(index);
+}
+
+std::optional<PieceFigure> figureFromLetter(char letter)
+{
+    switch (letter) {
+    case 'N':
+        return PieceFigure::Knight;
+    case 'B':
+        return PieceFigure::Bishop;
+    case 'R':
+        return PieceFigure::Rook;
+    case 'Q':
+        return PieceFigure::Queen;
+    case 'K':
+        return PieceFigure::King;
+    default:
+        return {};
+    }
+}
+
+/**
+ * Legal moves of one piece. Parsing generates moves only for pieces which can match the
+ * notation, generating all legal moves would be much slower.
+ */
+std::vector<Move> generatePieceMoves(const PieceBitBoards& bitBoards, PieceFigure figure,
+                                     uint16_t origin)
+{
+    if (bitBoards.currentMoveColor == PieceColor::White)
+        return MoveGenerator<PieceColor::White>::generateLegalMoves<MoveType::Normal>(
+            bitBoards, figure, origin);
+    return MoveGenerator<PieceColor::Black>::generateLegalMoves<MoveType::Normal>(
+        bitBoards, figure, origin);
+}
+
+std::optional<Move> findCastling(bool kingSide, const PieceBitBoards& bitBoards)
+{
+    const auto& kingPositions = (bitBoards.currentMoveColor == PieceColor::White)
+                                    ? bitBoards.whiteKingPositions
+                                    : bitBoards.blackKingPositions;
+    if (kingPositions.empty())
+        return {};
+
+    for (const auto& move : generatePieceMoves(bitBoards, PieceFigure::King, kingPositions[0])) {
+        if (move.specialMoveFlag == 3 && (move.destination % 8 == 6) == kingSide)
+            return move;
+    }
+    return {};
+}
+
+} // namespace
+
+std::optional<uint16_t> Notation::fieldToPosition(std::string_view field)
+{
+    if (field.length() != 2 || field[0] < 'a' || field[0] > 'h' || field[1] < '1' ||
+        field[1] > '8')
+        return {};
+
+    int x = field[0] - 'a';
+    int y = 8 - (field[1] - '0');
+    return static_cast<uint16_t>(x + 8 * y);
+}
+
+std::string Notation::positionToField(unsigned int position)
+{
+    return {static_cast<char>('a' + position % 8), static_cast<char>('8' - position / 8)};
+}
+
+std::optional<Move> Notation::uciToMove(std::string_view notation,
+                                        const PieceBitBoards& bitBoards)
+{
+    if (notation.length() != 4 && notation.length() != 5)
+        return {};
+
+    auto origin = fieldToPosition(notation.substr(0, 2));
+    auto destination = fieldToPosition(notation.substr(2, 2));
+    if (!origin.has_value() || !destination.has_value())
+        return {};
+
+    uint16_t promotion = 3;
+    if (notation.length() == 5) {
+        auto parsed = promotionFromLetter(notation[4]);
+        if (!parsed.has_value())
+            return {};
+        promotion = *parsed;
+    }
+
+    auto piece = bitBoards.getPieceTypeWithSetBitAtPosition(*origin);
+    if (piece.getPieceFigure() == PieceFigure::Empty ||
+        piece.getPieceColor() != bitBoards.currentMoveColor)
+        return {};
+
+    for (const auto& move : generatePieceMoves(bitBoards, piece.getPieceFigure(), *origin)) {
+        if (move.destination != *destination)
+            continue;
+        if (move.specialMoveFlag == 1 && move.promotion != promotion)
+            continue;
+        return move;
+    }
+    return {};
+}
+
+std::string Notation::moveToUci(Move move)
+{
+    auto notation = positionToField(move.origin) + positionToField(move.destination);
+    if (move.specialMoveFlag == 1)
+        notation += promotionLetters[move.promotion];
+    return notation;
+}
+
+std::optional<Move> Notation::sanToMove(std::string_view notation,
+                                        const PieceBitBoards& bitBoards)
+{
+    // Remove check, mate and annotation suffixes.
+    while (!notation.empty() && (notation.back() == '+' || notation.back() == '#' ||
+                                 notation.back() == '!' || notation.back() == '?'))
+        notation.remove_suffix(1);
+
+    if (notation == "O-O" || notation == "0-0")
+        return findCastling(true, bitBoards);
+    if (notation == "O-O-O" || notation == "0-0-0")
+        return findCastling(false, bitBoards);
+
+    std::optional<uint16_t> promotion;
+    auto promotionSign = notation.find('=');
+    if (promotionSign != std::string_view::npos) {
+        if (promotionSign + 1 >= notation.length())
+            return {};
+        promotion = promotionFromLetter(notation[promotionSign + 1]);
+        if (!promotion.has_value())
+            return {};
+        notation = notation.substr(0, promotionSign);
+    }
+
+    auto figure = PieceFigure::Pawn;
+    if (!notation.empty() && figureFromLetter(notation[0]).has_value()) {
+        figure = *figureFromLetter(notation[0]);
+        notation.remove_prefix(1);
+    }
+
+    if (notation.length() < 2)
+        return {};
+    auto destination = fieldToPosition(notation.substr(notation.length() - 2));
+    if (!destination.has_value())
+        return {};
+
+    // Disambiguation by origin file and/or rank, capture sign is ignored.
+    std::optional<unsigned int> originFile;
+    std::optional<unsigned int> originRank;
+    for (char c : notation.substr(0, notation.length() - 2)) {
+        if (c >= 'a' && c <= 'h')
+            originFile = static_cast<unsigned int>(c - 'a');
+        else if (c >= '1' && c <= '8')
+            originRank = static_cast<unsigned int>('8' - c);
+        else if (c != 'x')
+            return {};
+    }
+
+    std::optional<Move> found;
+    auto pieces = bitBoards.getPieceBitBoard(PieceType(bitBoards.currentMoveColor, figure));
+    for (auto origin : PieceBitBoards::getSetBitPositions(pieces)) {
+        if (originFile.has_value() && origin % 8u != *originFile)
+            continue;
+        if (originRank.has_value() && origin / 8u != *originRank)
+            continue;
+
+        for (const auto& move : generatePieceMoves(bitBoards, figure, origin)) {
+            if (move.destination != *destination || move.specialMoveFlag == 3)
+                continue;
+            if (move.specialMoveFlag == 1 && move.promotion != promotion.value_or(3))
+                continue;
+
+            // Ambiguous notation.
+            if (found.has_value())
+                return {};
+            found = move;
+        }
+    }
+    return found;
+}
+
+} // namespace chessAi
@@ -0,0 +1,47 @@
+#pragma once
+
+#include "Move.h"
+
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+
+namespace chessAi
+{
+
+struct PieceBitBoards;
+
+/**
+ * Conversions between moves and text notations (UCI, SAN). Parsed moves are looked up among
+ * the legal moves of the position, so they carry the right flags (castling, en passant,
+ * promotion) and illegal moves are rejected.
+ */
+class Notation
+{
+public:
+    /**
+     * Field in algebraic notation (e4) to board position (a8 = 0).
+     */
+    static std::optional<uint16_t> fieldToPosition(std::string_view field);
+
+    static std::string positionToField(unsigned int position);
+
+    /**
+     * UCI notation: origin, destination and optional promotion (e2e4, e7e8q). Missing promotion
+     * piece means queen.
+     */
+    static std::optional<Move> uciToMove(std::string_view notation,
+                                         const PieceBitBoards& bitBoards);
+
+    static std::string moveToUci(Move move);
+
+    /**
+     * Standard algebraic notation as used in PGN (Nf3, exd5, O-O, e8=Q+, R1a3).
+     * Check, mate and annotation suffixes are ignored.
+     */
+    static std::optional<Move> sanToMove(std::string_view notation,
+                                         const PieceBitBoards& bitBoards);
+};
+
+} // namespace chessAi
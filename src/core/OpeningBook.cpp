@@ -1,8 +1,10 @@
 #include "OpeningBook.h"
+#include "MoveGenerator.h"
+#include "PieceBitBoards.h"
 
 #include <algorithm>
 #include <fstream>
-#include <optional>
+#include <mutex>
 #include <random>
 
 namespace chessAi
@@ -11,166 +13,242 @@ namespace chessAi
 namespace
 {
 
-std::optional<uint16_t> fieldNotationToPosition(const std::string& field)
-{
-    if (field.length() != 2) {
-        CHESS_LOG_ERROR("Book field is not length 2.");
-        return {};
-    }
+constexpr size_t entrySize = 16;
 
-    int x = field[0] - 97;
-    if (x < 0 || x > 7) {
-        CHESS_LOG_ERROR("Book field algebraic notation error: file. {}", field[0]);
-        return {};
-    }
-    if (!std::isdigit(field[1])) {
-        CHESS_LOG_ERROR("Book field algebraic notation error: rank. {}", field[1]);
-        return {};
-    }
+std::mutex s_initMutex;
+std::string s_loadedPath;
 
-    int y = field[1] - '0';
-    y = 8 - y;
-    return static_cast<uint16_t>(x + 8 * y);
+template <typename T>
+void writeBigEndian(char* buffer, T value)
+{
+    for (size_t i = 0; i < sizeof(T); ++i)
+        buffer[i] = static_cast<char>((value >> (8 * (sizeof(T) - 1 - i))) & 0xFF);
 }
 
-Move uciNotationToMove(const std::string& notation)
+template <typename T>
+T readBigEndian(const char* buffer)
 {
-    auto origin = fieldNotationToPosition(notation.substr(0, 2));
-    if (!origin.has_value()) {
-        CHESS_LOG_ERROR("Book parsing error, move doesn't have an origin.");
-        return Move(0, 0, 0, 0);
-    }
-    auto destination = fieldNotationToPosition(notation.substr(2, 2));
-    if (!destination.has_value()) {
-        CHESS_LOG_ERROR("Book parsing error, move doesn't have an origin.");
-        return Move(0, 0, 0, 0);
-    }
+    T value = 0;
+    for (size_t i = 0; i < sizeof(T); ++i)
+        value = static_cast<T>((value << 8) | static_cast<unsigned char>(buffer[i]));
+    return value;
+}
 
-    return Move(*origin, *destination, 0, 0);
+/**
+ * Polyglot squares start at a1 and go by ranks, engine positions start at a8.
+ */
+uint16_t toPolyglotSquare(unsigned int position)
+{
+    auto file = position % 8;
+    auto row = 7 - position / 8;
+    return static_cast<uint16_t>(row * 8 + file);
 }
 
-std::vector<std::string> splitString(const std::string& input, char delimiter)
+std::mt19937& getRandomGenerator()
 {
-    std::vector<std::string> tokens;
-    size_t start = 0;
-    size_t end = input.find(delimiter);
+    thread_local std::mt19937 generator(std::random_device{}());
+    return generator;
+}
 
-    while (end != std::string::npos) {
-        tokens.push_back(input.substr(start, end - start));
-        start = end + 1;
-        end = input.find(delimiter, start);
-    }
+bool compareEntries(const BookEntry& a, const BookEntry& b)
+{
+    if (a.key != b.key)
+        return a.key < b.key;
+    if (a.weight != b.weight)
+        return a.weight > b.weight;
+    return a.move < b.move;
+}
 
-    tokens.push_back(input.substr(start, end));
+} // namespace
 
-    return tokens;
+uint32_t BookEntry::getDraws() const
+{
+    auto decided = getWins() + getLosses();
+    return (weight > decided) ? weight - decided : 0;
 }
 
-auto findMoveEntry(const std::vector<std::unique_ptr<BookEntry>>& nextMoves, Move move)
+void BookEntry::setResults(uint32_t wins, uint32_t losses)
 {
-    for (auto it = nextMoves.begin(); it != nextMoves.end(); it++) {
-        if (*it == nullptr)
-            continue;
-        // We use special move compare as we only care about origin and destination.
-        SpecialMoveCompare compare(move);
-        if (compare((*it)->move)) {
-            return it;
-        }
-    }
-    return nextMoves.end();
+    learn = (std::min<uint32_t>(wins, UINT16_MAX) << 16) | std::min<uint32_t>(losses, UINT16_MAX);
 }
 
-void storeEntries(const std::vector<Move>& moves, BookEntry& entry, unsigned int halfMoveCount)
+double BookEntry::getScore() const
 {
-    if (moves.size() < halfMoveCount || halfMoveCount < 1)
-        return;
+    auto points = static_cast<double>(getWins()) + 0.5 * static_cast<double>(getDraws()) + 1.0;
+    auto games = static_cast<double>(getWins() + getLosses() + getDraws()) + 2.0;
+    return points / games;
+}
+
+bool OpeningBook::Init(const std::string& path)
+{
+    std::lock_guard<std::mutex> lock(s_initMutex);
+    if (std::atomic_load(&s_book) != nullptr && s_loadedPath == path)
+        return true;
 
-    // Find the move in next moves or store it.
-    auto nextMovesEntry = findMoveEntry(entry.nextMoves, moves[halfMoveCount - 1]);
-    if (nextMovesEntry == entry.nextMoves.end()) {
-        std::unique_ptr<BookEntry>& inserted =
-            entry.nextMoves.emplace_back(std::make_unique<BookEntry>(moves[halfMoveCount - 1]));
-        storeEntries(moves, *inserted, halfMoveCount + 1);
+    auto book = std::make_shared<MappedFile>(path);
+    if (!book->isOpen())
+        return false;
+    if (book->size() % entrySize != 0) {
+        CHESS_LOG_ERROR("Book {} size is not a multiple of entry size.", path);
+        return false;
     }
-    else
-        storeEntries(moves, **nextMovesEntry, halfMoveCount + 1);
+
+    auto entries = book->size() / entrySize;
+    std::atomic_store(&s_book, std::shared_ptr<const MappedFile>(std::move(book)));
+    s_loadedPath = path;
+    CHESS_LOG_INFO("Opening book {} mapped with {} entries.", path, entries);
+    return true;
 }
 
-} // namespace
+size_t OpeningBook::getNumberOfEntries()
+{
+    auto book = std::atomic_load(&s_book);
+    return (book != nullptr) ? book->size() / entrySize : 0;
+}
 
-bool OpeningBook::Init()
+BookEntry OpeningBook::readEntry(const MappedFile& book, size_t index)
 {
-    try {
-        std::ifstream file("book/book.csv");
+    const char* data = book.data() + index * entrySize;
+
+    BookEntry entry;
+    entry.key = readBigEndian<uint64_t>(data);
+    entry.move = readBigEndian<uint16_t>(data + 8);
+    entry.weight = readBigEndian<uint16_t>(data + 10);
+    entry.learn = readBigEndian<uint32_t>(data + 12);
+    return entry;
+}
 
-        if (!file.is_open()) {
-            CHESS_LOG_ERROR("Couldn't open book/book.csv.");
-            return false;
+uint64_t OpeningBook::readKey(const MappedFile& book, size_t index)
+{
+    return readBigEndian<uint64_t>(book.data() + index * entrySize);
+}
+
+std::vector<BookEntry> OpeningBook::getEntries(uint64_t key)
+{
+    // Keeps the book mapped until the search is done, even if Init replaces it meanwhile.
+    auto book = std::atomic_load(&s_book);
+    if (book == nullptr)
+        return {};
+
+    // Binary search for the first entry with the key.
+    size_t first = 0;
+    auto numberOfEntries = book->size() / entrySize;
+    size_t count = numberOfEntries;
+    while (count > 0) {
+        size_t step = count / 2;
+        if (readKey(*book, first + step) < key) {
+            first += step + 1;
+            count -= step + 1;
         }
+        else
+            count = step;
+    }
 
-        s_book = std::make_unique<BookEntry>();
-        s_book->move = Move(0, 0, 0, 0);
+    std::vector<BookEntry> entries;
+    for (size_t i = first; i < numberOfEntries && readKey(*book, i) == key; ++i)
+        entries.push_back(readEntry(*book, i));
+    return entries;
+}
 
-        std::string line;
-        while (std::getline(file, line)) {
+std::optional<Move> OpeningBook::getBookMove(const PieceBitBoards& bitBoards, BookPolicy policy)
+{
+    auto entries = getEntries(bitBoards.zobristKey);
+    if (entries.empty())
+        return {};
 
-            std::vector<Move> moves;
-            auto movesNotation = splitString(line, ',');
-            moves.reserve(movesNotation.size());
-            std::transform(movesNotation.begin(), movesNotation.end(), std::back_inserter(moves),
-                           uciNotationToMove);
+    auto move = decodeMove(selectEntry(entries, policy).move, bitBoards);
+    if (!move.has_value())
+        CHESS_LOG_WARN("Book move is not legal.");
+    return move;
+}
 
-            storeEntries(moves, *s_book, 1);
+const BookEntry& OpeningBook::selectEntry(const std::vector<BookEntry>& entries,
+                                          BookPolicy policy)
+{
+    switch (policy) {
+    case BookPolicy::Uniform: {
+        std::uniform_int_distribution<size_t> distribution(0, entries.size() - 1);
+        return entries[distribution(getRandomGenerator())];
+    }
+    case BookPolicy::WeightedRandom: {
+        uint64_t totalWeight = 0;
+        for (const auto& entry : entries)
+            totalWeight += entry.weight;
+        if (totalWeight == 0)
+            return selectEntry(entries, BookPolicy::Uniform);
+
+        std::uniform_int_distribution<uint64_t> distribution(0, totalWeight - 1);
+        auto value = distribution(getRandomGenerator());
+        for (const auto& entry : entries) {
+            if (value < entry.weight)
+                return entry;
+            value -= entry.weight;
         }
-        file.close();
-        return true;
+        return entries.back();
     }
-    catch (const std::exception& ex) {
-        CHESS_LOG_ERROR("When initializing book moves ex: {}", ex.what());
-        s_book = nullptr;
-        return false;
+    case BookPolicy::MostPlayed:
+        return *std::max_element(entries.begin(), entries.end(),
+                                 [](const BookEntry& a, const BookEntry& b) {
+                                     return a.weight < b.weight;
+                                 });
+    case BookPolicy::BestScore:
+        return *std::max_element(entries.begin(), entries.end(),
+                                 [](const BookEntry& a, const BookEntry& b) {
+                                     if (a.getScore() != b.getScore())
+                                         return a.getScore() < b.getScore();
+                                     return a.weight < b.weight;
+                                 });
     }
+    return entries.front();
 }
 
-namespace
+void OpeningBook::setSeed(uint32_t seed)
 {
+    getRandomGenerator().seed(seed);
+}
 
-Move traverseBookTree(const std::vector<Move>& movesHistory, const BookEntry& entry,
-                      unsigned int halfMoveCount)
+bool OpeningBook::writeBook(const std::string& path, std::vector<BookEntry> entries)
 {
-    if (halfMoveCount < 1) {
-        CHESS_LOG_ERROR("Book half move count smaller then 1.");
-        return Move(0, 0, 0, 0);
-    }
+    std::sort(entries.begin(), entries.end(), compareEntries);
 
-    // If next move exists, return random one.
-    if (movesHistory.size() == halfMoveCount - 1) {
-        if (entry.nextMoves.empty())
-            return Move(0, 0, 0, 0);
-
-        std::mt19937 gen(std::random_device{}());
-        std::uniform_int_distribution<size_t> dist(0, entry.nextMoves.size() - 1);
-        return entry.nextMoves.at(dist(gen))->move;
+    std::ofstream file(path, std::ios::binary);
+    if (!file.is_open()) {
+        CHESS_LOG_ERROR("Couldn't open {} for writing.", path);
+        return false;
     }
 
-    auto nextMovesEntry = findMoveEntry(entry.nextMoves, movesHistory[halfMoveCount - 1]);
-    if (nextMovesEntry == entry.nextMoves.end())
-        return Move(0, 0, 0, 0);
-    else
-        return traverseBookTree(movesHistory, **nextMovesEntry, halfMoveCount + 1);
+    char buffer[entrySize];
+    for (const auto& entry : entries) {
+        writeBigEndian(buffer, entry.key);
+        writeBigEndian(buffer + 8, entry.move);
+        writeBigEndian(buffer + 10, entry.weight);
+        writeBigEndian(buffer + 12, entry.learn);
+        file.write(buffer, entrySize);
+    }
+    return static_cast<bool>(file);
 }
 
-} // namespace
-
-std::optional<Move> OpeningBook::getBookMove(const std::vector<Move>& movesHistory)
+uint16_t OpeningBook::encodeMove(Move move)
 {
-    if (s_book == nullptr)
-        return {};
+    unsigned int destination = move.destination;
+    // Castling is encoded as king takes rook.
+    if (move.specialMoveFlag == 3)
+        destination = (destination % 8 == 6) ? destination + 1 : destination - 2;
+
+    uint16_t promotion =
+        (move.specialMoveFlag == 1) ? static_cast<uint16_t>(move.promotion + 1) : 0;
+    return static_cast<uint16_t>(toPolyglotSquare(destination) |
+                                 (toPolyglotSquare(move.origin) << 6) | (promotion << 12));
+}
 
-    auto move = traverseBookTree(movesHistory, *s_book, 1);
-    if (move == Move(0, 0, 0, 0))
-        return {};
-    return move;
+std::optional<Move> OpeningBook::decodeMove(uint16_t move, const PieceBitBoards& bitBoards)
+{
+    for (const auto& legalMove :
+         MoveGeneratorWrapper::generateLegalMoves<MoveType::Normal>(bitBoards)) {
+        if (encodeMove(legalMove) == move)
+            return legalMove;
+    }
+    return {};
 }
 
-} // namespace chessAi
\ No newline at end of file
+} // namespace chessAi
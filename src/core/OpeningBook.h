@@ -1,50 +1,147 @@
 #pragma once
 
+#include "MappedFile.h"
 #include "Move.h"
 
+#include <cstdint>
 #include <memory>
 #include <optional>
+#include <string>
+#include <vector>
 
 namespace chessAi
 {
 
+struct PieceBitBoards;
+
+/**
+ * One move playable in a position. Same 16 byte layout as Polyglot book entries: stored big
+ * endian, move encoded as in Polyglot (castling as king takes own rook). Key is the engine's
+ * zobrist key (ZobristHash), not the Polyglot one.
+ */
 struct BookEntry
 {
-    BookEntry() : move(0, 0, 0, 0), nextMoves() {}
-    BookEntry(Move move) : move(move), nextMoves() {}
+    uint64_t key = 0;
+    uint16_t move = 0;
+    /**
+     * Relative weight of the move in the position, number of games it was played in. Positions
+     * with more games are scaled, so their most played move has UINT16_MAX.
+     */
+    uint16_t weight = 0;
+    /**
+     * Results of the games, from the view of the side playing the move: wins in the upper and
+     * losses in the lower 16 bits. Remaining games (weight - wins - losses) were drawn or have
+     * unknown result.
+     */
+    uint32_t learn = 0;
+
+    uint32_t getWins() const { return learn >> 16; }
+    uint32_t getLosses() const { return learn & 0xFFFF; }
+    uint32_t getDraws() const;
+
+    void setResults(uint32_t wins, uint32_t losses);
 
-    Move move;
-    std::vector<std::unique_ptr<BookEntry>> nextMoves;
+    /**
+     * Expected score of the move between 0 and 1. One win and one loss are added to the results,
+     * so moves played in few games are not scored at the extremes.
+     */
+    double getScore() const;
+};
+
+/**
+ * How to choose between the book moves of a position.
+ */
+enum class BookPolicy
+{
+    /**
+     * Random move, chance proportional to the number of games it was played in.
+     */
+    WeightedRandom,
+    /**
+     * Random move, all moves with the same chance.
+     */
+    Uniform,
+    /**
+     * Move played in most games.
+     */
+    MostPlayed,
+    /**
+     * Move with the best score (see BookEntry::getScore), most played if scores are equal.
+     */
+    BestScore
 };
 
 /**
- * Get best move from book. Parse csv file to tree structure.
- * CSV file was made from parsing PGN files.
- * Promotions are not handled!
+ * Opening book keyed by position, so moves are found after transpositions too.
+ * Entries are sorted by key (and weight descending for the same key). Moves of a position are
+ * found with binary search.
+ *
+ * Book file is memory mapped and searched in place, nothing is parsed or copied when loading, so
+ * loading is instant even for books with millions of positions.
  *
- * TODO: Currently can just follow one line, cannot transpose to another.
- * Maybe refactor to store all possible moves in a postion. Use JSON.
+ * Books are built from PGN files with tools/pgnBookBuilder or from CSV files of games in UCI
+ * notation with tools/bookConverter.
  */
 class OpeningBook
 {
 public:
     /**
-     * Parses book.csv.
+     * Maps binary book. Mapping is kept when called again with the same path. Safe to call while
+     * other threads read the book, they finish with the book mapped before.
      *
      * @return true If successful.
      */
-    static bool Init();
+    static bool Init(const std::string& path = "book/book.bin");
+
+    /**
+     * Get book move for the position. If more are available, one is chosen by the policy.
+     * Returned move is the generated legal move (flags set).
+     */
+    static std::optional<Move> getBookMove(const PieceBitBoards& bitBoards,
+                                           BookPolicy policy = BookPolicy::WeightedRandom);
 
     /**
-     * Get best move for current line. If more are available, random one is chosen.
+     * Choose entry by the policy.
      *
-     * @param movesHistory Previous moves line.
+     * @param entries Must not be empty.
+     */
+    static const BookEntry& selectEntry(const std::vector<BookEntry>& entries, BookPolicy policy);
+
+    /**
+     * Seeds random generator of the calling thread, used by random policies. Each thread is
+     * seeded randomly otherwise.
+     */
+    static void setSeed(uint32_t seed);
+
+    /**
+     * All entries of the position.
      */
-    static std::optional<Move> getBookMove(const std::vector<Move>& movesHistory);
+    static std::vector<BookEntry> getEntries(uint64_t key);
+
+    /**
+     * Sorts entries and writes them in binary format.
+     *
+     * @return true If successful.
+     */
+    static bool writeBook(const std::string& path, std::vector<BookEntry> entries);
+
+    static size_t getNumberOfEntries();
+
+    static uint16_t encodeMove(Move move);
+
+    /**
+     * Find legal move in position with the encoding.
+     */
+    static std::optional<Move> decodeMove(uint16_t move, const PieceBitBoards& bitBoards);
+
+private:
+    static BookEntry readEntry(const MappedFile& book, size_t index);
+    static uint64_t readKey(const MappedFile& book, size_t index);
 
 private:
-    // Tree structure of moves. First move is null move and store all first moves (next moves).
-    inline static std::unique_ptr<BookEntry> s_book = nullptr;
+    // Immutable once published, Init replaces it while other threads may still read the old
+    // mapping. Accessed with std::atomic_load and std::atomic_store only.
+    inline static std::shared_ptr<const MappedFile> s_book;
 };
 
-} // namespace chessAi
\ No newline at end of file
+} // namespace chessAi
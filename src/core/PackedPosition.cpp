@@ -0,0 +1,118 @@
+#include "PackedPosition.h"
+#include "PieceBitBoards.h"
+
+#include <algorithm>
+
+namespace chessAi
+{
+
+namespace
+{
+
+constexpr unsigned int maxPieces = 32;
+constexpr unsigned int numberOfPieceTypes = 12;
+
+} // namespace
+
+std::optional<PackedPosition> PackedPosition::pack(const PieceBitBoards& bitBoards)
+{
+    PackedPosition packed;
+    packed.occupancy = bitBoards.getAllPiecesBoard();
+    if (PieceBitBoards::countSetBits(packed.occupancy) > maxPieces)
+        return {};
+
+    // Piece code of every square, then codes are written in order of occupied squares.
+    std::array<uint8_t, 64> codes{};
+    auto pieceBitBoards = bitBoards.getBitBoardsByPieceIndex();
+    for (uint8_t code = 0; code < numberOfPieceTypes; ++code) {
+        for (auto bitBoard = pieceBitBoards[code]; bitBoard; bitBoard &= bitBoard - 1)
+            codes[PieceBitBoards::getLeastSignificantSetBit(bitBoard)] = code;
+    }
+
+    unsigned int index = 0;
+    for (auto remaining = packed.occupancy; remaining; remaining &= remaining - 1, ++index) {
+        auto code = codes[PieceBitBoards::getLeastSignificantSetBit(remaining)];
+        packed.pieces[index / 2] |= static_cast<uint8_t>(code << (4 * (index % 2)));
+    }
+
+    if (bitBoards.currentMoveColor == PieceColor::Black)
+        packed.state |= 1;
+    if (bitBoards.whiteKingSideCastle)
+        packed.state |= 1 << 1;
+    if (bitBoards.whiteQueenSideCastle)
+        packed.state |= 1 << 2;
+    if (bitBoards.blackKingSideCastle)
+        packed.state |= 1 << 3;
+    if (bitBoards.blackQueenSideCastle)
+        packed.state |= 1 << 4;
+
+    packed.enPassantTargetSquare = static_cast<uint8_t>(bitBoards.enPassantTargetSquare);
+    packed.halfMoveCount =
+        static_cast<uint16_t>(std::min<unsigned int>(bitBoards.halfMoveCount, UINT16_MAX));
+    return packed;
+}
+
+bool PackedPosition::unpack(PieceBitBoards& bitBoards) const
+{
+    if (PieceBitBoards::countSetBits(occupancy) > maxPieces || enPassantTargetSquare >= 64)
+        return false;
+
+    std::array<uint64_t, numberOfPieceTypes> pieceBitBoards{};
+    unsigned int index = 0;
+    for (auto remaining = occupancy; remaining; remaining &= remaining - 1, ++index) {
+        auto code = static_cast<unsigned int>(pieces[index / 2] >> (4 * (index % 2))) & 0xFu;
+        if (code >= numberOfPieceTypes)
+            return false;
+        pieceBitBoards[code] |= 1ULL << PieceBitBoards::getLeastSignificantSetBit(remaining);
+    }
+
+    // Engine expects exactly one king of each color.
+    auto whiteKing = PieceType(PieceColor::White, PieceFigure::King).getPieceIndex();
+    auto blackKing = PieceType(PieceColor::Black, PieceFigure::King).getPieceIndex();
+    if (PieceBitBoards::countSetBits(pieceBitBoards[whiteKing]) != 1 ||
+        PieceBitBoards::countSetBits(pieceBitBoards[blackKing]) != 1)
+        return false;
+
+    bitBoards.setBitBoardsByPieceIndex(pieceBitBoards);
+
+    bitBoards.currentMoveColor = (state & 1) ? PieceColor::Black : PieceColor::White;
+    bitBoards.whiteKingSideCastle = state & (1 << 1);
+    bitBoards.whiteQueenSideCastle = state & (1 << 2);
+    bitBoards.blackKingSideCastle = state & (1 << 3);
+    bitBoards.blackQueenSideCastle = state & (1 << 4);
+    bitBoards.enPassantTargetSquare = enPassantTargetSquare;
+    bitBoards.halfMoveCount = halfMoveCount;
+
+    bitBoards.updatePiecePositions();
+    return true;
+}
+
+size_t PackedPosition::packBatch(const PieceBitBoards* bitBoards, size_t count,
+                                 PackedPosition* packed)
+{
+    for (size_t i = 0; i < count; ++i) {
+        auto position = pack(bitBoards[i]);
+        if (!position.has_value())
+            return i;
+        packed[i] = *position;
+    }
+    return count;
+}
+
+size_t PackedPosition::unpackBatch(const PackedPosition* packed, size_t count,
+                                   std::vector<PieceBitBoards>& bitBoards)
+{
+    // Copying one board is much cheaper than constructing each from the starting FEN.
+    if (bitBoards.size() < count)
+        bitBoards.resize(count, bitBoards.empty() ? PieceBitBoards() : bitBoards.front());
+    else
+        bitBoards.erase(bitBoards.begin() + static_cast<std::ptrdiff_t>(count), bitBoards.end());
+
+    for (size_t i = 0; i < count; ++i) {
+        if (!packed[i].unpack(bitBoards[i]))
+            return i;
+    }
+    return count;
+}
+
+} // namespace chessAi
@@ -0,0 +1,78 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <vector>
+
+namespace chessAi
+{
+
+struct PieceBitBoards;
+
+/**
+ * Position packed in 32 bytes, for training data, position caches and passing positions between
+ * processes without FEN strings.
+ *
+ * Occupancy bit board (position order as in PieceBitBoards) is followed by one 4 bit piece code per
+ * occupied square, in order of the squares (low nibble first). Piece code is
+ * PieceType::getPieceIndex. At most 32 pieces fit, which holds for every legal position.
+ *
+ * Struct is stored as is (host byte order, little endian on supported platforms), so files of
+ * packed positions can be memory mapped and read in place.
+ */
+struct PackedPosition
+{
+    uint64_t occupancy = 0;
+    std::array<uint8_t, 16> pieces{};
+    /**
+     * Bit 0 set if black is to move, bits 1-4 castling rights in order white king side, white
+     * queen side, black king side, black queen side.
+     */
+    uint8_t state = 0;
+    /**
+     * As PieceBitBoards::enPassantTargetSquare, 0 if none.
+     */
+    uint8_t enPassantTargetSquare = 0;
+    uint16_t halfMoveCount = 0;
+    /**
+     * Not part of the position, free for users of the format. Training data stores search score
+     * (from the view of the side to move) and game result.
+     */
+    int16_t score = 0;
+    uint8_t result = 0;
+    uint8_t reserved = 0;
+
+    /**
+     * @return Empty optional if the position has more than 32 pieces.
+     */
+    static std::optional<PackedPosition> pack(const PieceBitBoards& bitBoards);
+
+    /**
+     * Writes position to bit boards, reusing their memory, so unpacking many positions into the
+     * same bit boards does not allocate.
+     *
+     * @return false If packed position is not valid. Bit boards are left unchanged.
+     */
+    bool unpack(PieceBitBoards& bitBoards) const;
+
+    /**
+     * @return Number of positions packed. Packing stops at the first one which can not be packed.
+     */
+    static size_t packBatch(const PieceBitBoards* bitBoards, size_t count,
+                            PackedPosition* packed);
+
+    /**
+     * Unpacks positions into bitBoards, resizing it to count. Bit boards already in the vector are
+     * reused.
+     *
+     * @return Number of positions unpacked. Unpacking stops at the first invalid position.
+     */
+    static size_t unpackBatch(const PackedPosition* packed, size_t count,
+                              std::vector<PieceBitBoards>& bitBoards);
+};
+
+static_assert(sizeof(PackedPosition) == 32, "Packed position must have 32 bytes.");
+
+} // namespace chessAi
@@ -1,245 +1,53 @@
 #include "PieceBitBoards.h"
+#include "Fen.h"
 #include "ZobristHash.h"
 
 namespace chessAi
 {
 
-namespace
-{
-
-std::vector<std::string> splitString(const std::string& input, char delimiter)
-{
-    std::vector<std::string> tokens;
-    size_t start = 0;
-    size_t end = input.find(delimiter);
-
-    while (end != std::string::npos) {
-        tokens.push_back(input.substr(start, end - start));
-        start = end + 1;
-        end = input.find(delimiter, start);
-    }
-
-    tokens.push_back(input.substr(start, end));
-
-    return tokens;
-}
-
-} // namespace
-
 PieceBitBoards::PieceBitBoards(const std::string& fen)
 {
-    auto tokens = splitString(fen, ' ');
-
-    if (tokens.size() != 6 || !parsePosition(tokens[0]) || !parseActiveColor(tokens[1]) ||
-        !parseCastlingRights(tokens[2]) || !parseEnPassant(tokens[3])) {
-
-        CHESS_LOG_ERROR("Fen string must have 6 parts separated by spaces.");
-
-        // Default starting position.
-        whitePawns = 0xFF000000000000ULL;
-        whiteBishops = 0x2400000000000000ULL;
-        whiteKnights = 0x4200000000000000ULL;
-        whiteRooks = 0x8100000000000000ULL;
-        whiteQueens = 0x800000000000000ULL;
-        whiteKing = 0x1000000000000000ULL;
-        blackPawns = 0xff00ULL;
-        blackBishops = 0x24ULL;
-        blackKnights = 0x42ULL;
-        blackRooks = 0x81ULL;
-        blackQueens = 0x8ULL;
-        blackKing = 0x10ULL;
+    if (!Fen::parse(fen, *this)) {
+        CHESS_LOG_ERROR("Invalid fen string: {}", fen);
+        Fen::parse(Fen::startingPosition, *this);
     }
 
-    whitePawnPositions = PieceBitBoards::getSetBitPositions(whitePawns);
-    whiteBishopPositions = PieceBitBoards::getSetBitPositions(whiteBishops);
-    whiteKnightPositions = PieceBitBoards::getSetBitPositions(whiteKnights);
-    whiteRookPositions = PieceBitBoards::getSetBitPositions(whiteRooks);
-    whiteQueenPositions = PieceBitBoards::getSetBitPositions(whiteQueens);
-
-    whiteKingPositions = PieceBitBoards::getSetBitPositions(whiteKing);
     if (whiteKingPositions.size() != 1) {
         CHESS_LOG_ERROR("White king positions are not size 1.");
         if (whiteKingPositions.empty())
             whiteKingPositions = {60};
     }
-
-    blackPawnPositions = PieceBitBoards::getSetBitPositions(blackPawns);
-    blackBishopPositions = PieceBitBoards::getSetBitPositions(blackBishops);
-    blackKnightPositions = PieceBitBoards::getSetBitPositions(blackKnights);
-    blackRookPositions = PieceBitBoards::getSetBitPositions(blackRooks);
-    blackQueenPositions = PieceBitBoards::getSetBitPositions(blackQueens);
-
-    blackKingPositions = PieceBitBoards::getSetBitPositions(blackKing);
     if (blackKingPositions.size() != 1) {
         CHESS_LOG_ERROR("Black king positions are not size 1.");
-        if (whiteKingPositions.empty())
-            whiteKingPositions = {4};
-    }
-
-    zobristKey = ZobristHash::calculateZobristKey(*this);
-}
-
-bool PieceBitBoards::parsePosition(const std::string& position)
-{
-    auto rows = splitString(position, '/');
-
-    if (rows.size() != 8) {
-        CHESS_LOG_ERROR("Position part of fen must have 8 parts separate by /.");
-        return false;
-    }
-
-    uint8_t rowIndex = 0;
-    for (const auto& row : rows) {
-        if (!parseRow(row, rowIndex))
-            return false;
-        rowIndex++;
-    }
-    return true;
-}
-
-bool PieceBitBoards::parseRow(const std::string& row, uint8_t rowIndex)
-{
-    uint8_t columnIndex = 0;
-
-    for (unsigned char ch : row) {
-        if (std::isdigit(ch)) {
-            uint8_t number = ch - '0';
-            if (number < 1 || number > 8) {
-                CHESS_LOG_ERROR("Fen number for piece placement must be between 0-8.");
-                return false;
-            }
-            columnIndex += number;
-        }
-        else {
-            switch (ch) {
-            case 'P':
-                PieceBitBoards::setBit(whitePawns,
-                                       static_cast<uint16_t>(rowIndex * 8 + columnIndex));
-                break;
-            case 'N':
-                PieceBitBoards::setBit(whiteKnights,
-                                       static_cast<uint16_t>(rowIndex * 8 + columnIndex));
-                break;
-            case 'B':
-                PieceBitBoards::setBit(whiteBishops,
-                                       static_cast<uint16_t>(rowIndex * 8 + columnIndex));
-                break;
-            case 'R':
-                PieceBitBoards::setBit(whiteRooks,
-                                       static_cast<uint16_t>(rowIndex * 8 + columnIndex));
-                break;
-            case 'Q':
-                PieceBitBoards::setBit(whiteQueens,
-                                       static_cast<uint16_t>(rowIndex * 8 + columnIndex));
-                break;
-            case 'K':
-                PieceBitBoards::setBit(whiteKing,
-                                       static_cast<uint16_t>(rowIndex * 8 + columnIndex));
-                break;
-            case 'p':
-                PieceBitBoards::setBit(blackPawns,
-                                       static_cast<uint16_t>(rowIndex * 8 + columnIndex));
-                break;
-            case 'n':
-                PieceBitBoards::setBit(blackKnights,
-                                       static_cast<uint16_t>(rowIndex * 8 + columnIndex));
-                break;
-            case 'b':
-                PieceBitBoards::setBit(blackBishops,
-                                       static_cast<uint16_t>(rowIndex * 8 + columnIndex));
-                break;
-            case 'r':
-                PieceBitBoards::setBit(blackRooks,
-                                       static_cast<uint16_t>(rowIndex * 8 + columnIndex));
-                break;
-            case 'q':
-                PieceBitBoards::setBit(blackQueens,
-                                       static_cast<uint16_t>(rowIndex * 8 + columnIndex));
-                break;
-            case 'k':
-                PieceBitBoards::setBit(blackKing,
-                                       static_cast<uint16_t>(rowIndex * 8 + columnIndex));
-                break;
-            default:
-                CHESS_LOG_ERROR("Fen piece placement character is illegal.");
-                return false;
-            }
-            columnIndex++;
-        }
+        if (blackKingPositions.empty())
+            blackKingPositions = {4};
     }
-    return true;
 }
 
-bool PieceBitBoards::parseActiveColor(const std::string& activeColor)
+void PieceBitBoards::updatePiecePositions()
 {
-    if (activeColor == "w")
-        currentMoveColor = PieceColor::White;
-    else if (activeColor == "b")
-        currentMoveColor = PieceColor::Black;
-    else {
-        CHESS_LOG_ERROR("Wrong format of fen active color.");
-        return false;
-    }
-    return true;
-}
-
-bool PieceBitBoards::parseCastlingRights(const std::string& castlingRights)
-{
-    whiteKingSideCastle = false;
-    whiteQueenSideCastle = false;
-    blackKingSideCastle = false;
-    blackQueenSideCastle = false;
-
-    if (castlingRights == "-")
-        return true;
-
-    for (char ch : castlingRights) {
-        if (ch == 'K')
-            whiteKingSideCastle = true;
-        else if (ch == 'Q')
-            whiteQueenSideCastle = true;
-        else if (ch == 'k')
-            blackKingSideCastle = true;
-        else if (ch == 'q')
-            blackQueenSideCastle = true;
-        else {
-            CHESS_LOG_ERROR("Fen, wrong castling rights format.");
-            return false;
+    auto setPositions = [](std::vector<uint16_t>& positions, uint64_t bitBoard) {
+        positions.clear();
+        while (bitBoard) {
+            positions.push_back(getLeastSignificantSetBit(bitBoard));
+            bitBoard &= bitBoard - 1;
         }
-    }
-    return true;
-}
-
-bool PieceBitBoards::parseEnPassant(const std::string& enPassant)
-{
-    if (enPassant == "-")
-        return true;
+    };
+
+    setPositions(whitePawnPositions, whitePawns);
+    setPositions(whiteBishopPositions, whiteBishops);
+    setPositions(whiteKnightPositions, whiteKnights);
+    setPositions(whiteRookPositions, whiteRooks);
+    setPositions(whiteQueenPositions, whiteQueens);
+    setPositions(whiteKingPositions, whiteKing);
+    setPositions(blackPawnPositions, blackPawns);
+    setPositions(blackBishopPositions, blackBishops);
+    setPositions(blackKnightPositions, blackKnights);
+    setPositions(blackRookPositions, blackRooks);
+    setPositions(blackQueenPositions, blackQueens);
+    setPositions(blackKingPositions, blackKing);
 
-    if (enPassant.length() != 2) {
-        CHESS_LOG_ERROR("Fen: en passant algebraic notation error.");
-        return false;
-    }
-
-    int x = enPassant[0] - 97;
-    if (x < 0 || x > 7) {
-        CHESS_LOG_ERROR("Fen: en passant algebraic notation error: file.");
-        return false;
-    }
-    if (!std::isdigit(enPassant[1])) {
-        CHESS_LOG_ERROR("Fen: en passant algebraic notation error: rank.");
-        return false;
-    }
-
-    int y = enPassant[1] - '0';
-    y = 8 - y;
-    if (y == 2 || y == 5) {
-        enPassantTargetSquare = static_cast<uint16_t>(x + 8 * y);
-    }
-    else {
-        CHESS_LOG_ERROR("Fen: en passant algebraic notation error: rank.");
-        return false;
-    }
-    return true;
+    zobristKey = ZobristHash::calculateZobristKey(*this);
 }
 
 std::string PieceBitBoards::getBitBoardString(const uint64_t& bitBoard)
@@ -4,10 +4,15 @@
 #include "PieceType.h"
 #include "logger/Logger.h"
 
+#include <array>
 #include <map>
 #include <set>
 #include <string>
 
+#if defined(_MSC_VER)
+    #include <intrin.h>
+#endif
+
 namespace chessAi
 {
 
@@ -70,8 +75,25 @@ public:
      */
     void applyMove(Move move);
 
+    /**
+     * Recalculates piece position vectors and zobrist key from bit boards, after bit boards were
+     * set directly. Reuses capacity of the vectors.
+     */
+    void updatePiecePositions();
+
     inline std::map<PieceType, const uint64_t*> getTypeToPieceBitBoards() const;
 
+    /**
+     * Bit boards in order of PieceType::getPieceIndex. Much faster to iterate than
+     * getTypeToPieceBitBoards.
+     */
+    inline std::array<uint64_t, 12> getBitBoardsByPieceIndex() const;
+
+    /**
+     * Sets bit boards in order of PieceType::getPieceIndex. Call updatePiecePositions after.
+     */
+    inline void setBitBoardsByPieceIndex(const std::array<uint64_t, 12>& bitBoards);
+
     inline static void setBit(uint64_t& number, uint16_t index);
 
     inline static bool getBit(uint64_t number, uint16_t index);
@@ -82,6 +104,11 @@ public:
 
     inline static uint16_t countSetBits(uint64_t number);
 
+    /**
+     * @param number Must not be 0.
+     */
+    inline static uint16_t getLeastSignificantSetBit(uint64_t number);
+
     inline uint64_t getAllPiecesBoard() const;
 
     template <PieceColor TColor>
@@ -110,12 +137,6 @@ private:
                                                                    PieceColor color);
     std::vector<uint16_t>& getPiecePositions(const PieceType& type);
 
-    bool parsePosition(const std::string& position);
-    bool parseRow(const std::string& row, uint8_t rowIndex);
-    bool parseActiveColor(const std::string& activeColor);
-    bool parseCastlingRights(const std::string& castlingRights);
-    bool parseEnPassant(const std::string& enPassant);
-
     void handleCastling(PieceFigure figure, Move move);
     void handleEnPassant(Move move);
     void handlePromotion(Move move);
@@ -149,12 +170,36 @@ inline std::vector<uint16_t> PieceBitBoards::getSetBitPositions(uint64_t number)
 
 inline uint16_t PieceBitBoards::countSetBits(uint64_t number)
 {
+#if defined(__GNUC__) || defined(__clang__)
+    return static_cast<uint16_t>(__builtin_popcountll(number));
+#elif defined(_MSC_VER)
+    return static_cast<uint16_t>(__popcnt64(number));
+#else
     uint16_t count = 0;
     while (number) {
         number &= (number - 1);
         count++;
     }
     return count;
+#endif
+}
+
+inline uint16_t PieceBitBoards::getLeastSignificantSetBit(uint64_t number)
+{
+#if defined(__GNUC__) || defined(__clang__)
+    return static_cast<uint16_t>(__builtin_ctzll(number));
+#elif defined(_MSC_VER)
+    unsigned long index;
+    _BitScanForward64(&index, number);
+    return static_cast<uint16_t>(index);
+#else
+    uint16_t index = 0;
+    while (!(number & 1)) {
+        number >>= 1;
+        index++;
+    }
+    return index;
+#endif
 }
 
 inline std::map<PieceType, const uint64_t*> PieceBitBoards::getTypeToPieceBitBoards() const
@@ -175,6 +220,28 @@ inline std::map<PieceType, const uint64_t*> PieceBitBoards::getTypeToPieceBitBoa
     };
 }
 
+inline std::array<uint64_t, 12> PieceBitBoards::getBitBoardsByPieceIndex() const
+{
+    return {whitePawns, whiteBishops, whiteKnights, whiteRooks, whiteKing, whiteQueens,
+            blackPawns, blackBishops, blackKnights, blackRooks, blackKing, blackQueens};
+}
+
+inline void PieceBitBoards::setBitBoardsByPieceIndex(const std::array<uint64_t, 12>& bitBoards)
+{
+    whitePawns = bitBoards[0];
+    whiteBishops = bitBoards[1];
+    whiteKnights = bitBoards[2];
+    whiteRooks = bitBoards[3];
+    whiteKing = bitBoards[4];
+    whiteQueens = bitBoards[5];
+    blackPawns = bitBoards[6];
+    blackBishops = bitBoards[7];
+    blackKnights = bitBoards[8];
+    blackRooks = bitBoards[9];
+    blackKing = bitBoards[10];
+    blackQueens = bitBoards[11];
+}
+
 template <typename TBitWiseOperator>
 inline PieceType PieceBitBoards::modifyAllBitBoards(uint64_t mask, TBitWiseOperator bitWiseOperator)
 {
@@ -0,0 +1,180 @@
+#include "PositionDataset.h"
+#include "Fen.h"
+#include "PieceBitBoards.h"
+
+#include <algorithm>
+#include <filesystem>
+#include <numeric>
+#include <optional>
+#include <random>
+#include <string_view>
+
+namespace chessAi
+{
+
+namespace
+{
+
+std::optional<TrainingData::Result> parseResultToken(std::string_view token)
+{
+    if (token == "1-0" || token == "[1.0]")
+        return TrainingData::Win;
+    if (token == "0-1" || token == "[0.0]")
+        return TrainingData::Loss;
+    if (token == "1/2-1/2" || token == "[0.5]")
+        return TrainingData::Draw;
+    return {};
+}
+
+/**
+ * Game result from the view of white, from the "c9" operation or the last token of the EPD
+ * operations. Only explicit results are accepted, so numbers of other operations (hmvc 0;
+ * fmvn 1;) are not taken for one.
+ */
+std::optional<TrainingData::Result> parseResult(std::string_view operations)
+{
+    if (auto c9 = Fen::getEpdOperation(operations, "c9"))
+        return parseResultToken(*c9);
+
+    auto isSeparator = [](char c) { return c == ' ' || c == '\t' || c == '\r' || c == ';'; };
+    while (!operations.empty() && isSeparator(operations.back()))
+        operations.remove_suffix(1);
+    auto start = operations.size();
+    while (start > 0 && !isSeparator(operations[start - 1]))
+        --start;
+    auto token = operations.substr(start);
+    if (token.size() >= 2 && token.front() == '"' && token.back() == '"')
+        token = token.substr(1, token.size() - 2);
+    return parseResultToken(token);
+}
+
+} // namespace
+
+bool PositionDataset::open(const std::vector<std::string>& paths)
+{
+    m_files.clear();
+    m_size = 0;
+
+    for (const auto& path : paths) {
+        if (!std::filesystem::is_directory(path)) {
+            if (!openFile(path))
+                return false;
+            continue;
+        }
+
+        std::vector<std::string> shards;
+        for (const auto& entry : std::filesystem::directory_iterator(path)) {
+            if (entry.is_regular_file() && entry.path().extension() == ".bin")
+                shards.push_back(entry.path().string());
+        }
+        std::sort(shards.begin(), shards.end());
+        for (const auto& shard : shards) {
+            if (!openFile(shard))
+                return false;
+        }
+    }
+    return true;
+}
+
+bool PositionDataset::open(const std::string& path)
+{
+    return open(std::vector<std::string>{path});
+}
+
+size_t PositionDataset::size() const
+{
+    return m_size;
+}
+
+bool PositionDataset::empty() const
+{
+    return m_size == 0;
+}
+
+const TrainingSample& PositionDataset::operator[](size_t index) const
+{
+    // Last file with offset not greater than index.
+    auto file = std::upper_bound(m_files.begin(), m_files.end(), index,
+                                 [](size_t value, const File& f) { return value < f.offset; });
+    --file;
+    return file->samples[index - file->offset];
+}
+
+std::pair<size_t, size_t> PositionDataset::getShardRange(size_t shard, size_t shardCount) const
+{
+    auto begin = m_size * shard / shardCount;
+    auto end = m_size * (shard + 1) / shardCount;
+    return {begin, end};
+}
+
+std::vector<size_t> PositionDataset::getShuffledIndices(uint64_t seed) const
+{
+    std::vector<size_t> indices(m_size);
+    std::iota(indices.begin(), indices.end(), 0);
+    std::mt19937_64 random(seed);
+    std::shuffle(indices.begin(), indices.end(), random);
+    return indices;
+}
+
+bool PositionDataset::openFile(const std::string& path)
+{
+    File file;
+    bool opened = (std::filesystem::path(path).extension() == ".bin") ? openBinaryFile(path, file)
+                                                                       : openTextFile(path, file);
+    if (!opened)
+        return false;
+
+    // Empty files are skipped, so every file has at least one sample for operator[].
+    if (file.size == 0)
+        return true;
+    file.offset = m_size;
+    m_size += file.size;
+    m_files.push_back(std::move(file));
+    return true;
+}
+
+bool PositionDataset::openBinaryFile(const std::string& path, File& file)
+{
+    file.mappedFile = MappedFile(path);
+    if (!file.mappedFile.isOpen())
+        return false;
+
+    if (file.mappedFile.size() % sizeof(TrainingSample) != 0) {
+        CHESS_LOG_ERROR("Size of {} is not a multiple of {} bytes.", path, sizeof(TrainingSample));
+        return false;
+    }
+    file.samples = reinterpret_cast<const TrainingSample*>(file.mappedFile.data());
+    file.size = file.mappedFile.size() / sizeof(TrainingSample);
+    return true;
+}
+
+bool PositionDataset::openTextFile(const std::string& path, File& file)
+{
+    auto lines = Fen::forEachEpdLine(
+        path, [&file](const PieceBitBoards& bitBoards, std::string_view operations) {
+            auto packed = PackedPosition::pack(bitBoards);
+            if (!packed.has_value())
+                return;
+
+            TrainingSample sample;
+            sample.position = *packed;
+            auto result = parseResult(operations);
+            if (!result.has_value())
+                sample.position.result = TrainingData::Unknown;
+            else if (bitBoards.currentMoveColor == PieceColor::White)
+                sample.position.result = *result;
+            else
+                sample.position.result = static_cast<uint8_t>(TrainingData::Win - *result);
+            file.parsedSamples.push_back(sample);
+        });
+    if (!lines.has_value()) {
+        CHESS_LOG_ERROR("Couldn't open positions file {}.", path);
+        return false;
+    }
+
+    file.samples = file.parsedSamples.data();
+    file.size = file.parsedSamples.size();
+    return true;
+}
+
+} // namespace chessAi
@@ -0,0 +1,117 @@
+#pragma once
+
+#include "MappedFile.h"
+#include "TrainingData.h"
+
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace chessAi
+{
+
+/**
+ * Read only set of positions loaded from one or more files, for tools and benchmarks which
+ * process many positions.
+ *
+ * Binary files (.bin, see TrainingData) are memory mapped and their samples are accessed in
+ * place, without copying, so opening is constant time and only the pages used are loaded. Text
+ * files (FEN or EPD per line, optionally followed by the game result from the view of white:
+ * 1-0, 0-1, 1/2-1/2 or [1.0], [0.5], [0.0], or in a "c9" operation) are parsed once and stored
+ * packed, positions without a result get TrainingData::Unknown.
+ *
+ * Samples are indexed from 0 to size() - 1 over all files in order. Safe to read from many
+ * threads, getShardRange splits the samples between them.
+ */
+class PositionDataset
+{
+public:
+    /**
+     * Opens files in order. A directory adds all .bin files in it, sorted by name (shards of the
+     * self-play generator). Previously opened files are closed.
+     *
+     * @return false If a file couldn't be opened or has invalid size, errors are logged.
+     */
+    bool open(const std::vector<std::string>& paths);
+
+    bool open(const std::string& path);
+
+    size_t size() const;
+
+    bool empty() const;
+
+    const TrainingSample& operator[](size_t index) const;
+
+    /**
+     * Range [begin, end) of the shard with index shard, when samples are split into shardCount
+     * contiguous shards of (almost) equal size.
+     */
+    std::pair<size_t, size_t> getShardRange(size_t shard, size_t shardCount) const;
+
+    /**
+     * Random permutation of all sample indices, the same for the same seed. Reading samples in
+     * this order gives shuffled access without moving the samples.
+     */
+    std::vector<size_t> getShuffledIndices(uint64_t seed) const;
+
+    /**
+     * Calls function(const TrainingSample&) for samples in [begin, end), in order. Faster than
+     * indexing, samples of one file are iterated as an array.
+     */
+    template <typename TFunction>
+    void forEach(size_t begin, size_t end, const TFunction& function) const;
+
+    template <typename TFunction>
+    void forEach(const TFunction& function) const;
+
+private:
+    struct File
+    {
+        MappedFile mappedFile;
+        /**
+         * Parsed samples of text files.
+         */
+        std::vector<TrainingSample> parsedSamples;
+        const TrainingSample* samples = nullptr;
+        size_t size = 0;
+        /**
+         * Index of the first sample in the dataset.
+         */
+        size_t offset = 0;
+    };
+
+    bool openFile(const std::string& path);
+
+    static bool openBinaryFile(const std::string& path, File& file);
+
+    static bool openTextFile(const std::string& path, File& file);
+
+private:
+    std::vector<File> m_files;
+    size_t m_size = 0;
+};
+
+template <typename TFunction>
+void PositionDataset::forEach(size_t begin, size_t end, const TFunction& function) const
+{
+    for (const auto& file : m_files) {
+        if (begin >= end)
+            return;
+        if (begin >= file.offset + file.size)
+            continue;
+
+        auto last = std::min(end, file.offset + file.size);
+        for (auto index = begin; index < last; ++index)
+            function(file.samples[index - file.offset]);
+        begin = last;
+    }
+}
+
+template <typename TFunction>
+void PositionDataset::forEach(const TFunction& function) const
+{
+    forEach(0, m_size, function);
+}
+
+} // namespace chessAi
@@ -0,0 +1,77 @@
+#include "Profiler.h"
+
+#include <algorithm>
+#include <cstdio>
+
+namespace chessAi
+{
+
+bool Profiler::writeChromeTrace(const std::string& path)
+{
+    std::lock_guard<std::mutex> lock(s_mutex);
+    auto* file = std::fopen(path.c_str(), "w");
+    if (file == nullptr) {
+        CHESS_LOG_ERROR("Profiler trace file {} couldn't be opened.", path);
+        return false;
+    }
+
+    // Timestamps start at the first recorded zone.
+    uint64_t origin = UINT64_MAX;
+    for (const auto& buffer : s_buffers) {
+        auto count = buffer->count.load(std::memory_order_acquire);
+        for (auto i = count > s_capacity ? count - s_capacity : 0; i < count; ++i)
+            origin = std::min(origin, buffer->events[i & (s_capacity - 1)].start);
+    }
+
+    // Complete events ("X") in microseconds, nested zones are stacked by their times.
+    std::fprintf(file, "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[");
+    bool first = true;
+    size_t events = 0;
+    for (const auto& buffer : s_buffers) {
+        auto count = buffer->count.load(std::memory_order_acquire);
+        for (auto i = count > s_capacity ? count - s_capacity : 0; i < count; ++i) {
+            const auto& event = buffer->events[i & (s_capacity - 1)];
+            std::fprintf(file,
+                         "%s\n{\"name\":\"%s\",\"ph\":\"X\",\"ts\":%.3f,\"dur\":%.3f,\"pid\":1,"
+                         "\"tid\":%u}",
+                         first ? "" : ",", event.name,
+                         static_cast<double>(event.start - origin) / 1000.0,
+                         static_cast<double>(event.end - event.start) / 1000.0,
+                         buffer->threadId);
+            first = false;
+            ++events;
+        }
+    }
+    std::fprintf(file, "\n]}\n");
+
+    bool written = std::ferror(file) == 0;
+    written = std::fclose(file) == 0 && written;
+    if (!written) {
+        CHESS_LOG_ERROR("Profiler trace file {} couldn't be written.", path);
+        return false;
+    }
+    CHESS_LOG_INFO("Profiler trace with {} zones of {} threads written to {}.", events,
+                   s_buffers.size(), path);
+    return true;
+}
+
+void Profiler::clear()
+{
+    std::lock_guard<std::mutex> lock(s_mutex);
+    for (auto& buffer : s_buffers)
+        buffer->count.store(0, std::memory_order_release);
+}
+
+Profiler::ThreadBuffer* Profiler::registerThread()
+{
+    auto buffer = std::make_unique<ThreadBuffer>();
+    buffer->events = std::make_unique<Event[]>(s_capacity);
+
+    std::lock_guard<std::mutex> lock(s_mutex);
+    buffer->threadId = static_cast<unsigned int>(s_buffers.size() + 1);
+    s_threadBuffer = buffer.get();
+    s_buffers.push_back(std::move(buffer));
+    return s_threadBuffer;
+}
+
+} // namespace chessAi
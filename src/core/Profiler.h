@@ -0,0 +1,118 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace chessAi
+{
+
+/**
+ * Scoped profiling zones of the search, exported as Chrome trace JSON (chrome://tracing,
+ * ui.perfetto.dev).
+ *
+ * Zones in engine code use CHESS_PROFILE_ZONE, which compiles to nothing unless the CHESS_PROFILING
+ * CMake option is on. Every thread records finished zones into its own ring buffer without locks,
+ * only the most recent s_capacity zones per thread are kept. Export and clear while no zones are
+ * recorded (searches stopped), buffers are not synchronized with writers.
+ */
+class Profiler
+{
+public:
+    class Zone
+    {
+    public:
+        /**
+         * @param name String literal, only the pointer is stored.
+         */
+        explicit Zone(const char* name) : m_name(name), m_start(getTime()) {}
+        ~Zone() { record(m_name, m_start, getTime()); }
+
+        Zone(const Zone&) = delete;
+        Zone& operator=(const Zone&) = delete;
+
+    private:
+        const char* m_name;
+        uint64_t m_start;
+    };
+
+    /**
+     * Writes zones of all threads, including finished ones, as Chrome trace events.
+     *
+     * @return false If the file couldn't be written.
+     */
+    static bool writeChromeTrace(const std::string& path);
+
+    /**
+     * Drops recorded zones of all threads.
+     */
+    static void clear();
+
+    /**
+     * Zones per thread, 24 bytes each.
+     */
+    inline static constexpr uint64_t s_capacity = 1 << 18;
+
+private:
+    struct Event
+    {
+        const char* name;
+        uint64_t start;
+        uint64_t end;
+    };
+
+    struct ThreadBuffer
+    {
+        std::unique_ptr<Event[]> events;
+        /**
+         * Recorded events, the buffer holds the last s_capacity of them.
+         */
+        std::atomic<uint64_t> count{0};
+        unsigned int threadId = 0;
+    };
+
+    static uint64_t getTime();
+
+    static void record(const char* name, uint64_t start, uint64_t end);
+
+    /**
+     * Creates the buffer of the calling thread on its first zone.
+     */
+    static ThreadBuffer* registerThread();
+
+private:
+    inline static std::mutex s_mutex;
+    // Owned until exit, zones of finished threads are still exported.
+    inline static std::vector<std::unique_ptr<ThreadBuffer>> s_buffers;
+    inline static thread_local ThreadBuffer* s_threadBuffer = nullptr;
+};
+
+inline uint64_t Profiler::getTime()
+{
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                                     std::chrono::steady_clock::now().time_since_epoch())
+                                     .count());
+}
+
+inline void Profiler::record(const char* name, uint64_t start, uint64_t end)
+{
+    auto* buffer = s_threadBuffer != nullptr ? s_threadBuffer : registerThread();
+    auto index = buffer->count.load(std::memory_order_relaxed);
+    buffer->events[index & (s_capacity - 1)] = {name, start, end};
+    buffer->count.store(index + 1, std::memory_order_release);
+}
+
+} // namespace chessAi
+
+#define CHESS_PROFILE_CONCAT_IMPL(a, b) a##b
+#define CHESS_PROFILE_CONCAT(a, b) CHESS_PROFILE_CONCAT_IMPL(a, b)
+
+#if CHESS_PROFILING
+    #define CHESS_PROFILE_ZONE(name)                                                              \
+        ::chessAi::Profiler::Zone CHESS_PROFILE_CONCAT(chessProfileZone, __LINE__)(name)
+#else
+    #define CHESS_PROFILE_ZONE(name)
+#endif
@@ -0,0 +1,55 @@
+#include "TrainingData.h"
+
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+
+namespace chessAi
+{
+
+std::string TrainingData::getShardPath(const std::string& prefix, unsigned int shard)
+{
+    char index[16];
+    std::snprintf(index, sizeof(index), "_%05u.bin", shard);
+    return prefix + index;
+}
+
+std::vector<unsigned int> TrainingData::getMissingShards(const std::string& prefix,
+                                                         unsigned int shards)
+{
+    std::vector<unsigned int> missing;
+    for (unsigned int shard = 0; shard < shards; ++shard) {
+        std::error_code error;
+        if (!std::filesystem::is_regular_file(getShardPath(prefix, shard), error))
+            missing.push_back(shard);
+    }
+    return missing;
+}
+
+bool TrainingData::writeShard(const std::string& path, const std::vector<TrainingSample>& samples)
+{
+    auto temporaryPath = path + ".tmp";
+    {
+        std::ofstream file(temporaryPath, std::ios::binary);
+        if (!file.is_open()) {
+            CHESS_LOG_ERROR("Couldn't open {} for writing.", temporaryPath);
+            return false;
+        }
+        file.write(reinterpret_cast<const char*>(samples.data()),
+                   static_cast<std::streamsize>(samples.size() * sizeof(TrainingSample)));
+        if (!file) {
+            CHESS_LOG_ERROR("Couldn't write {}.", temporaryPath);
+            return false;
+        }
+    }
+
+    std::error_code error;
+    std::filesystem::rename(temporaryPath, path, error);
+    if (error) {
+        CHESS_LOG_ERROR("Couldn't rename {} to {}: {}", temporaryPath, path, error.message());
+        return false;
+    }
+    return true;
+}
+
+} // namespace chessAi
@@ -0,0 +1,77 @@
+#pragma once
+
+#include "PackedPosition.h"
+
+#include <string>
+#include <vector>
+
+namespace chessAi
+{
+
+/**
+ * One position of a self-play game. PackedPosition::score holds the search score and
+ * PackedPosition::result the game result, both from the view of the side to move.
+ */
+struct TrainingSample
+{
+    PackedPosition position;
+    /**
+     * Best move found by the search, encoded with OpeningBook::encodeMove.
+     */
+    uint16_t move = 0;
+    /**
+     * Depth the search reached.
+     */
+    uint16_t depth = 0;
+    /**
+     * Index of the game in its shard, positions of one game are stored in order.
+     */
+    uint32_t game = 0;
+};
+
+static_assert(sizeof(TrainingSample) == 40, "Training sample must have 40 bytes.");
+
+/**
+ * Training data is stored in shards, binary files of TrainingSample structs stored as they are
+ * (see PackedPosition), without header. Shards are written to a temporary file which is renamed
+ * when the shard is complete, so existing shard files are always complete and an interrupted
+ * generation can be resumed by skipping them.
+ */
+class TrainingData
+{
+public:
+    /**
+     * PackedPosition::result values.
+     */
+    enum Result : uint8_t
+    {
+        Loss = 0,
+        Draw = 1,
+        Win = 2,
+        /**
+         * Positions from text datasets without a result.
+         */
+        Unknown = 3
+    };
+
+    /**
+     * Shard file name: prefix followed by shard index with 5 digits (data_00042.bin).
+     */
+    static std::string getShardPath(const std::string& prefix, unsigned int shard);
+
+    /**
+     * Indices below shards without a shard file, the shards an interrupted generation still has
+     * to write. Temporary files of unfinished shards don't count.
+     */
+    static std::vector<unsigned int> getMissingShards(const std::string& prefix,
+                                                      unsigned int shards);
+
+    /**
+     * Writes samples to a temporary file and renames it to path.
+     *
+     * @return true If successful.
+     */
+    static bool writeShard(const std::string& path, const std::vector<TrainingSample>& samples);
+};
+
+} // namespace chessAi
@@ -1,4 +1,5 @@
 #include "TranspositionTable.h"
+#include "Profiler.h"
 
 namespace chessAi
 {
@@ -27,18 +28,28 @@ TranspositionTable::TranspositionTable()
 void TranspositionTable::store(uint64_t zobristHash, int evaluation, unsigned int depth,
                                TypeOfNode typeOfNode, Move bestMove)
 {
+    CHESS_PROFILE_ZONE("ttStore");
     m_table->at(hashFunction(zobristHash)) =
         std::move(Entry(zobristHash, evaluation, depth, typeOfNode, bestMove));
 }
 
 const TranspositionTable::Entry* TranspositionTable::getEntry(uint64_t zobristHash)
 {
+    CHESS_PROFILE_ZONE("ttProbe");
     auto entry = &m_table->at(hashFunction(zobristHash));
     if (entry->key == zobristHash)
         return entry;
     return nullptr;
 }
 
+unsigned int TranspositionTable::getHashFull() const
+{
+    unsigned int used = 0;
+    for (size_t i = 0; i < 1000; ++i)
+        used += (*m_table)[i].typeOfNode != TypeOfNode::none;
+    return used;
+}
+
 void TranspositionTable::clear()
 {
     m_table->fill(Entry());
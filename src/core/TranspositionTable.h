@@ -36,6 +36,11 @@ public:
 
     const Entry* getEntry(uint64_t zobristHash);
 
+    /**
+     * Used entries in permille, estimated from the first 1000 entries.
+     */
+    unsigned int getHashFull() const;
+
     void clear();
 
 private:
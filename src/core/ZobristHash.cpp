@@ -1,5 +1,6 @@
 #include "ZobristHash.h"
 
+#include <mutex>
 #include <random>
 
 namespace chessAi
@@ -28,18 +29,22 @@ void ZobristHash::initZobristNumbers()
 
 uint64_t ZobristHash::calculateZobristKey(const PieceBitBoards& boards)
 {
-    initZobristNumbers();
+    // Boards are constructed from many threads (tuner, data generation), numbers are generated
+    // only once.
+    static std::once_flag s_initFlag;
+    std::call_once(s_initFlag, initZobristNumbers);
 
     uint64_t key = 0;
 
-    for (uint16_t i = 0; i < 64; ++i) {
-        auto type = boards.getPieceTypeWithSetBitAtPosition(i);
-        if (type.getPieceFigure() != PieceFigure::Empty) {
-            key ^= s_pieces[i][type.getPieceIndex()];
-        }
+    auto pieceBitBoards = boards.getBitBoardsByPieceIndex();
+    for (size_t index = 0; index < pieceBitBoards.size(); ++index) {
+        for (auto bitBoard = pieceBitBoards[index]; bitBoard; bitBoard &= bitBoard - 1)
+            key ^= s_pieces[PieceBitBoards::getLeastSignificantSetBit(bitBoard)][index];
     }
 
-    key ^= s_enPassantFile[boards.enPassantTargetSquare % 8];
+    // Same as in PieceBitBoards::applyMove, en passant file is hashed only if there is a target.
+    if (boards.enPassantTargetSquare != 0)
+        key ^= s_enPassantFile[boards.enPassantTargetSquare % 8];
 
     if (boards.currentMoveColor == PieceColor::Black)
         key ^= s_sideToMove;
@@ -2,7 +2,7 @@
 #include "core/EndOfGameChecker.h"
 #include "core/MoveGenerator.h"
 
-#include <thread>
+#include <algorithm>
 
 namespace chessAi
 {
@@ -80,21 +80,27 @@ unsigned int countNumberOfOccurrences(const std::string& s, char c)
 
 } // namespace
 
-Game::Game(sf::RenderWindow* window, PieceColor color, bool againstComputer,
-           const std::chrono::milliseconds& timeLimit, const std::string& fenString)
+Game::Game(sf::RenderWindow* window, EngineWorker& engineWorker, PieceColor color,
+           bool againstComputer, const std::chrono::milliseconds& timeLimit,
+           const std::string& fenString)
     : m_window(window), m_board(std::min(m_window->getSize().x, m_window->getSize().y) * 4 / 5),
       m_pieceTextures(getPieceTextures()), m_selectedPiecePosition(std::nullopt),
       m_selectedPawnPromotion(std::nullopt), m_promotionDrawn(std::nullopt), m_playerColor(color),
       m_boardState(fenString), m_font(), m_instructions(), m_endOfGameText(),
       m_showGameHistoryText(), m_whiteMovesText(), m_blackMovesText(), m_gameHistoryWhiteText(),
       m_gameHistoryBlackText(), m_gameHistoryBackground(), m_gameHistoryView(),
-      m_engine(true, timeLimit), m_againstComputer(againstComputer), m_engineThread(),
-      m_engineIsRunning(false), m_runGame(true), m_showGameHistory(false), m_mouseScrolled(0),
+      m_engineWorker(engineWorker), m_againstComputer(againstComputer), m_lastEngineRequest(0),
+      m_engineRequest(std::nullopt), m_ponderRequest(std::nullopt), m_engineResultsMutex(),
+      m_engineResults(), m_ponderKey(0), m_runGame(true), m_showGameHistory(false),
+      m_mouseScrolled(0),
       m_figureNotation({'\0', 'B', 'N', 'R', 'K', 'Q'}), m_whiteMovesString(""),
       m_blackMovesString("")
 {
     m_board.setCenterPosition(m_window->getSize());
 
+    m_engineWorker.post([timeLimit](Engine& engine) { engine.setTimeLimit(timeLimit); });
+    m_engineWorker.newGame();
+
     if (!m_font.loadFromFile("fonts/arial_narrow_7.ttf")) {
         throw std::runtime_error("Game font couldn't be loaded.");
     }
@@ -179,7 +185,7 @@ void Game::handleMousePressed(const sf::Event& event)
         return;
     }
 
-    if (m_engineIsRunning || !m_endOfGameText.getString().isEmpty())
+    if (m_engineRequest.has_value() || !m_endOfGameText.getString().isEmpty())
         return;
 
     auto [positionX, positionY] =
@@ -350,10 +356,11 @@ void Game::handleEvents()
             }
             break;
         case sf::Event::KeyPressed:
-            if (m_engineIsRunning)
+            if (m_engineRequest.has_value())
                 break;
             if (event.key.scancode == sf::Keyboard::Scan::Left) {
                 CHESS_LOG_TRACE("Left arrow pressed.");
+                stopPondering();
                 m_whiteMovesString = "";
                 m_blackMovesString = "";
                 m_boardState.goToPreviousBoardState();
@@ -806,26 +813,63 @@ void Game::displayGameSprites()
     m_window->display();
 }
 
-void Game::runEngine()
+void Game::updateEngine()
 {
-    m_engineIsRunning = true;
-
-    auto [move, depth] =
-        m_engine.findBestMove(m_boardState.getBitBoards(), m_boardState.getZobristKeyHistory(),
-                              m_boardState.getMovesHistory());
-    CHESS_LOG_INFO("Depth to which the engine searched is {}\n", depth);
-    if (move.has_value()) {
-        auto endOfGame = m_boardState.updateBoardState(*move);
+    if (m_engineRequest.has_value()) {
+        std::optional<EngineWorker::Result> result;
+        {
+            std::lock_guard<std::mutex> lock(m_engineResultsMutex);
+            for (const auto& [request, requestResult] : m_engineResults) {
+                if (request == *m_engineRequest)
+                    result = requestResult;
+            }
+            if (result.has_value())
+                m_engineResults.clear();
+        }
+        if (result.has_value()) {
+            m_engineRequest = std::nullopt;
+            applyEngineMove(*result);
+            startPondering(*result);
+        }
+    }
+    else if (m_endOfGameText.getString().isEmpty() &&
+             m_playerColor != m_boardState.getBitBoards().currentMoveColor) {
+        requestEngineMove();
+    }
+}
 
-        if (endOfGame == EndOfGameType::Checkmate)
-            m_endOfGameText.setString("CHECKMATE");
-        else if (endOfGame == EndOfGameType::Stalemate)
-            m_endOfGameText.setString("STALEMATE");
+void Game::requestEngineMove()
+{
+    const auto& bitBoards = m_boardState.getBitBoards();
+    if (m_ponderRequest.has_value() && m_ponderKey == bitBoards.zobristKey) {
+        CHESS_LOG_INFO("Ponder hit.");
+        m_engineWorker.ponderHit();
+        m_engineRequest = m_ponderRequest;
+        m_ponderRequest = std::nullopt;
+        return;
     }
-    else
+    if (m_ponderRequest.has_value())
+        CHESS_LOG_INFO("Ponder miss.");
+    stopPondering();
+
+    m_engineRequest = ++m_lastEngineRequest;
+    m_engineWorker.search(bitBoards, m_boardState.getZobristKeyHistory(),
+                          getEngineResultCallback(*m_engineRequest));
+}
+
+void Game::applyEngineMove(const EngineWorker::Result& result)
+{
+    CHESS_LOG_INFO("Depth to which the engine searched is {}\n", result.depth);
+    if (!result.move.has_value()) {
         CHESS_LOG_ERROR("Engine didn't return move in position.");
+        return;
+    }
 
-    m_engineIsRunning = false;
+    auto endOfGame = m_boardState.updateBoardState(*result.move);
+    if (endOfGame == EndOfGameType::Checkmate)
+        m_endOfGameText.setString("CHECKMATE");
+    else if (endOfGame == EndOfGameType::Stalemate)
+        m_endOfGameText.setString("STALEMATE");
 }
 
 void Game::runGame()
@@ -833,16 +877,48 @@ void Game::runGame()
     while (m_window->isOpen() && m_runGame) {
         handleEvents();
         displayGameSprites();
-        if (m_againstComputer && !m_engineIsRunning) {
-            if (m_engineThread.joinable())
-                m_engineThread.join();
-            else {
-                if (m_playerColor != m_boardState.getBitBoards().currentMoveColor) {
-                    m_engineThread = std::thread(&Game::runEngine, this);
-                }
-            }
-        }
+        if (m_againstComputer)
+            updateEngine();
     }
+    // Worker is reused by the next game, no callback may come after this game is gone.
+    m_engineWorker.stop();
+    m_engineWorker.wait();
+}
+
+void Game::startPondering(const EngineWorker::Result& result)
+{
+    if (!m_endOfGameText.getString().isEmpty() || !result.ponderMove.has_value() ||
+        m_playerColor != m_boardState.getBitBoards().currentMoveColor)
+        return;
+
+    // Search the position after the expected reply while the player is thinking.
+    auto bitBoards = m_boardState.getBitBoards();
+    auto moves = MoveGeneratorWrapper::generateLegalMoves<MoveType::Normal>(bitBoards);
+    if (std::find(moves.begin(), moves.end(), *result.ponderMove) == moves.end())
+        return;
+    bitBoards.applyMove(*result.ponderMove);
+    auto history = m_boardState.getZobristKeyHistory();
+    history.push_back(bitBoards.zobristKey);
+
+    m_ponderKey = bitBoards.zobristKey;
+    m_ponderRequest = ++m_lastEngineRequest;
+    m_engineWorker.ponder(bitBoards, history, getEngineResultCallback(*m_ponderRequest));
+}
+
+void Game::stopPondering()
+{
+    if (!m_ponderRequest.has_value())
+        return;
+    m_engineWorker.stop();
+    m_ponderRequest = std::nullopt;
+}
+
+EngineWorker::ResultCallback Game::getEngineResultCallback(unsigned int request)
+{
+    return [this, request](const EngineWorker::Result& result) {
+        std::lock_guard<std::mutex> lock(m_engineResultsMutex);
+        m_engineResults.emplace_back(request, result);
+    };
 }
 
 } // namespace chessAi
\ No newline at end of file
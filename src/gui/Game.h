@@ -2,10 +2,11 @@
 
 #include "Board.h"
 #include "core/BoardState.h"
-#include "core/Engine.h"
+#include "core/EngineWorker.h"
 
 #include <SFML/Graphics.hpp>
 
+#include <mutex>
 #include <optional>
 #include <unordered_map>
 
@@ -16,17 +17,24 @@ class Game
 {
 public:
     /**
-     * Construct a new Game object, that will run the gui window and the game logic.
+     * Construct a new Game object, that will run the gui window and the game logic. Engine worker
+     * is shared by all games, it only gets requests from the game.
      */
-    Game(sf::RenderWindow* window, PieceColor color, bool againstComputer,
-         const std::chrono::milliseconds& timeLimit, const std::string& fenString);
+    Game(sf::RenderWindow* window, EngineWorker& engineWorker, PieceColor color,
+         bool againstComputer, const std::chrono::milliseconds& timeLimit,
+         const std::string& fenString);
 
     void runGame();
 
 private:
     void handleEvents();
     void displayGameSprites();
-    void runEngine();
+    void updateEngine();
+    void requestEngineMove();
+    void applyEngineMove(const EngineWorker::Result& result);
+    void startPondering(const EngineWorker::Result& result);
+    void stopPondering();
+    EngineWorker::ResultCallback getEngineResultCallback(unsigned int request);
     void handleWindowResize(const sf::Event& event);
     void handleMousePressed(const sf::Event& event);
     bool determineMousePressedOnBoard(int x, int y);
@@ -80,10 +88,28 @@ private:
     sf::Text m_gameHistoryBlackText;
     sf::RectangleShape m_gameHistoryBackground;
     sf::View m_gameHistoryView;
-    Engine m_engine;
+    EngineWorker& m_engineWorker;
     bool m_againstComputer;
-    std::thread m_engineThread;
-    std::atomic<bool> m_engineIsRunning;
+    /**
+     * Requests sent to the engine worker are numbered, results of stopped or outdated requests
+     * are ignored.
+     */
+    unsigned int m_lastEngineRequest;
+    /**
+     * Request whose move is awaited, the player can't move meanwhile.
+     */
+    std::optional<unsigned int> m_engineRequest;
+    std::optional<unsigned int> m_ponderRequest;
+    /**
+     * Results passed from the engine worker thread, board state is updated in the game thread.
+     */
+    std::mutex m_engineResultsMutex;
+    std::vector<std::pair<unsigned int, EngineWorker::Result>> m_engineResults;
+    /**
+     * Position searched while the player is thinking, engine move is ready if the player moves
+     * into it (ponder hit).
+     */
+    uint64_t m_ponderKey;
     bool m_runGame;
     bool m_showGameHistory;
     int m_mouseScrolled;
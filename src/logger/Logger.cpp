@@ -1,12 +1,13 @@
 #include "Logger.h"
 
+#include <spdlog/async.h>
 #include <spdlog/sinks/basic_file_sink.h>
 #include <spdlog/sinks/stdout_color_sinks.h>
 
 namespace chessAi
 {
 
-void Logger::Init()
+void Logger::Init(Mode mode)
 {
     if (s_logger != nullptr) {
         return;
@@ -19,9 +20,23 @@ void Logger::Init()
             std::make_shared<spdlog::sinks::basic_file_sink_mt>("chessAi_logger.txt", true));
         sinks[0]->set_level(spdlog::level::trace);
         sinks[1]->set_level(spdlog::level::trace);
-        auto logger = std::make_shared<spdlog::logger>("chessAi_logger", begin(sinks), end(sinks));
+        std::shared_ptr<spdlog::logger> logger;
+        if (mode == Mode::Asynchronous) {
+            // Sinks are only used by the one background thread, so flushing (periodic and on
+            // errors) never waits for a search thread, or a search thread for the disk.
+            spdlog::init_thread_pool(s_queueSize, 1);
+            logger = std::make_shared<spdlog::async_logger>(
+                "chessAi_logger", begin(sinks), end(sinks), spdlog::thread_pool(),
+                spdlog::async_overflow_policy::overrun_oldest);
+        }
+        else {
+            logger = std::make_shared<spdlog::logger>("chessAi_logger", begin(sinks), end(sinks));
+        }
+        logger->set_level(spdlog::level::trace);
+        logger->flush_on(spdlog::level::err);
+        // Registered, so flush_every and shutdown reach it.
+        spdlog::register_logger(logger);
         s_logger = logger;
-        s_logger->set_level(spdlog::level::trace);
         spdlog::flush_every(std::chrono::milliseconds(300));
     }
     catch (const std::exception& ex) {
@@ -13,28 +13,91 @@ namespace chessAi
 class Logger
 {
 public:
+    enum class Mode
+    {
+        /**
+         * Messages are formatted by the calling thread and written by a background thread. If
+         * the queue is full, the oldest message is dropped, logging never blocks the caller.
+         */
+        Asynchronous,
+        /**
+         * Messages are written by the calling thread, in order with other output.
+         */
+        Synchronous
+    };
+
     /**
-     * Create a file logger.
+     * Create a file and console logger. Does nothing if the logger already exists.
      */
-    static void Init();
+    static void Init(Mode mode = Mode::Asynchronous);
 
     static std::shared_ptr<spdlog::logger>& getLogger();
 
 private:
+    inline static constexpr size_t s_queueSize = 8192;
     inline static std::shared_ptr<spdlog::logger> s_logger = nullptr;
 };
 
 } // namespace chessAi
 
-#if DEBUG
+// Compile time log level, messages below it are removed with their arguments (no formatting or
+// level check). Set with the CHESS_LOG_LEVEL CMake option, trace in debug and info in release
+// builds by default.
+#define CHESS_LOG_LEVEL_TRACE 0
+#define CHESS_LOG_LEVEL_DEBUG 1
+#define CHESS_LOG_LEVEL_INFO 2
+#define CHESS_LOG_LEVEL_WARN 3
+#define CHESS_LOG_LEVEL_ERROR 4
+#define CHESS_LOG_LEVEL_CRITICAL 5
+#define CHESS_LOG_LEVEL_OFF 6
+
+#ifndef CHESS_LOG_LEVEL
+    #if DEBUG
+        #define CHESS_LOG_LEVEL CHESS_LOG_LEVEL_TRACE
+    #else
+        #define CHESS_LOG_LEVEL CHESS_LOG_LEVEL_INFO
+    #endif
+#endif
+
+// Removed messages still compile, so variables only used by them don't become unused.
+#define CHESS_LOG_DISABLED(...)                                                                    \
+    do {                                                                                           \
+        if constexpr (false)                                                                       \
+            ::chessAi::Logger::getLogger()->info(__VA_ARGS__);                                     \
+    } while (false)
+
+#if CHESS_LOG_LEVEL <= CHESS_LOG_LEVEL_TRACE
     #define CHESS_LOG_TRACE(...) ::chessAi::Logger::getLogger()->trace(__VA_ARGS__)
+#else
+    #define CHESS_LOG_TRACE(...) CHESS_LOG_DISABLED(__VA_ARGS__)
+#endif
+
+#if CHESS_LOG_LEVEL <= CHESS_LOG_LEVEL_DEBUG
     #define CHESS_LOG_DEBUG(...) ::chessAi::Logger::getLogger()->debug(__VA_ARGS__)
 #else
-    #define CHESS_LOG_TRACE(...)
-    #define CHESS_LOG_DEBUG(...)
+    #define CHESS_LOG_DEBUG(...) CHESS_LOG_DISABLED(__VA_ARGS__)
 #endif
 
-#define CHESS_LOG_INFO(...) ::chessAi::Logger::getLogger()->info(__VA_ARGS__)
-#define CHESS_LOG_WARN(...) ::chessAi::Logger::getLogger()->warn(__VA_ARGS__)
-#define CHESS_LOG_ERROR(...) ::chessAi::Logger::getLogger()->error(__VA_ARGS__)
-#define CHESS_LOG_CRITICAL(...) ::chessAi::Logger::getLogger()->critical(__VA_ARGS__)
\ No newline at end of file
+#if CHESS_LOG_LEVEL <= CHESS_LOG_LEVEL_INFO
+    #define CHESS_LOG_INFO(...) ::chessAi::Logger::getLogger()->info(__VA_ARGS__)
+#else
+    #define CHESS_LOG_INFO(...) CHESS_LOG_DISABLED(__VA_ARGS__)
+#endif
+
+#if CHESS_LOG_LEVEL <= CHESS_LOG_LEVEL_WARN
+    #define CHESS_LOG_WARN(...) ::chessAi::Logger::getLogger()->warn(__VA_ARGS__)
+#else
+    #define CHESS_LOG_WARN(...) CHESS_LOG_DISABLED(__VA_ARGS__)
+#endif
+
+#if CHESS_LOG_LEVEL <= CHESS_LOG_LEVEL_ERROR
+    #define CHESS_LOG_ERROR(...) ::chessAi::Logger::getLogger()->error(__VA_ARGS__)
+#else
+    #define CHESS_LOG_ERROR(...) CHESS_LOG_DISABLED(__VA_ARGS__)
+#endif
+
+#if CHESS_LOG_LEVEL <= CHESS_LOG_LEVEL_CRITICAL
+    #define CHESS_LOG_CRITICAL(...) ::chessAi::Logger::getLogger()->critical(__VA_ARGS__)
+#else
+    #define CHESS_LOG_CRITICAL(...) CHESS_LOG_DISABLED(__VA_ARGS__)
+#endif
@@ -1,6 +1,10 @@
+#include "core/EngineWorker.h"
+#include "core/Evaluate.h"
 #include "gui/Game.h"
 #include "gui/GameMenu.h"
 
+#include <filesystem>
+
 std::chrono::milliseconds getTimeLimit(chessAi::Difficulty difficulty)
 {
     switch (difficulty) {
@@ -15,16 +19,36 @@ std::chrono::milliseconds getTimeLimit(chessAi::Difficulty difficulty)
     }
 }
 
+/**
+ * Tuned evaluation parameters (see tools/texelTuner), optional.
+ */
+void loadEvaluationParameters(const std::string& path)
+{
+    if (!std::filesystem::exists(path)) {
+        CHESS_LOG_INFO("No {} found, using default evaluation parameters.", path);
+        return;
+    }
+
+    if (chessAi::Evaluate::loadParameters(path))
+        CHESS_LOG_INFO("Evaluation parameters loaded from {}.", path);
+}
+
 int main()
 {
     try {
+        loadEvaluationParameters("evaluation_parameters.txt");
+
         sf::RenderWindow window(sf::VideoMode(800, 800), "Chess Game");
         window.setFramerateLimit(30);
 
+        // Engine thread and its tables are created once and reused by all games.
+        chessAi::EngineWorker engineWorker(true, getTimeLimit(chessAi::Difficulty::easy));
+
         while (window.isOpen()) {
             chessAi::GameMenu menu(&window);
             auto playerSelection = menu.runMenu();
-            chessAi::Game game(&window, playerSelection.color, playerSelection.againstComputer,
+            chessAi::Game game(&window, engineWorker, playerSelection.color,
+                               playerSelection.againstComputer,
                                getTimeLimit(playerSelection.difficulty), playerSelection.fenString);
             game.runGame();
         }
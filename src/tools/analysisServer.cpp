@@ -0,0 +1,346 @@
+/**
+ * Analysis server: many analysis sessions multiplexed onto a fixed pool of engine workers (see
+ * core/AnalysisPool.h), so memory stays bounded however many sessions are open.
+ *
+ * Usage: analysis_server [options]
+ *   --threads <n>    Number of engine workers (default hardware concurrency).
+ *   --eval-cache <n> Size of the shared evaluation cache in MB (default 16).
+ *   --book <0|1>     Return book moves without search (default 0).
+ *
+ * Protocol: one JSON object per line on the standard input, replies are JSON objects per line on
+ * the standard output, in the order analyses finish.
+ *   {"cmd": "analyse", "id": "a1", "session": "s1", "fen": "...", "moves": ["e2e4"],
+ *    "depth": 10, "nodes": 100000, "movetime": 1000, "multipv": 1, "info": false}
+ *       Only fen is required (or "startpos": true). Moves are played from the position in UCI
+ *       notation. Reply {"type": "result", "id", "session", "bestmove", "ponder", "depth",
+ *       "score", "nodes", "time", "stopped", "checkmate", "stalemate",
+ *       "lines": [{"score", "pv": [...]}]}. Bestmove is null if the game is over. With "info"
+ *       every completed iteration is reported as {"type": "info", "id", "depth", "score",
+ *       "nodes", "nps", "pv"}.
+ *   {"cmd": "stop", "id": "a1"} or {"cmd": "stop", "session": "s1"}
+ *       Running analyses reply with their best move so far.
+ *   {"cmd": "stats"}
+ *       Reply {"type": "stats", "threads", "completed", "running", "queued", "analysesPerSecond"}.
+ *   {"cmd": "quit"}
+ *       Stops all analyses and exits. End of input waits for running analyses first.
+ * Invalid requests get {"type": "error", "id", "message"}.
+ */
+
+#include "core/AnalysisPool.h"
+#include "core/Fen.h"
+#include "core/Json.h"
+#include "core/Notation.h"
+
+#include <iostream>
+#include <limits>
+#include <map>
+#include <mutex>
+#include <thread>
+
+namespace chessAi
+{
+
+namespace
+{
+
+struct Options
+{
+    unsigned int threads = std::max(1u, std::thread::hardware_concurrency());
+    size_t evalCacheSizeInMegaBytes = 16;
+    bool useBook = false;
+};
+
+std::optional<Options> parseOptions(int argc, char** argv)
+{
+    if (argc % 2 != 1)
+        return {};
+
+    Options options;
+    for (int i = 1; i + 1 < argc; i += 2) {
+        std::string option = argv[i];
+        auto value = std::stoul(argv[i + 1]);
+        if (option == "--threads")
+            options.threads = std::max(1u, static_cast<unsigned int>(value));
+        else if (option == "--eval-cache")
+            options.evalCacheSizeInMegaBytes = std::max<size_t>(1, value);
+        else if (option == "--book")
+            options.useBook = value != 0;
+        else
+            return {};
+    }
+    return options;
+}
+
+JsonValue toJson(const std::vector<Move>& moves)
+{
+    JsonValue array{JsonValue::Array()};
+    for (const auto& move : moves)
+        array.push(Notation::moveToUci(move));
+    return array;
+}
+
+class Server
+{
+public:
+    explicit Server(const Options& options)
+        : m_pool(options.threads, options.useBook, options.evalCacheSizeInMegaBytes)
+    {
+    }
+
+    /**
+     * @return false on quit.
+     */
+    bool handleLine(const std::string& line)
+    {
+        if (line.find_first_not_of(" \t\r") == std::string::npos)
+            return true;
+
+        auto request = JsonValue::parse(line);
+        if (!request.has_value() || !request->isObject()) {
+            sendError(JsonValue(), "invalid JSON");
+            return true;
+        }
+
+        auto command = request->find("cmd") ? request->find("cmd")->getString() : "";
+        if (command == "analyse")
+            analyse(*request);
+        else if (command == "stop")
+            stop(*request);
+        else if (command == "stats")
+            sendStatistics();
+        else if (command == "quit")
+            return false;
+        else
+            sendError(getId(*request), "unknown command");
+        return true;
+    }
+
+    void stopAll()
+    {
+        m_pool.stopAll();
+        m_pool.wait();
+    }
+
+    void wait()
+    {
+        m_pool.wait();
+    }
+
+private:
+    static JsonValue getId(const JsonValue& request)
+    {
+        auto id = request.find("id");
+        return id ? *id : JsonValue();
+    }
+
+    /**
+     * Non negative number of the request, clamped to the range of T (casting a larger double is
+     * undefined).
+     */
+    template <typename T>
+    static T getUnsigned(const JsonValue& request, const std::string& key, T defaultValue)
+    {
+        auto value = request.find(key);
+        if (!value || !value->isNumber() || value->getNumber() < 0.0)
+            return defaultValue;
+        // Maximum of uint64_t is not exactly representable, it rounds up to 2^64.
+        if (value->getNumber() >= static_cast<double>(std::numeric_limits<T>::max()))
+            return std::numeric_limits<T>::max();
+        return static_cast<T>(value->getNumber());
+    }
+
+    void analyse(const JsonValue& request)
+    {
+        auto id = getId(request);
+        AnalysisPool::Analysis analysis;
+        analysis.session = request.find("session") ? request.find("session")->getString() : "";
+
+        std::string fen = request.find("fen") ? request.find("fen")->getString() : "";
+        if (request.find("startpos") && request.find("startpos")->getBool())
+            fen = std::string(Fen::startingPosition);
+        if (!Fen::parse(fen, analysis.bitBoards)) {
+            sendError(id, "invalid FEN");
+            return;
+        }
+        analysis.zobristKeysHistory.push_back(analysis.bitBoards.zobristKey);
+        if (auto moves = request.find("moves")) {
+            for (const auto& notation : moves->getArray()) {
+                auto move = Notation::uciToMove(notation.getString(), analysis.bitBoards);
+                if (!move.has_value()) {
+                    sendError(id, "illegal move " + notation.getString());
+                    return;
+                }
+                analysis.bitBoards.applyMove(*move);
+                analysis.zobristKeysHistory.push_back(analysis.bitBoards.zobristKey);
+            }
+        }
+
+        auto& limits = analysis.limits;
+        limits.depth = getUnsigned(request, "depth", 100u);
+        limits.nodes = getUnsigned<uint64_t>(request, "nodes", 0);
+        limits.multiPv = std::max(1u, getUnsigned(request, "multipv", 1u));
+        // Without any limit the analysis runs until it is stopped.
+        auto defaultTime = (request.find("depth") || request.find("nodes")) ? 0u : 1000u;
+        auto time = getUnsigned(request, "movetime", defaultTime);
+        limits.time = std::chrono::milliseconds(time > 0 ? time : 24u * 3600u * 1000u);
+
+        AnalysisPool::InfoCallback progress;
+        if (request.find("info") && request.find("info")->getBool()) {
+            progress = [this, id](unsigned int, const Engine::SearchInfo& info) {
+                JsonValue reply;
+                reply["type"] = "info";
+                reply["id"] = id;
+                reply["depth"] = info.depth;
+                reply["score"] = info.score;
+                reply["nodes"] = info.nodes;
+                reply["nps"] = info.nodesPerSecond;
+                if (!info.lines.empty())
+                    reply["pv"] = toJson(info.lines.front().moves);
+                send(reply);
+            };
+        }
+
+        auto session = analysis.session;
+        // Held until the id is stored, the result callback removes it.
+        std::lock_guard<std::mutex> lock(m_idsMutex);
+        auto poolId = m_pool.submit(
+            std::move(analysis),
+            [this, id, session](unsigned int poolId, const EngineWorker::Result& result) {
+                sendResult(id, session, result);
+                std::lock_guard<std::mutex> lock(m_idsMutex);
+                m_poolIds.erase(poolId);
+            },
+            std::move(progress));
+        m_poolIds.emplace(poolId, id.toString());
+    }
+
+    void stop(const JsonValue& request)
+    {
+        if (auto session = request.find("session")) {
+            m_pool.stopSession(session->getString());
+            return;
+        }
+
+        auto id = getId(request).toString();
+        std::vector<unsigned int> stopped;
+        {
+            std::lock_guard<std::mutex> lock(m_idsMutex);
+            for (const auto& [poolId, clientId] : m_poolIds) {
+                if (clientId == id)
+                    stopped.push_back(poolId);
+            }
+        }
+        for (auto poolId : stopped)
+            m_pool.stop(poolId);
+    }
+
+    void sendResult(const JsonValue& id, const std::string& session,
+                    const EngineWorker::Result& result)
+    {
+        JsonValue reply;
+        reply["type"] = "result";
+        reply["id"] = id;
+        reply["session"] = session;
+        reply["bestmove"] = result.move.has_value() ? JsonValue(Notation::moveToUci(*result.move))
+                                                    : JsonValue();
+        reply["ponder"] = result.ponderMove.has_value()
+                              ? JsonValue(Notation::moveToUci(*result.ponderMove))
+                              : JsonValue();
+        reply["depth"] = result.depth;
+        reply["score"] = result.statistics.score;
+        reply["nodes"] = result.statistics.nodes + result.statistics.quiescenceNodes;
+        reply["time"] = static_cast<int64_t>(result.statistics.time.count());
+        reply["stopped"] = result.stopped;
+        reply["checkmate"] = result.statistics.checkmate;
+        reply["stalemate"] = result.statistics.stalemate;
+        JsonValue lines{JsonValue::Array()};
+        for (const auto& line : result.lines) {
+            JsonValue jsonLine;
+            jsonLine["score"] = line.score;
+            jsonLine["pv"] = toJson(line.moves);
+            lines.push(std::move(jsonLine));
+        }
+        reply["lines"] = std::move(lines);
+        send(reply);
+    }
+
+    void sendStatistics()
+    {
+        auto statistics = m_pool.getStatistics();
+        JsonValue reply;
+        reply["type"] = "stats";
+        reply["threads"] = m_pool.getThreads();
+        reply["completed"] = statistics.completed;
+        reply["running"] = static_cast<uint64_t>(statistics.running);
+        reply["queued"] = static_cast<uint64_t>(statistics.queued);
+        reply["analysesPerSecond"] = statistics.analysesPerSecond;
+        send(reply);
+    }
+
+    void sendError(const JsonValue& id, const std::string& message)
+    {
+        JsonValue reply;
+        reply["type"] = "error";
+        reply["id"] = id;
+        reply["message"] = message;
+        send(reply);
+    }
+
+    /**
+     * Called from worker threads, lines must not interleave.
+     */
+    void send(const JsonValue& reply)
+    {
+        auto line = reply.toString();
+        std::lock_guard<std::mutex> lock(m_outputMutex);
+        std::cout << line << std::endl;
+    }
+
+private:
+    std::mutex m_outputMutex;
+    std::mutex m_idsMutex;
+    /**
+     * Client id (as JSON text) of every running or queued analysis, for stop by id.
+     */
+    std::map<unsigned int, std::string> m_poolIds;
+    /**
+     * Destroyed first, callbacks of stopped analyses still send their results.
+     */
+    AnalysisPool m_pool;
+};
+
+} // namespace
+
+} // namespace chessAi
+
+int main(int argc, char** argv)
+{
+    using namespace chessAi;
+
+    // Standard output carries the protocol, engine logs would corrupt it.
+    Logger::Init();
+    Logger::getLogger()->set_level(spdlog::level::off);
+
+    std::optional<Options> options;
+    try {
+        options = parseOptions(argc, argv);
+    }
+    catch (const std::exception&) {
+        options.reset();
+    }
+    if (!options.has_value()) {
+        std::cerr << "Usage: analysis_server [--threads n] [--eval-cache mb] [--book 0|1]\n";
+        return 1;
+    }
+
+    Server server(*options);
+    std::string line;
+    while (std::getline(std::cin, line)) {
+        if (!server.handleLine(line)) {
+            server.stopAll();
+            return 0;
+        }
+    }
+    server.wait();
+    return 0;
+}
@@ -0,0 +1,332 @@
+/**
+ * Compares two benchmark result files and reports regressions, so 2-3 % slowdowns are found
+ * automatically instead of by reading logs.
+ *
+ * Usage: benchmark_compare <baseline JSON> <new JSON> [options]
+ *   --threshold <p>  Smallest relative change in percent reported as a regression or improvement
+ *                    (default 2).
+ *   --sigma <z>      Change must also exceed z standard errors of the difference of the means,
+ *                    estimated from the samples of both files (default 2).
+ *
+ * Reads results of performance_tests (BenchmarkReport JSON) and Google Benchmark JSON of
+ * micro_benchmarks (every repetition is a sample, items per second or CPU time are compared).
+ * Changes above the threshold but within the noise are reported as noise. Metrics with a single
+ * sample in both files have no noise estimate and are judged by the threshold only.
+ *
+ * Exit code is 1 if any metric regressed, 2 if a file couldn't be read.
+ */
+
+#include "core/Json.h"
+
+#include <cmath>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <sstream>
+
+namespace chessAi
+{
+
+namespace
+{
+
+struct Options
+{
+    std::string baseline;
+    std::string current;
+    double threshold = 0.02;
+    double sigma = 2.0;
+};
+
+std::optional<Options> parseOptions(int argc, char** argv)
+{
+    if (argc < 3 || argc % 2 != 1)
+        return {};
+
+    Options options;
+    options.baseline = argv[1];
+    options.current = argv[2];
+    for (int i = 3; i + 1 < argc; i += 2) {
+        std::string option = argv[i];
+        std::string value = argv[i + 1];
+        if (option == "--threshold")
+            options.threshold = std::stod(value) / 100.0;
+        else if (option == "--sigma")
+            options.sigma = std::stod(value);
+        else
+            return {};
+    }
+    if (options.threshold < 0.0 || options.sigma < 0.0)
+        return {};
+    return options;
+}
+
+struct Metric
+{
+    std::vector<double> samples;
+    std::string unit;
+    bool higherIsBetter = true;
+
+    double getMean() const
+    {
+        double sum = 0.0;
+        for (auto sample : samples)
+            sum += sample;
+        return sum / static_cast<double>(samples.size());
+    }
+
+    /**
+     * Sample variance, 0 for a single sample.
+     */
+    double getVariance() const
+    {
+        if (samples.size() < 2)
+            return 0.0;
+        auto mean = getMean();
+        double sum = 0.0;
+        for (auto sample : samples)
+            sum += (sample - mean) * (sample - mean);
+        return sum / static_cast<double>(samples.size() - 1);
+    }
+};
+
+/**
+ * Member of the object, null if missing.
+ */
+const JsonValue& getMember(const JsonValue& object, const std::string& key)
+{
+    static const JsonValue null;
+    const auto* member = object.find(key);
+    return member != nullptr ? *member : null;
+}
+
+struct Results
+{
+    JsonValue context;
+    /**
+     * Keyed by "<benchmark>/<metric>".
+     */
+    std::map<std::string, Metric> metrics;
+};
+
+void loadBenchmarkReport(const JsonValue& benchmarks, Results& results)
+{
+    for (const auto& [benchmark, metrics] : benchmarks.getObject()) {
+        for (const auto& [name, value] : metrics.getObject()) {
+            Metric metric;
+            for (const auto& sample : getMember(value, "samples").getArray()) {
+                if (sample.isNumber())
+                    metric.samples.push_back(sample.getNumber());
+            }
+            metric.unit = getMember(value, "unit").getString();
+            metric.higherIsBetter = getMember(value, "higher_is_better").getBool(true);
+            if (!metric.samples.empty())
+                results.metrics[benchmark + "/" + name] = std::move(metric);
+        }
+    }
+}
+
+void loadGoogleBenchmark(const JsonValue& benchmarks, Results& results)
+{
+    for (const auto& run : benchmarks.getArray()) {
+        // Aggregates (mean, median, stddev) are computed here from the repetitions.
+        if (getMember(run, "run_type").getString("iteration") != "iteration" ||
+            getMember(run, "error_occurred").getBool(false))
+            continue;
+
+        auto name = getMember(run, "run_name").getString(getMember(run, "name").getString());
+        // Items per second of benchmarks that count them, CPU time otherwise (not both, they
+        // are the same measurement).
+        if (getMember(run, "items_per_second").isNumber()) {
+            auto& metric = results.metrics[name + "/items_per_second"];
+            metric.samples.push_back(getMember(run, "items_per_second").getNumber());
+            metric.unit = "items/s";
+        }
+        else if (getMember(run, "cpu_time").isNumber()) {
+            auto& metric = results.metrics[name + "/cpu_time"];
+            metric.samples.push_back(getMember(run, "cpu_time").getNumber());
+            metric.unit = getMember(run, "time_unit").getString("ns");
+            metric.higherIsBetter = false;
+        }
+    }
+}
+
+std::optional<Results> load(const std::string& path)
+{
+    std::ifstream file(path);
+    if (!file) {
+        std::cerr << "File " << path << " couldn't be opened.\n";
+        return {};
+    }
+    std::stringstream text;
+    text << file.rdbuf();
+
+    auto json = JsonValue::parse(text.str());
+    if (!json.has_value() || !json->isObject()) {
+        std::cerr << "File " << path << " is not valid JSON.\n";
+        return {};
+    }
+
+    Results results;
+    results.context = getMember(*json, "context");
+    const auto& benchmarks = getMember(*json, "benchmarks");
+    if (benchmarks.isObject())
+        loadBenchmarkReport(benchmarks, results);
+    else if (benchmarks.isArray())
+        loadGoogleBenchmark(benchmarks, results);
+    else {
+        std::cerr << "File " << path << " has no benchmarks.\n";
+        return {};
+    }
+    return results;
+}
+
+/**
+ * Prints build and machine of both files, results of different ones are not comparable.
+ */
+void printContext(const JsonValue& baseline, const JsonValue& current)
+{
+    for (const auto* key : {"commit", "compiler", "build_type", "flags", "cpu"}) {
+        auto before = getMember(baseline, key).getString("unknown");
+        auto after = getMember(current, key).getString("unknown");
+        if (before == after) {
+            std::cout << key << ": " << before << '\n';
+            continue;
+        }
+        std::cout << key << ": " << before << " -> " << after << '\n';
+        if (std::string(key) != "commit")
+            std::cout << "Warning: " << key << " differs, changes may not come from the code.\n";
+    }
+    std::cout << '\n';
+}
+
+enum class Verdict
+{
+    Unchanged,
+    Noise,
+    Improvement,
+    Regression
+};
+
+const char* toString(Verdict verdict)
+{
+    switch (verdict) {
+    case Verdict::Unchanged:
+        return "ok";
+    case Verdict::Noise:
+        return "noise";
+    case Verdict::Improvement:
+        return "improvement";
+    default:
+        return "REGRESSION";
+    }
+}
+
+/**
+ * @param change Relative change of the mean, positive is better.
+ * @param noise Relative standard error of the difference of the means.
+ */
+Verdict getVerdict(double change, double noise, const Options& options)
+{
+    if (std::abs(change) < options.threshold)
+        return Verdict::Unchanged;
+    if (std::abs(change) <= options.sigma * noise)
+        return Verdict::Noise;
+    return change > 0.0 ? Verdict::Improvement : Verdict::Regression;
+}
+
+std::string formatPercent(double value)
+{
+    // No "-0.00 %" for changes that round to zero.
+    if (std::abs(value) < 5e-5)
+        value = 0.0;
+    std::ostringstream text;
+    text << std::showpos << std::fixed << std::setprecision(2) << value * 100.0 << " %";
+    return text.str();
+}
+
+/**
+ * @return Number of regressions.
+ */
+size_t compare(const Results& baseline, const Results& current, const Options& options)
+{
+    std::cout << std::left << std::setw(56) << "metric" << std::right << std::setw(14) << "baseline"
+              << std::setw(14) << "new" << std::setw(11) << "change" << std::setw(10) << "noise"
+              << "  verdict\n";
+
+    size_t regressions = 0;
+    for (const auto& [name, before] : baseline.metrics) {
+        auto it = current.metrics.find(name);
+        if (it == current.metrics.end()) {
+            std::cout << std::left << std::setw(56) << name << " only in baseline\n";
+            continue;
+        }
+        const auto& after = it->second;
+
+        auto beforeMean = before.getMean();
+        auto afterMean = after.getMean();
+        std::cout << std::left << std::setw(56) << name << std::right << std::setw(14)
+                  << beforeMean << std::setw(14) << afterMean;
+        if (beforeMean == 0.0) {
+            std::cout << "  (baseline is 0)\n";
+            continue;
+        }
+
+        auto change = (afterMean - beforeMean) / std::abs(beforeMean);
+        if (!before.higherIsBetter)
+            change = -change;
+        auto noise = std::sqrt(before.getVariance() / static_cast<double>(before.samples.size()) +
+                               after.getVariance() / static_cast<double>(after.samples.size())) /
+                     std::abs(beforeMean);
+        auto verdict = getVerdict(change, noise, options);
+        regressions += verdict == Verdict::Regression;
+
+        // Printed change is better (+) or worse (-), not the sign of the difference.
+        std::cout << std::setw(11) << formatPercent(change) << std::setw(10)
+                  << formatPercent(noise).substr(1) << "  " << toString(verdict);
+        if (before.samples.size() < 2 && after.samples.size() < 2)
+            std::cout << " (1 sample)";
+        std::cout << '\n';
+    }
+
+    for (const auto& [name, metric] : current.metrics) {
+        if (baseline.metrics.count(name) == 0)
+            std::cout << std::left << std::setw(56) << name << " only in new\n";
+    }
+    return regressions;
+}
+
+} // namespace
+
+} // namespace chessAi
+
+int main(int argc, char** argv)
+{
+    using namespace chessAi;
+
+    std::optional<Options> options;
+    try {
+        options = parseOptions(argc, argv);
+    }
+    catch (const std::exception&) {
+        options.reset();
+    }
+    if (!options.has_value()) {
+        std::cerr << "Usage: benchmark_compare <baseline JSON> <new JSON> [--threshold percent] "
+                     "[--sigma z]\n";
+        return 2;
+    }
+
+    auto baseline = load(options->baseline);
+    auto current = load(options->current);
+    if (!baseline.has_value() || !current.has_value())
+        return 2;
+
+    printContext(baseline->context, current->context);
+    std::cout << std::setprecision(6);
+    auto regressions = compare(*baseline, *current, *options);
+    std::cout << '\n' << regressions << " regression(s), threshold "
+              << options->threshold * 100.0 << " %, " << options->sigma << " sigma.\n";
+    return regressions > 0 ? 1 : 0;
+}
@@ -0,0 +1,95 @@
+/**
+ * Generates endgame bitbases (see core/Bitbase.h) for all materials with up to 4 pieces.
+ *
+ * Usage: bitbase_generator <output directory> [options]
+ *   --pieces <n>  Maximum number of pieces, kings included, 3 or 4 (default 4).
+ *   --threads <n> Number of threads (default hardware concurrency).
+ *
+ * Bitbases are generated in order, each from the ones before it (captures and promotions).
+ * Bitbases already in the output directory are loaded instead of generated again, so generation
+ * can be interrupted and continued. Files which can't be loaded are generated again. Copy the
+ * directory to bitbases/ next to chess_ai to use them in search.
+ */
+
+#include "core/BitbaseGenerator.h"
+
+#include <chrono>
+#include <filesystem>
+#include <iostream>
+#include <thread>
+
+int main(int argc, char** argv)
+{
+    using namespace chessAi;
+
+    Logger::Init();
+
+    if (argc < 2 || argc % 2 != 0) {
+        std::cerr << "Usage: bitbase_generator <output directory> [--pieces n] [--threads n]\n";
+        return 1;
+    }
+
+    std::string directory = argv[1];
+    unsigned int pieces = Bitbase::maxPieces;
+    unsigned int threads = std::max(1u, std::thread::hardware_concurrency());
+    try {
+        for (int i = 2; i + 1 < argc; i += 2) {
+            std::string option = argv[i];
+            auto value = static_cast<unsigned int>(std::stoul(argv[i + 1]));
+            if (option == "--pieces")
+                pieces = std::clamp(value, 3u, Bitbase::maxPieces);
+            else if (option == "--threads")
+                threads = std::max(1u, value);
+            else
+                throw std::invalid_argument(option);
+        }
+    }
+    catch (const std::exception&) {
+        std::cerr << "Usage: bitbase_generator <output directory> [--pieces n] [--threads n]\n";
+        return 1;
+    }
+
+    std::error_code error;
+    std::filesystem::create_directories(directory, error);
+    if (error) {
+        CHESS_LOG_ERROR("Couldn't create directory {}: {}", directory, error.message());
+        return 1;
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    Bitbases bitbases;
+    for (const auto& name : BitbaseGenerator::getNames(pieces)) {
+        auto path = (std::filesystem::path(directory) / (name + ".bbs")).string();
+        if (std::filesystem::exists(path)) {
+            auto bitbase = Bitbase::load(path);
+            if (bitbase.has_value()) {
+                bitbases.add(std::move(*bitbase));
+                continue;
+            }
+            CHESS_LOG_WARN("Bitbase {} couldn't be loaded, it is generated again.", path);
+        }
+
+        auto bitbaseStart = std::chrono::steady_clock::now();
+        auto bitbase = BitbaseGenerator::generate(name, bitbases, threads);
+        if (!bitbase.has_value() || !bitbase->save(path))
+            return 1;
+
+        size_t wins = 0;
+        size_t losses = 0;
+        for (size_t index = 0; index < bitbase->size(); ++index) {
+            auto result = bitbase->getResult(index);
+            wins += result == Bitbase::Result::Win;
+            losses += result == Bitbase::Result::Loss;
+        }
+        auto milliseconds = std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::steady_clock::now() - bitbaseStart);
+        CHESS_LOG_INFO("{}: {} positions, {} wins, {} losses, {} ms.", name, bitbase->size(), wins,
+                       losses, milliseconds.count());
+        bitbases.add(std::move(*bitbase));
+    }
+
+    auto seconds = std::chrono::duration_cast<std::chrono::seconds>(
+        std::chrono::steady_clock::now() - start);
+    CHESS_LOG_INFO("{} bitbases in {} after {} s.", bitbases.size(), directory, seconds.count());
+    return 0;
+}
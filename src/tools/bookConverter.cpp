@@ -0,0 +1,115 @@
+/**
+ * Converts a CSV book (one game per line, moves in UCI notation separated by commas) to the
+ * binary opening book format (see core/OpeningBook.h).
+ *
+ * Usage: book_converter <input csv> <output book> [--max-ply <n>]
+ *   --max-ply <n> Only the first n half moves of every game are stored (default 30).
+ *
+ * Every position reached in the games gets an entry per move played from it, weighted by the
+ * number of games the move was played in. Moves are checked for legality while the games are
+ * replayed, a game is cut at the first illegal move. CSV games have no results, so all moves get
+ * the same score (see BookEntry::getScore).
+ */
+
+#include "core/BookBuilder.h"
+#include "core/Notation.h"
+#include "core/PieceBitBoards.h"
+
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+namespace chessAi
+{
+
+namespace
+{
+
+struct Options
+{
+    std::string inputPath;
+    std::string outputPath;
+    unsigned maxPly = 30;
+};
+
+std::optional<Options> parseOptions(int argc, char** argv)
+{
+    if (argc != 3 && argc != 5)
+        return {};
+
+    Options options;
+    options.inputPath = argv[1];
+    options.outputPath = argv[2];
+    if (argc == 5) {
+        if (std::string(argv[3]) != "--max-ply")
+            return {};
+        options.maxPly = static_cast<unsigned>(std::stoul(argv[4]));
+    }
+    return options;
+}
+
+} // namespace
+
+} // namespace chessAi
+
+int main(int argc, char** argv)
+{
+    using namespace chessAi;
+
+    std::optional<Options> options;
+    try {
+        options = parseOptions(argc, argv);
+    }
+    catch (const std::exception&) {
+        options.reset();
+    }
+    if (!options.has_value()) {
+        std::cerr << "Usage: book_converter <input csv> <output book> [--max-ply n]\n";
+        return 1;
+    }
+
+    std::ifstream file(options->inputPath);
+    if (!file.is_open()) {
+        CHESS_LOG_ERROR("Couldn't open {}.", options->inputPath);
+        return 1;
+    }
+
+    BookBuilder builder;
+    size_t games = 0;
+    size_t illegalMoves = 0;
+
+    std::string line;
+    while (std::getline(file, line)) {
+        if (line.empty())
+            continue;
+        ++games;
+
+        PieceBitBoards bitBoards;
+        std::istringstream stream(line);
+        std::string notation;
+        for (unsigned ply = 0; ply < options->maxPly; ++ply) {
+            if (!std::getline(stream, notation, ','))
+                break;
+            if (!notation.empty() && notation.back() == '\r')
+                notation.pop_back();
+
+            auto move = Notation::uciToMove(notation, bitBoards);
+            if (!move.has_value()) {
+                ++illegalMoves;
+                break;
+            }
+
+            builder.addMove(bitBoards.zobristKey, *move, bitBoards.currentMoveColor);
+            bitBoards.applyMove(*move);
+        }
+    }
+
+    if (illegalMoves > 0)
+        CHESS_LOG_WARN("{} games cut at an illegal or unreadable move.", illegalMoves);
+
+    if (!OpeningBook::writeBook(options->outputPath, builder.getEntries()))
+        return 1;
+
+    CHESS_LOG_INFO("Converted {} games to {} book entries.", games, builder.getNumberOfMoves());
+    return 0;
+}
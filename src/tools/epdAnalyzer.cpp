@@ -0,0 +1,273 @@
+/**
+ * Analyses all positions of an EPD (or FEN per line) file in parallel and scores test suites.
+ *
+ * Usage: epd_analyzer <EPD file> [options]
+ *   --threads <n>    Number of engine workers, one search per worker (default hardware
+ *                    concurrency).
+ *   --depth <n>      Search depth (default 100).
+ *   --nodes <n>      Search node limit (default none).
+ *   --time <ms>      Search time limit (default 1000, none if depth or nodes is set).
+ *   --format <f>     csv or json (JSON object per line), default csv.
+ *   --output <path>  Results file (default standard output).
+ *   --clear-hash <n> Clear the transposition table before every position, so results don't
+ *                    depend on the order and number of threads (default 1).
+ *   --trace <path>   Chrome trace of the profiling zones of all searches (build with the
+ *                    CHESS_PROFILING CMake option).
+ *
+ * Results are written in the order of the file: id, FEN, best move, score, depth, nodes, time,
+ * principal variation and, for positions with "bm" or "am" operations, whether the best move
+ * solves them. Summary (solved positions, positions per second) is printed to the standard error.
+ */
+
+#include "core/AnalysisPool.h"
+#include "core/EpdSuite.h"
+#include "core/Fen.h"
+#include "core/Json.h"
+#include "core/Notation.h"
+#include "core/Profiler.h"
+
+#include <fstream>
+#include <iostream>
+#include <optional>
+#include <thread>
+
+namespace chessAi
+{
+
+namespace
+{
+
+struct Options
+{
+    std::string path;
+    unsigned int threads = std::max(1u, std::thread::hardware_concurrency());
+    /**
+     * Empty if not given, search depth is 100 then and node count unlimited.
+     */
+    std::optional<unsigned int> depth;
+    std::optional<uint64_t> nodes;
+    unsigned int time = 0;
+    bool json = false;
+    std::string output;
+    bool clearHash = true;
+    std::string trace;
+};
+
+std::optional<Options> parseOptions(int argc, char** argv)
+{
+    if (argc < 2 || argc % 2 != 0)
+        return {};
+
+    Options options;
+    options.path = argv[1];
+    for (int i = 2; i + 1 < argc; i += 2) {
+        std::string option = argv[i];
+        std::string value = argv[i + 1];
+        if (option == "--threads")
+            options.threads = std::max(1u, static_cast<unsigned int>(std::stoul(value)));
+        else if (option == "--depth")
+            options.depth = static_cast<unsigned int>(std::stoul(value));
+        else if (option == "--nodes")
+            options.nodes = std::stoull(value);
+        else if (option == "--time")
+            options.time = static_cast<unsigned int>(std::stoul(value));
+        else if (option == "--format" && (value == "csv" || value == "json"))
+            options.json = value == "json";
+        else if (option == "--output")
+            options.output = value;
+        else if (option == "--clear-hash")
+            options.clearHash = std::stoul(value) != 0;
+        else if (option == "--trace")
+            options.trace = value;
+        else
+            return {};
+    }
+
+    // Default time limit only if no other limit was given.
+    if (options.time == 0 && !options.depth.has_value() && !options.nodes.has_value())
+        options.time = 1000;
+    return options;
+}
+
+std::string toUci(const std::vector<Move>& moves)
+{
+    std::string text;
+    for (const auto& move : moves) {
+        if (!text.empty())
+            text += ' ';
+        text += Notation::moveToUci(move);
+    }
+    return text;
+}
+
+/**
+ * Empty if the position has no expected moves.
+ */
+std::string getSolved(const EpdSuite::Position& position, const EngineWorker::Result& result)
+{
+    if (!position.hasExpectedMoves())
+        return "";
+    return (result.move.has_value() && position.isSolvedBy(*result.move)) ? "1" : "0";
+}
+
+/**
+ * Field in quotes, quotes in it are doubled (RFC 4180), so commas and quotes are kept.
+ */
+std::string quoteCsv(std::string_view field)
+{
+    std::string quoted = "\"";
+    for (char c : field) {
+        if (c == '"')
+            quoted += '"';
+        quoted += c;
+    }
+    quoted += '"';
+    return quoted;
+}
+
+void writeCsvHeader(std::ostream& out)
+{
+    out << "id,fen,bestmove,score,depth,nodes,time_ms,pv,expected,solved\n";
+}
+
+void writeCsv(std::ostream& out, const EpdSuite::Position& position,
+              const EngineWorker::Result& result)
+{
+    const auto& statistics = result.statistics;
+    std::string expected = toUci(position.bestMoves);
+    if (!position.avoidMoves.empty())
+        expected += (expected.empty() ? "!" : " !") + toUci(position.avoidMoves);
+    std::string pv = result.lines.empty() ? "" : toUci(result.lines.front().moves);
+
+    // Ids may contain commas and quotes.
+    out << quoteCsv(position.id) << ',' << Fen::toString(position.bitBoards) << ','
+        << (result.move.has_value() ? Notation::moveToUci(*result.move) : "") << ','
+        << statistics.score << ',' << result.depth << ','
+        << statistics.nodes + statistics.quiescenceNodes << ',' << statistics.time.count() << ','
+        << pv << ',' << expected << ',' << getSolved(position, result) << '\n';
+}
+
+void writeJson(std::ostream& out, const EpdSuite::Position& position,
+               const EngineWorker::Result& result)
+{
+    const auto& statistics = result.statistics;
+    JsonValue line;
+    line["id"] = position.id;
+    line["fen"] = Fen::toString(position.bitBoards);
+    line["bestmove"] =
+        result.move.has_value() ? JsonValue(Notation::moveToUci(*result.move)) : JsonValue();
+    line["score"] = statistics.score;
+    line["depth"] = result.depth;
+    line["nodes"] = statistics.nodes + statistics.quiescenceNodes;
+    line["time"] = static_cast<int64_t>(statistics.time.count());
+    line["pv"] = result.lines.empty() ? "" : toUci(result.lines.front().moves);
+    line["checkmate"] = statistics.checkmate;
+    line["stalemate"] = statistics.stalemate;
+    if (position.hasExpectedMoves()) {
+        line["bm"] = toUci(position.bestMoves);
+        line["am"] = toUci(position.avoidMoves);
+        line["solved"] = getSolved(position, result) == "1";
+    }
+    out << line.toString() << '\n';
+}
+
+} // namespace
+
+} // namespace chessAi
+
+int main(int argc, char** argv)
+{
+    using namespace chessAi;
+
+    // Create the logger before worker threads use it. Engine logs every search, only warnings
+    // and errors are shown.
+    Logger::Init();
+    Logger::getLogger()->set_level(spdlog::level::warn);
+
+    std::optional<Options> options;
+    try {
+        options = parseOptions(argc, argv);
+    }
+    catch (const std::exception&) {
+        options.reset();
+    }
+    if (!options.has_value()) {
+        std::cerr << "Usage: epd_analyzer <EPD file> [--threads n] [--depth n] [--nodes n] "
+                     "[--time ms] [--format csv|json] [--output path] [--clear-hash 0|1] "
+                     "[--trace path]\n";
+        return 1;
+    }
+
+    auto positions = EpdSuite::load(options->path);
+    if (!positions.has_value())
+        return 1;
+
+    std::ofstream file;
+    if (!options->output.empty()) {
+        file.open(options->output);
+        if (!file) {
+            CHESS_LOG_ERROR("Output file {} couldn't be opened.", options->output);
+            return 1;
+        }
+    }
+    std::ostream& out = options->output.empty() ? std::cout : file;
+
+#if !CHESS_PROFILING
+    if (!options->trace.empty())
+        CHESS_LOG_WARN("Built without CHESS_PROFILING, trace has no zones.");
+#endif
+
+    auto start = std::chrono::steady_clock::now();
+    std::vector<std::optional<EngineWorker::Result>> results(positions->size());
+    {
+        AnalysisPool pool(options->threads, false);
+        for (size_t i = 0; i < positions->size(); ++i) {
+            AnalysisPool::Analysis analysis;
+            analysis.bitBoards = (*positions)[i].bitBoards;
+            analysis.limits.depth = options->depth.value_or(100);
+            analysis.limits.nodes = options->nodes.value_or(0);
+            analysis.limits.time = std::chrono::milliseconds(
+                options->time > 0 ? options->time : 24u * 3600u * 1000u);
+            analysis.clearHash = options->clearHash;
+            // Every callback writes its own slot, read after wait.
+            pool.submit(std::move(analysis),
+                        [&results, i](unsigned int, const EngineWorker::Result& result) {
+                            results[i] = result;
+                        });
+        }
+        pool.wait();
+    }
+    auto seconds =
+        std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    if (!options->json)
+        writeCsvHeader(out);
+    size_t suitePositions = 0;
+    size_t solved = 0;
+    uint64_t nodes = 0;
+    for (size_t i = 0; i < positions->size(); ++i) {
+        const auto& position = (*positions)[i];
+        const auto& result = *results[i];
+        if (options->json)
+            writeJson(out, position, result);
+        else
+            writeCsv(out, position, result);
+
+        nodes += result.statistics.nodes + result.statistics.quiescenceNodes;
+        if (position.hasExpectedMoves()) {
+            ++suitePositions;
+            solved += getSolved(position, result) == "1";
+        }
+    }
+    out.flush();
+    if (!options->trace.empty() && !Profiler::writeChromeTrace(options->trace))
+        return 1;
+
+    std::cerr << positions->size() << " positions in " << seconds << " s: "
+              << static_cast<double>(positions->size()) / std::max(seconds, 1e-3)
+              << " positions/s, " << static_cast<double>(nodes) / std::max(seconds, 1e-3)
+              << " nodes/s." << std::endl;
+    if (suitePositions > 0)
+        std::cerr << "Solved " << solved << " / " << suitePositions << "." << std::endl;
+    return 0;
+}
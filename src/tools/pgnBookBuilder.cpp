@@ -0,0 +1,394 @@
+/**
+ * Builds the binary opening book (see core/OpeningBook.h) from PGN files.
+ *
+ * Usage: pgn_book_builder [options] <output book> <pgn file>...
+ *   --max-ply <n>   Only the first n half moves of every game are stored (default 30).
+ *   --threads <n>   Number of parsing threads (default hardware concurrency).
+ *   --min-count <n> Moves played in less than n games are left out (default 1).
+ *
+ * PGN files are streamed, never loaded whole: the reading thread splits them into games and
+ * hands batches of games to the parsing threads through a bounded queue, so memory use does not
+ * depend on the size of the input. Each parsing thread replays its games, resolving SAN moves
+ * among the legal moves of the position, and counts moves and game results per position in its
+ * own BookBuilder. Builders are merged at the end.
+ *
+ * Comments, variations, NAGs and move numbers are skipped. Games starting from a FEN tag are
+ * replayed from that position. A game is cut at the first move which is not legal. Result is taken
+ * from the result at the end of the move text, or from the Result tag if it is missing.
+ */
+
+#include "core/BookBuilder.h"
+#include "core/Notation.h"
+#include "core/PieceBitBoards.h"
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <fstream>
+#include <iostream>
+#include <mutex>
+#include <thread>
+
+namespace chessAi
+{
+
+namespace
+{
+
+struct PgnGame
+{
+    std::string fen;
+    std::string result;
+    std::string moveText;
+};
+
+struct PlayedMove
+{
+    uint64_t zobristKey;
+    Move move;
+    PieceColor color;
+};
+
+using GameBatch = std::vector<PgnGame>;
+
+constexpr size_t gamesPerBatch = 512;
+
+/**
+ * Blocking queue with a capacity, so reading can not run ahead of parsing.
+ */
+class BatchQueue
+{
+public:
+    explicit BatchQueue(size_t capacity) : m_capacity(capacity), m_closed(false) {}
+
+    void push(GameBatch batch)
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_notFull.wait(lock, [this]() { return m_batches.size() < m_capacity; });
+        m_batches.push_back(std::move(batch));
+        m_notEmpty.notify_one();
+    }
+
+    /**
+     * @return false If queue is closed and empty.
+     */
+    bool pop(GameBatch& batch)
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_notEmpty.wait(lock, [this]() { return !m_batches.empty() || m_closed; });
+        if (m_batches.empty())
+            return false;
+
+        batch = std::move(m_batches.front());
+        m_batches.pop_front();
+        m_notFull.notify_one();
+        return true;
+    }
+
+    void close()
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_closed = true;
+        m_notEmpty.notify_all();
+    }
+
+private:
+    size_t m_capacity;
+    bool m_closed;
+    std::deque<GameBatch> m_batches;
+    std::mutex m_mutex;
+    std::condition_variable m_notEmpty;
+    std::condition_variable m_notFull;
+};
+
+struct Options
+{
+    std::string outputPath;
+    std::vector<std::string> pgnPaths;
+    unsigned int maxPly = 30;
+    unsigned int threads = std::max(1u, std::thread::hardware_concurrency());
+    uint32_t minCount = 1;
+};
+
+struct Statistics
+{
+    std::atomic<uint64_t> games{0};
+    std::atomic<uint64_t> moves{0};
+    std::atomic<uint64_t> cutGames{0};
+};
+
+/**
+ * Value of a tag line: [FEN "value"].
+ */
+std::string getTagValue(const std::string& line)
+{
+    auto first = line.find('"');
+    auto last = line.rfind('"');
+    if (first == std::string::npos || last <= first)
+        return "";
+    return line.substr(first + 1, last - first - 1);
+}
+
+/**
+ * Splits PGN files into games and pushes them in batches.
+ */
+void readGames(const std::vector<std::string>& paths, BatchQueue& queue)
+{
+    GameBatch batch;
+    PgnGame game;
+
+    auto finishGame = [&]() {
+        if (game.moveText.empty())
+            return;
+        batch.push_back(std::move(game));
+        game = PgnGame();
+        if (batch.size() == gamesPerBatch) {
+            queue.push(std::move(batch));
+            batch = GameBatch();
+        }
+    };
+
+    for (const auto& path : paths) {
+        std::ifstream file(path);
+        if (!file.is_open()) {
+            CHESS_LOG_ERROR("Couldn't open {}.", path);
+            continue;
+        }
+
+        std::string line;
+        while (std::getline(file, line)) {
+            if (!line.empty() && line.back() == '\r')
+                line.pop_back();
+            if (line.empty())
+                continue;
+
+            if (line[0] == '[') {
+                // Tags after move text start a new game.
+                finishGame();
+                if (line.rfind("[FEN ", 0) == 0)
+                    game.fen = getTagValue(line);
+                else if (line.rfind("[Result ", 0) == 0)
+                    game.result = getTagValue(line);
+                continue;
+            }
+            game.moveText += line;
+            game.moveText += '\n';
+        }
+        finishGame();
+    }
+
+    if (!batch.empty())
+        queue.push(std::move(batch));
+    queue.close();
+}
+
+bool isResult(std::string_view token)
+{
+    return token == "1-0" || token == "0-1" || token == "1/2-1/2" || token == "*";
+}
+
+GameResult toGameResult(std::string_view result)
+{
+    if (result == "1-0")
+        return GameResult::WhiteWin;
+    if (result == "0-1")
+        return GameResult::BlackWin;
+    if (result == "1/2-1/2")
+        return GameResult::Draw;
+    return GameResult::Unknown;
+}
+
+/**
+ * Replays move text and adds moves with the game result to the builder.
+ *
+ * @return false If the game was cut at a move which could not be played.
+ */
+bool parseGame(const PgnGame& game, unsigned int maxPly, BookBuilder& builder,
+               uint64_t& addedMoves)
+{
+    PieceBitBoards bitBoards = game.fen.empty() ? PieceBitBoards() : PieceBitBoards(game.fen);
+    std::string_view text = game.moveText;
+
+    // Moves are added once the result is known, result token comes after them.
+    std::vector<PlayedMove> moves;
+    auto result = toGameResult(game.result);
+    bool legal = true;
+
+    size_t i = 0;
+    int variationDepth = 0;
+    while (i < text.size()) {
+        char c = text[i];
+        if (std::isspace(static_cast<unsigned char>(c))) {
+            ++i;
+        }
+        else if (c == '{') {
+            auto end = text.find('}', i);
+            i = (end == std::string_view::npos) ? text.size() : end + 1;
+        }
+        else if (c == ';') {
+            auto end = text.find('\n', i);
+            i = (end == std::string_view::npos) ? text.size() : end + 1;
+        }
+        else if (c == '(') {
+            ++variationDepth;
+            ++i;
+        }
+        else if (c == ')') {
+            --variationDepth;
+            ++i;
+        }
+        else {
+            auto end = i;
+            while (end < text.size() && !std::isspace(static_cast<unsigned char>(text[end])) &&
+                   text[end] != '{' && text[end] != '(' && text[end] != ')' && text[end] != ';')
+                ++end;
+            auto token = text.substr(i, end - i);
+            i = end;
+
+            if (variationDepth > 0 || token[0] == '$')
+                continue;
+            if (isResult(token)) {
+                if (token != "*")
+                    result = toGameResult(token);
+                break;
+            }
+            // Only the result is needed from the rest of the game.
+            if (!legal || moves.size() >= maxPly)
+                continue;
+
+            // Move number, possibly joined with the move (12.e4, 12...Nf6).
+            size_t moveStart = 0;
+            while (moveStart < token.size() &&
+                   (std::isdigit(static_cast<unsigned char>(token[moveStart])) ||
+                    token[moveStart] == '.'))
+                ++moveStart;
+            if (moveStart > 0 && (moveStart == token.size() || token[moveStart - 1] == '.'))
+                token.remove_prefix(moveStart);
+            if (token.empty())
+                continue;
+
+            auto move = Notation::sanToMove(token, bitBoards);
+            if (!move.has_value()) {
+                legal = false;
+                continue;
+            }
+
+            moves.push_back({bitBoards.zobristKey, *move, bitBoards.currentMoveColor});
+            bitBoards.applyMove(*move);
+        }
+    }
+
+    for (const auto& played : moves)
+        builder.addMove(played.zobristKey, played.move, played.color, result);
+    addedMoves += moves.size();
+    return legal;
+}
+
+void parseGames(BatchQueue& queue, unsigned int maxPly, BookBuilder& builder,
+                Statistics& statistics)
+{
+    GameBatch batch;
+    while (queue.pop(batch)) {
+        uint64_t moves = 0;
+        uint64_t cutGames = 0;
+        for (const auto& game : batch) {
+            if (!parseGame(game, maxPly, builder, moves))
+                ++cutGames;
+        }
+        statistics.games += batch.size();
+        statistics.moves += moves;
+        statistics.cutGames += cutGames;
+    }
+}
+
+std::optional<Options> parseOptions(int argc, char** argv)
+{
+    Options options;
+    std::vector<std::string> paths;
+    for (int i = 1; i < argc; ++i) {
+        std::string argument = argv[i];
+        if (argument.rfind("--", 0) != 0) {
+            paths.push_back(argument);
+            continue;
+        }
+        if (i + 1 >= argc)
+            return {};
+
+        auto value = std::stoul(argv[++i]);
+        if (argument == "--max-ply")
+            options.maxPly = static_cast<unsigned int>(value);
+        else if (argument == "--threads")
+            options.threads = std::max(1u, static_cast<unsigned int>(value));
+        else if (argument == "--min-count")
+            options.minCount = static_cast<uint32_t>(value);
+        else
+            return {};
+    }
+
+    if (paths.size() < 2)
+        return {};
+    options.outputPath = paths[0];
+    options.pgnPaths.assign(paths.begin() + 1, paths.end());
+    return options;
+}
+
+} // namespace
+
+} // namespace chessAi
+
+int main(int argc, char** argv)
+{
+    using namespace chessAi;
+
+    // Create the logger before worker threads use it.
+    Logger::Init();
+
+    std::optional<Options> options;
+    try {
+        options = parseOptions(argc, argv);
+    }
+    catch (const std::exception&) {
+        options.reset();
+    }
+    if (!options.has_value()) {
+        std::cerr << "Usage: pgn_book_builder [--max-ply n] [--threads n] [--min-count n] "
+                     "<output book> <pgn file>...\n";
+        return 1;
+    }
+
+    auto start = std::chrono::steady_clock::now();
+
+    BatchQueue queue(2 * options->threads);
+    Statistics statistics;
+    std::vector<BookBuilder> builders(options->threads);
+    std::vector<std::thread> workers;
+    for (auto& builder : builders) {
+        workers.emplace_back(parseGames, std::ref(queue), options->maxPly, std::ref(builder),
+                             std::ref(statistics));
+    }
+
+    readGames(options->pgnPaths, queue);
+    for (auto& worker : workers)
+        worker.join();
+
+    for (size_t i = 1; i < builders.size(); ++i)
+        builders[0].merge(builders[i]);
+
+    auto entries = builders[0].getEntries(options->minCount);
+    if (!OpeningBook::writeBook(options->outputPath, entries))
+        return 1;
+
+    auto time = std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now() - start);
+    if (statistics.cutGames > 0)
+        CHESS_LOG_WARN("{} games cut at a move which could not be played.",
+                       statistics.cutGames.load());
+    CHESS_LOG_INFO("{} games, {} moves replayed in {} ms with {} threads ({:.0f} games/s).",
+                   statistics.games.load(), statistics.moves.load(), time.count(),
+                   options->threads,
+                   1000.0 * static_cast<double>(statistics.games) /
+                       static_cast<double>(std::max<int64_t>(1, time.count())));
+    CHESS_LOG_INFO("Book {} written with {} entries.", options->outputPath, entries.size());
+    return 0;
+}
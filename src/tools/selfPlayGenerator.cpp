@@ -0,0 +1,282 @@
+/**
+ * Generates training data (see core/TrainingData.h) from self-play games.
+ *
+ * Usage: selfplay_generator <output prefix> [options]
+ *   --shards <n>          Number of shards to generate (default 8).
+ *   --games-per-shard <n> Games in one shard (default 100).
+ *   --threads <n>         Number of threads playing games (default hardware concurrency).
+ *   --depth <n>           Search depth of every move (default 4, 100 with --nodes).
+ *   --nodes <n>           Search node limit of every move (default none).
+ *   --random-plies <n>    Random moves at the start of every game (default 8).
+ *   --max-plies <n>       Games longer than this are adjudicated as draw (default 400).
+ *   --adjudicate <score>  Game is won when the score stays above this for 6 plies (default 2000,
+ *                         0 disables).
+ *   --seed <n>            Base seed of the random openings (default 1).
+ *
+ * Shards are independent: each thread takes the next missing shard and plays its games with an
+ * engine of its own, which starts every shard with an empty transposition table. Openings of a
+ * shard only depend on the seed and shard index, so running the generator again with the same
+ * options skips the shards already written and generates only the missing ones.
+ *
+ * Every searched position is stored with the search score, the best move and the game result.
+ */
+
+#include "core/Engine.h"
+#include "core/EndOfGameChecker.h"
+#include "core/Evaluate.h"
+#include "core/MoveGenerator.h"
+#include "core/OpeningBook.h"
+#include "core/TrainingData.h"
+
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <random>
+#include <thread>
+
+namespace chessAi
+{
+
+namespace
+{
+
+struct Options
+{
+    std::string prefix;
+    unsigned int shards = 8;
+    unsigned int gamesPerShard = 100;
+    unsigned int threads = std::max(1u, std::thread::hardware_concurrency());
+    unsigned int depth = 0;
+    uint64_t nodes = 0;
+    unsigned int randomPlies = 8;
+    unsigned int maxPlies = 400;
+    int adjudicateScore = 2000;
+    uint32_t seed = 1;
+};
+
+struct Statistics
+{
+    std::atomic<uint64_t> games{0};
+    std::atomic<uint64_t> positions{0};
+    std::atomic<unsigned int> shards{0};
+};
+
+constexpr unsigned int adjudicatePlies = 6;
+
+/**
+ * Plays random legal moves from the starting position.
+ *
+ * @return false If the game ended during the random moves.
+ */
+bool playRandomOpening(PieceBitBoards& bitBoards, std::vector<uint64_t>& history,
+                       unsigned int plies, std::mt19937& random)
+{
+    for (unsigned int ply = 0; ply < plies; ++ply) {
+        auto moves = MoveGeneratorWrapper::generateLegalMoves<MoveType::Normal>(bitBoards);
+        if (moves.empty())
+            return false;
+
+        std::uniform_int_distribution<size_t> distribution(0, moves.size() - 1);
+        bitBoards.applyMove(moves[distribution(random)]);
+        history.push_back(bitBoards.zobristKey);
+    }
+    return true;
+}
+
+bool isRepetition(const std::vector<uint64_t>& history)
+{
+    return std::count(history.begin(), history.end(), history.back()) >= 3;
+}
+
+/**
+ * Only kings left.
+ */
+bool isBareKings(const PieceBitBoards& bitBoards)
+{
+    return bitBoards.getAllPiecesBoard() == (bitBoards.whiteKing | bitBoards.blackKing);
+}
+
+/**
+ * Plays one game and appends its positions to samples.
+ */
+void playGame(Engine& engine, const Options& options, uint32_t gameIndex, std::mt19937& random,
+              std::vector<TrainingSample>& samples)
+{
+    PieceBitBoards bitBoards;
+    std::vector<uint64_t> history;
+    do {
+        bitBoards = PieceBitBoards();
+        history = {bitBoards.zobristKey};
+    } while (!playRandomOpening(bitBoards, history, options.randomPlies, random));
+
+    auto firstSample = samples.size();
+    // Result from the view of white.
+    auto whiteResult = TrainingData::Draw;
+    unsigned int winningPlies = 0;
+    int lastScore = 0;
+
+    for (unsigned int ply = 0; ply < options.maxPlies; ++ply) {
+        auto endOfGame = EndOfGameChecker::checkBoardState(bitBoards);
+        if (endOfGame == EndOfGameType::Checkmate) {
+            whiteResult = (bitBoards.currentMoveColor == PieceColor::White) ? TrainingData::Loss
+                                                                             : TrainingData::Win;
+            break;
+        }
+        if (endOfGame == EndOfGameType::Stalemate || isRepetition(history) ||
+            isBareKings(bitBoards))
+            break;
+
+        auto [move, depth] = engine.findBestMove(bitBoards, history);
+        if (!move.has_value())
+            break;
+        auto score = engine.getSearchStatistics().score;
+
+        TrainingSample sample;
+        sample.position = *PackedPosition::pack(bitBoards);
+        sample.position.score = static_cast<int16_t>(std::clamp(score, -32000, 32000));
+        sample.move = OpeningBook::encodeMove(*move);
+        sample.depth = static_cast<uint16_t>(depth);
+        sample.game = gameIndex;
+        samples.push_back(sample);
+
+        // Both sides agree one of them is winning (scores alternate sign between plies).
+        if (options.adjudicateScore > 0 && std::abs(score) >= options.adjudicateScore &&
+            (winningPlies == 0 || (score > 0) != (lastScore > 0)))
+            winningPlies++;
+        else
+            winningPlies = 0;
+        lastScore = score;
+        if (winningPlies >= adjudicatePlies) {
+            bool whiteWins = (score > 0) == (bitBoards.currentMoveColor == PieceColor::White);
+            whiteResult = whiteWins ? TrainingData::Win : TrainingData::Loss;
+            break;
+        }
+
+        bitBoards.applyMove(*move);
+        history.push_back(bitBoards.zobristKey);
+    }
+
+    // Results are stored from the view of the side to move.
+    for (auto i = firstSample; i < samples.size(); ++i) {
+        auto& position = samples[i].position;
+        bool whiteToMove = !(position.state & 1);
+        position.result = static_cast<uint8_t>(whiteToMove ? whiteResult
+                                                           : TrainingData::Win - whiteResult);
+    }
+}
+
+void generateShards(const Options& options, const std::vector<unsigned int>& shards,
+                    std::atomic<size_t>& nextShard, Statistics& statistics)
+{
+    Engine engine(false, std::chrono::hours(24), options.depth);
+    engine.setNodeLimit(options.nodes);
+
+    std::vector<TrainingSample> samples;
+    for (auto index = nextShard++; index < shards.size(); index = nextShard++) {
+        auto shard = shards[index];
+        auto path = TrainingData::getShardPath(options.prefix, shard);
+
+        // Searches of a shard don't depend on the shards played before by this thread.
+        engine.newGame();
+        samples.clear();
+        // Openings depend only on the seed and shard index.
+        std::seed_seq seed{options.seed, shard};
+        std::mt19937 random(seed);
+        for (uint32_t game = 0; game < options.gamesPerShard; ++game) {
+            playGame(engine, options, game, random, samples);
+            statistics.games++;
+        }
+
+        if (!TrainingData::writeShard(path, samples))
+            continue;
+        statistics.positions += samples.size();
+        statistics.shards++;
+        std::cout << "Shard " << path << " written with " << samples.size() << " positions."
+                  << std::endl;
+    }
+}
+
+std::optional<Options> parseOptions(int argc, char** argv)
+{
+    if (argc < 2)
+        return {};
+
+    Options options;
+    options.prefix = argv[1];
+    for (int i = 2; i + 1 < argc; i += 2) {
+        std::string option = argv[i];
+        auto value = std::stoul(argv[i + 1]);
+        if (option == "--shards")
+            options.shards = static_cast<unsigned int>(value);
+        else if (option == "--games-per-shard")
+            options.gamesPerShard = static_cast<unsigned int>(value);
+        else if (option == "--threads")
+            options.threads = std::max(1u, static_cast<unsigned int>(value));
+        else if (option == "--depth")
+            options.depth = static_cast<unsigned int>(value);
+        else if (option == "--nodes")
+            options.nodes = value;
+        else if (option == "--random-plies")
+            options.randomPlies = static_cast<unsigned int>(value);
+        else if (option == "--max-plies")
+            options.maxPlies = static_cast<unsigned int>(value);
+        else if (option == "--adjudicate")
+            options.adjudicateScore = static_cast<int>(value);
+        else if (option == "--seed")
+            options.seed = static_cast<uint32_t>(value);
+        else
+            return {};
+    }
+
+    if (options.depth == 0)
+        options.depth = (options.nodes > 0) ? 100 : 4;
+    return options;
+}
+
+} // namespace
+
+} // namespace chessAi
+
+int main(int argc, char** argv)
+{
+    using namespace chessAi;
+
+    // Create the logger before worker threads use it. Engine logs every search, only warnings
+    // and errors are shown, progress is printed to the standard output.
+    Logger::Init();
+    Logger::getLogger()->set_level(spdlog::level::warn);
+
+    std::optional<Options> options;
+    try {
+        options = parseOptions(argc, argv);
+    }
+    catch (const std::exception&) {
+        options.reset();
+    }
+    if (!options.has_value()) {
+        std::cerr << "Usage: selfplay_generator <output prefix> [--shards n] "
+                     "[--games-per-shard n] [--threads n] [--depth n] [--nodes n] "
+                     "[--random-plies n] [--max-plies n] [--adjudicate score] [--seed n]\n";
+        return 1;
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    Statistics statistics;
+    auto shards = TrainingData::getMissingShards(options->prefix, options->shards);
+    std::atomic<size_t> nextShard{0};
+    std::vector<std::thread> threads;
+    for (unsigned int i = 0; i < options->threads; ++i)
+        threads.emplace_back(generateShards, std::cref(*options), std::cref(shards),
+                             std::ref(nextShard), std::ref(statistics));
+    for (auto& thread : threads)
+        thread.join();
+
+    auto seconds =
+        std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    auto positionsPerSecond = static_cast<double>(statistics.positions) / std::max(seconds, 1e-3);
+    std::cout << statistics.shards << " shards, " << statistics.games << " games, "
+              << statistics.positions << " positions in " << seconds << " s: "
+              << positionsPerSecond << " positions/s, "
+              << positionsPerSecond / options->threads << " positions/s per thread." << std::endl;
+    return 0;
+}
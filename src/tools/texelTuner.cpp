@@ -0,0 +1,394 @@
+/**
+ * Texel tuning of the evaluation parameters.
+ * https://www.chessprogramming.org/Texel%27s_Tuning_Method
+ *
+ * Usage: texel_tuner <positions> <output parameters file> [options]
+ *   --epochs <n>     Number of gradient descent iterations (default 200).
+ *   --threads <n>    Number of worker threads (default hardware concurrency).
+ *   --rate <r>       Adam learning rate in centipawns (default 1).
+ *   --initial <file> Start from this parameters file instead of the defaults.
+ *   --sample <n>     Tune on n randomly chosen positions (default all).
+ *   --seed <n>       Seed of the random sample (default 1).
+ *
+ * Positions are read with PositionDataset: a text file where each line holds a FEN (or EPD with
+ * 4 fields) followed by the game result from the white perspective (1-0, 0-1, 1/2-1/2, or 1.0,
+ * 0.5, 0.0, optionally in brackets or quotes), a binary file of training samples (.bin) or a
+ * directory of them (output of selfplay_generator).
+ *
+ * Positions are first resolved to a quiet position with quiescence search, then the evaluation
+ * trace of the quiet position is stored, so the loss and its gradient are computed without
+ * evaluating positions again. Loss, gradient and the initial scaling constant K are computed
+ * in parallel, each thread sums over its own chunk of positions.
+ */
+
+#include "core/Evaluate.h"
+#include "core/MoveGenerator.h"
+#include "core/PositionDataset.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <numeric>
+#include <optional>
+#include <thread>
+
+namespace chessAi
+{
+
+namespace
+{
+
+struct TrainingPosition
+{
+    // Non zero coefficients of the evaluation trace.
+    std::vector<std::pair<uint16_t, float>> coefficients;
+    float constant = 0.f;
+    float result = 0.f;
+};
+
+struct Options
+{
+    std::string positionsPath;
+    std::string outputPath;
+    std::string initialPath;
+    unsigned epochs = 200;
+    unsigned threads = std::max(1u, std::thread::hardware_concurrency());
+    double rate = 1.0;
+    size_t sample = 0;
+    uint64_t seed = 1;
+};
+
+constexpr unsigned quiescenceDepthLimit = 8;
+
+/**
+ * Calls function(begin, end, threadIndex) on equal chunks of [0, count) in parallel.
+ */
+template <typename TFunction>
+void parallelFor(unsigned numberOfThreads, size_t count, const TFunction& function)
+{
+    std::vector<std::thread> threads;
+    size_t chunkSize = (count + numberOfThreads - 1) / numberOfThreads;
+    for (unsigned i = 0; i < numberOfThreads; ++i) {
+        size_t begin = std::min(count, i * chunkSize);
+        size_t end = std::min(count, begin + chunkSize);
+        threads.emplace_back([&function, begin, end, i]() { function(begin, end, i); });
+    }
+    for (auto& thread : threads)
+        thread.join();
+}
+
+/**
+ * Fail hard quiescence search, returns score from the perspective of the current color and sets
+ * leaf to the last position of the principal variation.
+ */
+int quiescence(const PieceBitBoards& boards, int alpha, int beta, unsigned depth,
+               PieceBitBoards& leaf)
+{
+    AttackMaps attackMaps(boards);
+    int standPat = Evaluate::getEvaluation(boards, attackMaps);
+    leaf = boards;
+
+    if (standPat >= beta)
+        return beta;
+    alpha = std::max(alpha, standPat);
+
+    if (depth == 0)
+        return alpha;
+
+    auto captures = MoveGeneratorWrapper::generateLegalMoves<MoveType::Capture>(boards, attackMaps);
+
+    // MVV-LVA
+    auto captureScore = [&boards](const Move& move) {
+        return Evaluate::getFigureValue(
+                   boards.getPieceTypeWithSetBitAtPosition(move.destination).getPieceFigure()) -
+               Evaluate::getFigureValue(
+                   boards.getPieceTypeWithSetBitAtPosition(move.origin).getPieceFigure());
+    };
+    std::sort(captures.begin(), captures.end(), [&captureScore](const Move& a, const Move& b) {
+        return captureScore(a) > captureScore(b);
+    });
+
+    PieceBitBoards childLeaf;
+    for (const auto& move : captures) {
+        auto tempBoards = boards;
+        tempBoards.applyMove(move);
+
+        int score = -quiescence(tempBoards, -beta, -alpha, depth - 1, childLeaf);
+        if (score >= beta)
+            return beta;
+        if (score > alpha) {
+            alpha = score;
+            leaf = childLeaf;
+        }
+    }
+    return alpha;
+}
+
+TrainingPosition createTrainingPosition(const TrainingSample& sample)
+{
+    PieceBitBoards boards;
+    sample.position.unpack(boards);
+    PieceBitBoards leaf;
+    quiescence(boards, Evaluate::negativeInfinity, Evaluate::infinity, quiescenceDepthLimit, leaf);
+
+    auto trace = Evaluate::getEvaluationTrace(leaf);
+
+    // Samples store the result from the view of the side to move, the tuner from white.
+    auto result = sample.position.result;
+    if (boards.currentMoveColor == PieceColor::Black)
+        result = static_cast<uint8_t>(TrainingData::Win - result);
+
+    TrainingPosition position;
+    position.result = static_cast<float>(result) / 2.f;
+    position.constant = trace.constant;
+    for (size_t i = 0; i < trace.coefficients.size(); ++i) {
+        if (trace.coefficients[i] != 0.f)
+            position.coefficients.emplace_back(static_cast<uint16_t>(i), trace.coefficients[i]);
+    }
+    return position;
+}
+
+std::vector<TrainingPosition> loadTrainingPositions(const Options& options)
+{
+    PositionDataset dataset;
+    if (!dataset.open(options.positionsPath))
+        return {};
+
+    // Indices of the used samples, a random subset if sampling.
+    std::vector<size_t> indices;
+    if (options.sample > 0 && options.sample < dataset.size()) {
+        indices = dataset.getShuffledIndices(options.seed);
+        indices.resize(options.sample);
+    }
+    else {
+        indices.resize(dataset.size());
+        std::iota(indices.begin(), indices.end(), 0);
+    }
+
+    auto isLabeled = [&dataset](size_t index) {
+        return dataset[index].position.result <= TrainingData::Win;
+    };
+    auto labeled = std::stable_partition(indices.begin(), indices.end(), isLabeled);
+    if (labeled != indices.end())
+        CHESS_LOG_WARN("Skipped {} positions without a result.", indices.end() - labeled);
+    indices.erase(labeled, indices.end());
+
+    std::vector<TrainingPosition> positions(indices.size());
+    parallelFor(options.threads, indices.size(), [&](size_t begin, size_t end, unsigned) {
+        for (size_t i = begin; i < end; ++i)
+            positions[i] = createTrainingPosition(dataset[indices[i]]);
+    });
+    return positions;
+}
+
+double evaluate(const TrainingPosition& position, const std::vector<double>& parameters)
+{
+    double evaluation = position.constant;
+    for (const auto& [index, coefficient] : position.coefficients)
+        evaluation += coefficient * parameters[index];
+    return evaluation;
+}
+
+double sigmoid(double evaluation, double k)
+{
+    return 1.0 / (1.0 + std::pow(10.0, -k * evaluation / 400.0));
+}
+
+double computeLoss(const std::vector<TrainingPosition>& positions,
+                   const std::vector<double>& parameters, double k, unsigned threads)
+{
+    std::vector<double> threadLoss(threads, 0.0);
+    parallelFor(threads, positions.size(), [&](size_t begin, size_t end, unsigned thread) {
+        double loss = 0.0;
+        for (size_t i = begin; i < end; ++i) {
+            double error = positions[i].result - sigmoid(evaluate(positions[i], parameters), k);
+            loss += error * error;
+        }
+        threadLoss[thread] = loss;
+    });
+
+    double loss = 0.0;
+    for (auto value : threadLoss)
+        loss += value;
+    return loss / static_cast<double>(positions.size());
+}
+
+/**
+ * Gradient of the mean squared error with respect to every parameter.
+ */
+std::vector<double> computeGradient(const std::vector<TrainingPosition>& positions,
+                                    const std::vector<double>& parameters, double k,
+                                    unsigned threads)
+{
+    std::vector<std::vector<double>> threadGradients(threads,
+                                                     std::vector<double>(parameters.size(), 0.0));
+    parallelFor(threads, positions.size(), [&](size_t begin, size_t end, unsigned thread) {
+        auto& gradient = threadGradients[thread];
+        for (size_t i = begin; i < end; ++i) {
+            double prediction = sigmoid(evaluate(positions[i], parameters), k);
+            double factor = -2.0 * (positions[i].result - prediction) * prediction *
+                            (1.0 - prediction) * std::log(10.0) * k / 400.0;
+            for (const auto& [index, coefficient] : positions[i].coefficients)
+                gradient[index] += factor * coefficient;
+        }
+    });
+
+    std::vector<double> gradient(parameters.size(), 0.0);
+    for (const auto& threadGradient : threadGradients) {
+        for (size_t i = 0; i < gradient.size(); ++i)
+            gradient[i] += threadGradient[i] / static_cast<double>(positions.size());
+    }
+    return gradient;
+}
+
+/**
+ * Scaling constant which minimizes the loss of the current parameters, ternary search.
+ */
+double fitScalingConstant(const std::vector<TrainingPosition>& positions,
+                          const std::vector<double>& parameters, unsigned threads)
+{
+    double low = 0.0;
+    double high = 3.0;
+    for (int i = 0; i < 40; ++i) {
+        double first = low + (high - low) / 3;
+        double second = high - (high - low) / 3;
+        if (computeLoss(positions, parameters, first, threads) <
+            computeLoss(positions, parameters, second, threads))
+            high = second;
+        else
+            low = first;
+    }
+    return (low + high) / 2;
+}
+
+void tune(const std::vector<TrainingPosition>& positions, std::vector<double>& parameters,
+          const Options& options)
+{
+    std::vector<bool> tunable(parameters.size(), false);
+    for (const auto& group : EvaluationParameters::getGroups()) {
+        for (size_t i = 0; i < group.size; ++i)
+            tunable[group.first + i] = group.tunable;
+    }
+
+    double k = fitScalingConstant(positions, parameters, options.threads);
+    CHESS_LOG_INFO("Scaling constant K = {:.4f}.", k);
+    CHESS_LOG_INFO("Initial loss {:.6f}.", computeLoss(positions, parameters, k, options.threads));
+
+    // Adam optimizer.
+    const double beta1 = 0.9;
+    const double beta2 = 0.999;
+    const double epsilon = 1e-8;
+    std::vector<double> momentum(parameters.size(), 0.0);
+    std::vector<double> velocity(parameters.size(), 0.0);
+
+    for (unsigned epoch = 1; epoch <= options.epochs; ++epoch) {
+        auto gradient = computeGradient(positions, parameters, k, options.threads);
+
+        for (size_t i = 0; i < parameters.size(); ++i) {
+            if (!tunable[i])
+                continue;
+
+            momentum[i] = beta1 * momentum[i] + (1 - beta1) * gradient[i];
+            velocity[i] = beta2 * velocity[i] + (1 - beta2) * gradient[i] * gradient[i];
+            double momentumCorrected = momentum[i] / (1 - std::pow(beta1, epoch));
+            double velocityCorrected = velocity[i] / (1 - std::pow(beta2, epoch));
+            parameters[i] -=
+                options.rate * momentumCorrected / (std::sqrt(velocityCorrected) + epsilon);
+        }
+
+        if (epoch % 10 == 0 || epoch == options.epochs) {
+            CHESS_LOG_INFO("Epoch {}, loss {:.6f}.", epoch,
+                           computeLoss(positions, parameters, k, options.threads));
+        }
+    }
+}
+
+std::optional<Options> parseOptions(int argc, char** argv)
+{
+    if (argc < 3)
+        return {};
+
+    Options options;
+    options.positionsPath = argv[1];
+    options.outputPath = argv[2];
+
+    for (int i = 3; i + 1 < argc; i += 2) {
+        std::string option = argv[i];
+        std::string value = argv[i + 1];
+        if (option == "--epochs")
+            options.epochs = static_cast<unsigned>(std::stoul(value));
+        else if (option == "--threads")
+            options.threads = std::max(1u, static_cast<unsigned>(std::stoul(value)));
+        else if (option == "--rate")
+            options.rate = std::stod(value);
+        else if (option == "--initial")
+            options.initialPath = value;
+        else if (option == "--sample")
+            options.sample = std::stoull(value);
+        else if (option == "--seed")
+            options.seed = std::stoull(value);
+        else
+            return {};
+    }
+    return options;
+}
+
+} // namespace
+
+} // namespace chessAi
+
+int main(int argc, char** argv)
+{
+    using namespace chessAi;
+
+    // Create the logger before worker threads use it.
+    Logger::Init();
+
+    std::optional<Options> options;
+    try {
+        options = parseOptions(argc, argv);
+    }
+    catch (const std::exception&) {
+        options.reset();
+    }
+    if (!options.has_value()) {
+        std::cerr << "Usage: texel_tuner <positions file> <output parameters file> [--epochs n] "
+                     "[--threads n] [--rate r] [--initial file] [--sample n] [--seed n]\n";
+        return 1;
+    }
+
+    if (!options->initialPath.empty() && !Evaluate::loadParameters(options->initialPath))
+        return 1;
+
+    auto start = std::chrono::steady_clock::now();
+    auto positions = loadTrainingPositions(*options);
+    if (positions.empty()) {
+        CHESS_LOG_ERROR("No training positions loaded.");
+        return 1;
+    }
+    auto loadTime = std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now() - start);
+    CHESS_LOG_INFO("Loaded {} positions in {} ms using {} threads.", positions.size(),
+                   loadTime.count(), options->threads);
+
+    const auto& initialParameters = Evaluate::getParameters();
+    std::vector<double> parameters(EvaluationParameters::NumberOfParameters);
+    for (size_t i = 0; i < parameters.size(); ++i)
+        parameters[i] = initialParameters[i];
+
+    tune(positions, parameters, *options);
+
+    EvaluationParameters tunedParameters;
+    for (size_t i = 0; i < parameters.size(); ++i)
+        tunedParameters[i] = static_cast<int>(std::lround(parameters[i]));
+
+    if (!tunedParameters.save(options->outputPath))
+        return 1;
+
+    auto totalTime = std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now() - start);
+    CHESS_LOG_INFO("Parameters saved to {} after {} ms.", options->outputPath, totalTime.count());
+    return 0;
+}
@@ -0,0 +1,81 @@
+#include "BenchmarkReport.h"
+#include "BuildInfo.h"
+
+#include <chrono>
+#include <cstdlib>
+#include <ctime>
+#include <fstream>
+#include <iostream>
+#include <thread>
+
+namespace chessAi
+{
+
+JsonValue BenchmarkReport::getContext()
+{
+    JsonValue context;
+    context["commit"] = CHESS_GIT_COMMIT;
+    context["compiler"] = CHESS_COMPILER;
+    context["build_type"] = CHESS_BUILD_TYPE;
+    context["flags"] = CHESS_BUILD_FLAGS;
+    context["cpu"] = getCpuModel();
+    context["threads"] = std::thread::hardware_concurrency();
+
+    auto now = std::chrono::system_clock::to_time_t(std::chrono::system_clock::now());
+    char date[32] = "";
+    if (const auto* time = std::gmtime(&now))
+        std::strftime(date, sizeof(date), "%Y-%m-%dT%H:%M:%SZ", time);
+    context["date"] = date;
+    return context;
+}
+
+bool BenchmarkReport::add(const std::string& benchmark, const Metrics& metrics)
+{
+    std::lock_guard<std::mutex> lock(s_mutex);
+    JsonValue& results = s_benchmarks[benchmark];
+    results = JsonValue(JsonValue::Object());
+    for (const auto& [name, metric] : metrics) {
+        JsonValue& value = results[name];
+        value["samples"] = JsonValue(JsonValue::Array());
+        for (auto sample : metric.samples)
+            value["samples"].push(sample);
+        value["unit"] = metric.unit;
+        value["higher_is_better"] = metric.higherIsBetter;
+    }
+
+    JsonValue report;
+    report["context"] = getContext();
+    report["benchmarks"] = s_benchmarks;
+
+    auto path = getOutputPath();
+    std::ofstream file(path);
+    file << report.toString() << '\n';
+    if (!file) {
+        std::cerr << "Benchmark results couldn't be written to " << path << ".\n";
+        return false;
+    }
+    return true;
+}
+
+std::string BenchmarkReport::getOutputPath()
+{
+    const char* path = std::getenv("CHESS_BENCHMARK_OUTPUT");
+    return (path != nullptr && *path != '\0') ? path : "benchmark_results.json";
+}
+
+std::string BenchmarkReport::getCpuModel()
+{
+    // Linux only, other systems are reported as unknown.
+    std::ifstream cpuInfo("/proc/cpuinfo");
+    std::string line;
+    while (std::getline(cpuInfo, line)) {
+        if (line.rfind("model name", 0) != 0)
+            continue;
+        auto colon = line.find(':');
+        if (colon != std::string::npos && colon + 2 <= line.size())
+            return line.substr(colon + 2);
+    }
+    return "unknown";
+}
+
+} // namespace chessAi
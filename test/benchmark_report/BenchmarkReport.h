@@ -0,0 +1,64 @@
+#pragma once
+
+#include "core/Json.h"
+
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace chessAi
+{
+
+/**
+ * Machine readable results of the benchmarks, compared between builds by benchmark_compare.
+ *
+ * Results file is a JSON object:
+ *      {"context": {"commit", "compiler", "build_type", "flags", "cpu", "threads", "date"},
+ *       "benchmarks": {<name>: {<metric>: {"samples": [...], "unit", "higher_is_better"}}}}
+ *
+ * Samples are repeated measurements of the same metric (e.g. NPS of every round over the
+ * position set), their spread is the noise used by the comparison. Google Benchmark results of
+ * micro_benchmarks use its own JSON format with the same context.
+ */
+class BenchmarkReport
+{
+public:
+    struct Metric
+    {
+        std::vector<double> samples;
+        std::string unit;
+        bool higherIsBetter = true;
+    };
+
+    using Metrics = std::map<std::string, Metric>;
+
+    /**
+     * Commit, compiler, build type and flags of this build, CPU model, hardware threads and
+     * current UTC time.
+     */
+    static JsonValue getContext();
+
+    /**
+     * Adds results of the benchmark (replacing earlier ones with the same name) and rewrites the
+     * results file, so results of finished benchmarks are kept if a later one fails.
+     *
+     * @return false If the file couldn't be written.
+     */
+    static bool add(const std::string& benchmark, const Metrics& metrics);
+
+    /**
+     * CHESS_BENCHMARK_OUTPUT environment variable, benchmark_results.json in the working
+     * directory by default.
+     */
+    static std::string getOutputPath();
+
+private:
+    static std::string getCpuModel();
+
+private:
+    inline static std::mutex s_mutex;
+    inline static JsonValue s_benchmarks;
+};
+
+} // namespace chessAi
@@ -0,0 +1,19 @@
+# Writes BuildInfo.h with the current commit, run with cmake -P at every build.
+# Inputs: INPUT, OUTPUT, GIT_EXECUTABLE, SOURCE_DIR, CHESS_COMPILER, CHESS_BUILD_TYPE,
+# CHESS_BUILD_FLAGS.
+set(CHESS_GIT_COMMIT "")
+if(GIT_EXECUTABLE)
+    execute_process(
+        COMMAND ${GIT_EXECUTABLE} describe --always --dirty
+        WORKING_DIRECTORY ${SOURCE_DIR}
+        OUTPUT_VARIABLE CHESS_GIT_COMMIT
+        OUTPUT_STRIP_TRAILING_WHITESPACE
+        ERROR_QUIET
+    )
+endif()
+if(CHESS_GIT_COMMIT STREQUAL "")
+    set(CHESS_GIT_COMMIT "unknown")
+endif()
+
+# File is only rewritten if the contents change, so an unchanged commit doesn't rebuild anything.
+configure_file(${INPUT} ${OUTPUT} @ONLY)
@@ -0,0 +1,335 @@
+/**
+ * Microbenchmarks of the core primitives, for time per operation of each building block of the
+ * search. Every benchmark iterates over the same fixed position set (the middle game positions of
+ * performance_tests) and reports time per primitive call.
+ *
+ * Run in release mode on an idle machine, e.g.:
+ *      micro_benchmarks --benchmark_repetitions=5 --benchmark_display_aggregates_only=true
+ *          --benchmark_out=micro.json --benchmark_out_format=json
+ * JSON output has the build context of BenchmarkReport and every repetition (the noise estimate
+ * of benchmark_compare), so don't use --benchmark_report_aggregates_only.
+ *
+ * Per piece move generation goes through MoveGenerator<TColor>::generateLegalMoves with the
+ * figure, which dispatches to the private generate*Moves functions without other work.
+ */
+
+#include <benchmark/benchmark.h>
+
+#include "BenchmarkReport.h"
+#include "core/Evaluate.h"
+#include "core/Fen.h"
+#include "core/MoveGenerator.h"
+#include "core/TranspositionTable.h"
+#include "core/ZobristHash.h"
+
+#include <random>
+
+namespace chessAi
+{
+
+namespace
+{
+
+const std::vector<PieceBitBoards>& getPositions()
+{
+    static const std::vector<PieceBitBoards> positions = []() {
+        std::vector<PieceBitBoards> boards;
+        Fen::forEachEpdLine("positions/mostly_middle_game_positions.epd",
+                            [&boards](const PieceBitBoards& bitBoards, std::string_view) {
+                                boards.push_back(bitBoards);
+                            });
+        return boards;
+    }();
+    return positions;
+}
+
+/**
+ * Skips the benchmark if test positions couldn't be loaded.
+ */
+bool hasPositions(benchmark::State& state)
+{
+    if (!getPositions().empty())
+        return true;
+    state.SkipWithError("File with test positions couldn't be opened.");
+    return false;
+}
+
+/**
+ * Legal moves of all positions, applied in BM_ApplyMove.
+ */
+const std::vector<std::pair<const PieceBitBoards*, Move>>& getPositionMoves()
+{
+    static const std::vector<std::pair<const PieceBitBoards*, Move>> moves = []() {
+        std::vector<std::pair<const PieceBitBoards*, Move>> positionMoves;
+        for (const auto& bitBoards : getPositions()) {
+            for (auto move : MoveGeneratorWrapper::generateLegalMoves<MoveType::Normal>(bitBoards))
+                positionMoves.emplace_back(&bitBoards, move);
+        }
+        return positionMoves;
+    }();
+    return moves;
+}
+
+template <PieceColor TColor>
+const std::vector<uint16_t>& getOrigins(const PieceBitBoards& bitBoards, PieceFigure figure)
+{
+    constexpr bool white = TColor == PieceColor::White;
+    switch (figure) {
+    case PieceFigure::Pawn:
+        return white ? bitBoards.whitePawnPositions : bitBoards.blackPawnPositions;
+    case PieceFigure::Knight:
+        return white ? bitBoards.whiteKnightPositions : bitBoards.blackKnightPositions;
+    case PieceFigure::Bishop:
+        return white ? bitBoards.whiteBishopPositions : bitBoards.blackBishopPositions;
+    case PieceFigure::Rook:
+        return white ? bitBoards.whiteRookPositions : bitBoards.blackRookPositions;
+    case PieceFigure::Queen:
+        return white ? bitBoards.whiteQueenPositions : bitBoards.blackQueenPositions;
+    default:
+        return white ? bitBoards.whiteKingPositions : bitBoards.blackKingPositions;
+    }
+}
+
+/**
+ * Generates moves of every piece of the figure of the side to move, one call per piece.
+ */
+template <PieceColor TColor>
+int64_t generatePieceMoves(const PieceBitBoards& bitBoards, PieceFigure figure)
+{
+    int64_t calls = 0;
+    for (auto origin : getOrigins<TColor>(bitBoards, figure)) {
+        auto moves = MoveGenerator<TColor>::template generateLegalMoves<MoveType::Normal>(
+            bitBoards, figure, origin);
+        benchmark::DoNotOptimize(moves.data());
+        ++calls;
+    }
+    return calls;
+}
+
+void BM_GeneratePieceMoves(benchmark::State& state, PieceFigure figure)
+{
+    if (!hasPositions(state))
+        return;
+    int64_t calls = 0;
+    for (auto _ : state) {
+        for (const auto& bitBoards : getPositions()) {
+            if (bitBoards.currentMoveColor == PieceColor::White)
+                calls += generatePieceMoves<PieceColor::White>(bitBoards, figure);
+            else
+                calls += generatePieceMoves<PieceColor::Black>(bitBoards, figure);
+        }
+    }
+    state.SetItemsProcessed(calls);
+}
+
+void BM_GenerateLegalMoves(benchmark::State& state)
+{
+    if (!hasPositions(state))
+        return;
+    for (auto _ : state) {
+        for (const auto& bitBoards : getPositions()) {
+            auto moves = MoveGeneratorWrapper::generateLegalMoves<MoveType::Normal>(bitBoards);
+            benchmark::DoNotOptimize(moves.data());
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(getPositions().size()));
+}
+
+void BM_GenerateCaptures(benchmark::State& state)
+{
+    if (!hasPositions(state))
+        return;
+    for (auto _ : state) {
+        for (const auto& bitBoards : getPositions()) {
+            auto moves = MoveGeneratorWrapper::generateLegalMoves<MoveType::Capture>(bitBoards);
+            benchmark::DoNotOptimize(moves.data());
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(getPositions().size()));
+}
+
+void BM_IsKingInCheck(benchmark::State& state)
+{
+    if (!hasPositions(state))
+        return;
+    for (auto _ : state) {
+        for (const auto& bitBoards : getPositions()) {
+            bool check = bitBoards.currentMoveColor == PieceColor::White
+                             ? MoveGenerator<PieceColor::White>::isKingInCheck(bitBoards)
+                             : MoveGenerator<PieceColor::Black>::isKingInCheck(bitBoards);
+            benchmark::DoNotOptimize(check);
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(getPositions().size()));
+}
+
+/**
+ * Copy of the bit boards, the baseline of BM_ApplyMove (search copies the position before every
+ * move).
+ */
+void BM_CopyPosition(benchmark::State& state)
+{
+    if (!hasPositions(state))
+        return;
+    const auto& moves = getPositionMoves();
+    for (auto _ : state) {
+        for (const auto& [bitBoards, move] : moves) {
+            PieceBitBoards copy = *bitBoards;
+            benchmark::DoNotOptimize(copy.zobristKey);
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(moves.size()));
+}
+
+void BM_ApplyMove(benchmark::State& state)
+{
+    if (!hasPositions(state))
+        return;
+    const auto& moves = getPositionMoves();
+    for (auto _ : state) {
+        for (const auto& [bitBoards, move] : moves) {
+            PieceBitBoards copy = *bitBoards;
+            copy.applyMove(move);
+            benchmark::DoNotOptimize(copy.zobristKey);
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(moves.size()));
+}
+
+void BM_Evaluate(benchmark::State& state)
+{
+    if (!hasPositions(state))
+        return;
+    for (auto _ : state) {
+        for (const auto& bitBoards : getPositions())
+            benchmark::DoNotOptimize(Evaluate::getEvaluation(bitBoards));
+    }
+    state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(getPositions().size()));
+}
+
+void BM_AttackMaps(benchmark::State& state)
+{
+    if (!hasPositions(state))
+        return;
+    for (auto _ : state) {
+        for (const auto& bitBoards : getPositions()) {
+            AttackMaps attackMaps(bitBoards);
+            benchmark::DoNotOptimize(&attackMaps);
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(getPositions().size()));
+}
+
+void BM_ZobristKey(benchmark::State& state)
+{
+    if (!hasPositions(state))
+        return;
+    for (auto _ : state) {
+        for (const auto& bitBoards : getPositions())
+            benchmark::DoNotOptimize(ZobristHash::calculateZobristKey(bitBoards));
+    }
+    state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(getPositions().size()));
+}
+
+void BM_FenParse(benchmark::State& state)
+{
+    if (!hasPositions(state))
+        return;
+    std::vector<std::string> fens;
+    for (const auto& bitBoards : getPositions())
+        fens.push_back(Fen::toString(bitBoards));
+
+    PieceBitBoards bitBoards;
+    for (auto _ : state) {
+        for (const auto& fen : fens) {
+            bool valid = Fen::parse(fen, bitBoards);
+            benchmark::DoNotOptimize(valid);
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(fens.size()));
+}
+
+/**
+ * Random keys, so accesses miss the cache as in the search with a full table.
+ */
+std::vector<uint64_t> getRandomKeys()
+{
+    std::mt19937_64 random(2024);
+    std::vector<uint64_t> keys(1 << 16);
+    for (auto& key : keys)
+        key = random();
+    return keys;
+}
+
+TranspositionTable& getTranspositionTable()
+{
+    static TranspositionTable table;
+    return table;
+}
+
+void BM_TranspositionTableStore(benchmark::State& state)
+{
+    auto keys = getRandomKeys();
+    auto& table = getTranspositionTable();
+    Move move(12, 28, 0, 0);
+    for (auto _ : state) {
+        for (auto key : keys)
+            table.store(key, 10, 5, TranspositionTable::TypeOfNode::exact, move);
+    }
+    state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(keys.size()));
+}
+
+void BM_TranspositionTableGetEntry(benchmark::State& state)
+{
+    auto keys = getRandomKeys();
+    auto& table = getTranspositionTable();
+    Move move(12, 28, 0, 0);
+    // Half of the probes hit.
+    for (size_t i = 0; i < keys.size(); i += 2)
+        table.store(keys[i], 10, 5, TranspositionTable::TypeOfNode::exact, move);
+
+    for (auto _ : state) {
+        for (auto key : keys)
+            benchmark::DoNotOptimize(table.getEntry(key));
+    }
+    state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(keys.size()));
+}
+
+} // namespace
+
+BENCHMARK_CAPTURE(BM_GeneratePieceMoves, pawn, PieceFigure::Pawn);
+BENCHMARK_CAPTURE(BM_GeneratePieceMoves, knight, PieceFigure::Knight);
+BENCHMARK_CAPTURE(BM_GeneratePieceMoves, bishop, PieceFigure::Bishop);
+BENCHMARK_CAPTURE(BM_GeneratePieceMoves, rook, PieceFigure::Rook);
+BENCHMARK_CAPTURE(BM_GeneratePieceMoves, queen, PieceFigure::Queen);
+BENCHMARK_CAPTURE(BM_GeneratePieceMoves, king, PieceFigure::King);
+BENCHMARK(BM_GenerateLegalMoves);
+BENCHMARK(BM_GenerateCaptures);
+BENCHMARK(BM_IsKingInCheck);
+BENCHMARK(BM_CopyPosition);
+BENCHMARK(BM_ApplyMove);
+BENCHMARK(BM_Evaluate);
+BENCHMARK(BM_AttackMaps);
+BENCHMARK(BM_ZobristKey);
+BENCHMARK(BM_FenParse);
+BENCHMARK(BM_TranspositionTableStore);
+BENCHMARK(BM_TranspositionTableGetEntry);
+
+} // namespace chessAi
+
+int main(int argc, char** argv)
+{
+    benchmark::Initialize(&argc, argv);
+    if (benchmark::ReportUnrecognizedArguments(argc, argv))
+        return 1;
+
+    // Google Benchmark writes date, number of CPUs and caches itself.
+    auto context = chessAi::BenchmarkReport::getContext();
+    for (const auto& [key, value] : context.getObject()) {
+        if (value.isString() && key != "date")
+            benchmark::AddCustomContext(key, value.getString());
+    }
+    benchmark::RunSpecifiedBenchmarks();
+    benchmark::Shutdown();
+    return 0;
+}
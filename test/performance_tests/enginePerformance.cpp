@@ -13,110 +13,237 @@
  *          21/01/2024, pawn defended check in ordering:
  *              getBestMove(depth = 4): average time = 233 ms
  *              getBestMove(timeLimit = 500 ms): average depth reached = 6.4
+ *
+ * Newer results are written as JSON (see BenchmarkReport), compare two runs with:
+ *      benchmark_compare old.json new.json
  */
 
 #include <gtest/gtest.h>
 
+#include "BenchmarkReport.h"
 #include "core/Engine.h"
+#include "core/EngineWorker.h"
 #include "core/PieceBitBoards.h"
+#include "core/PositionDataset.h"
 
-#include <fstream>
+#include <algorithm>
+#include <atomic>
 #include <iostream>
+#include <thread>
 
 namespace chessAi
 {
 
-std::vector<std::string> splitString(const std::string& input, char delimiter)
+/**
+ * Test positions, loaded once through PositionDataset.
+ */
+const std::vector<PieceBitBoards>& getPositions()
 {
-    std::vector<std::string> tokens;
-    size_t start = 0;
-    size_t end = input.find(delimiter);
-
-    while (end != std::string::npos) {
-        tokens.push_back(input.substr(start, end - start));
-        start = end + 1;
-        end = input.find(delimiter, start);
-    }
-
-    tokens.push_back(input.substr(start, end));
-
-    return tokens;
+    static const std::vector<PieceBitBoards> positions = []() {
+        std::vector<PieceBitBoards> boards;
+        PositionDataset dataset;
+        if (!dataset.open("positions/mostly_middle_game_positions.epd"))
+            return boards;
+
+        boards.resize(dataset.size());
+        for (size_t i = 0; i < dataset.size(); ++i)
+            dataset[i].position.unpack(boards[i]);
+        return boards;
+    }();
+    return positions;
 }
 
-void runPerformanceTestDepth(int depth, std::string& result)
+/**
+ * Metrics have a sample for every round over the positions.
+ */
+void runPerformanceTestDepth(int depth, std::string& result, BenchmarkReport::Metrics& metrics)
 {
     std::chrono::milliseconds time(0);
     unsigned int count = 0;
 
-    for (int i = 0; i < 3; ++i) {
-        std::ifstream file("positions/mostly_middle_game_positions.epd");
-        if (!file.is_open())
-            FAIL() << "File with test positions couldn't be opened.";
+    const auto& positions = getPositions();
+    if (positions.empty())
+        FAIL() << "File with test positions couldn't be opened.";
 
-        std::string line;
-        while (std::getline(file, line)) {
-            auto tokens = splitString(line, ';');
-            tokens[0].pop_back();
-            PieceBitBoards board(tokens[0]);
+    auto& averageTime = metrics["average_time"];
+    averageTime.unit = "ms";
+    averageTime.higherIsBetter = false;
+    auto& nps = metrics["nps"];
+    nps.unit = "nodes/s";
 
+    for (int i = 0; i < 3; ++i) {
+        std::chrono::microseconds roundTime(0);
+        uint64_t roundNodes = 0;
+        for (const auto& board : positions) {
             // Initialize here, so transposition tables are cleared (independent results).
             Engine engine(false, std::chrono::milliseconds(1000000), depth);
             auto start = std::chrono::high_resolution_clock::now();
-            engine.findBestMove(board, {}, {});
-            time += std::chrono::duration_cast<std::chrono::milliseconds>(
-                std::chrono::high_resolution_clock::now() - start);
+            engine.findBestMove(board, {});
+            auto elapsed = std::chrono::high_resolution_clock::now() - start;
+            time += std::chrono::duration_cast<std::chrono::milliseconds>(elapsed);
+            roundTime += std::chrono::duration_cast<std::chrono::microseconds>(elapsed);
 
+            const auto& statistics = engine.getSearchStatistics();
+            roundNodes += statistics.nodes + statistics.quiescenceNodes;
             ++count;
         }
-        file.close();
+
+        auto seconds = std::max(static_cast<double>(roundTime.count()) / 1e6, 1e-6);
+        averageTime.samples.push_back(seconds * 1000.0 / static_cast<double>(positions.size()));
+        nps.samples.push_back(static_cast<double>(roundNodes) / seconds);
     }
 
     result = "getBestMove(depth = " + std::to_string(depth) +
              "): average time = " + std::to_string(time.count() / count) + " ms";
 }
 
-void runPerformanceTestTime(std::chrono::milliseconds timeLimit, std::string& result)
+void runPerformanceTestTime(std::chrono::milliseconds timeLimit, std::string& result,
+                            BenchmarkReport::Metrics& metrics)
 {
     unsigned int count = 0;
     float depthSum = 0;
 
-    for (int i = 0; i < 3; ++i) {
-        std::ifstream file("positions/mostly_middle_game_positions.epd");
-        if (!file.is_open())
-            FAIL() << "File with test positions couldn't be opened.";
+    const auto& positions = getPositions();
+    if (positions.empty())
+        FAIL() << "File with test positions couldn't be opened.";
 
-        std::string line;
-        while (std::getline(file, line)) {
-            auto tokens = splitString(line, ';');
-            tokens[0].pop_back();
-            PieceBitBoards board(tokens[0]);
+    auto& averageDepth = metrics["average_depth"];
+    averageDepth.unit = "plies";
 
+    for (int i = 0; i < 3; ++i) {
+        float roundDepthSum = 0;
+        for (const auto& board : positions) {
             // Initialize here, so transposition tables are cleared.
             Engine engine(false, timeLimit);
-            auto [move, depth] = engine.findBestMove(board, {}, {});
+            auto [move, depth] = engine.findBestMove(board, {});
             depthSum += static_cast<float>(depth);
+            roundDepthSum += static_cast<float>(depth);
             ++count;
         }
-        file.close();
+        averageDepth.samples.push_back(static_cast<double>(roundDepthSum) /
+                                       static_cast<double>(positions.size()));
     }
 
     result = "getBestMove(timeLimit = " + std::to_string(timeLimit.count()) + " ms" +
              "): average depth reached = " + std::to_string(depthSum / static_cast<float>(count));
 }
 
+void runPerformanceTestEvalCache(int depth, bool useEvalCache, std::string& result,
+                                 BenchmarkReport::Metrics& metrics)
+{
+    std::chrono::milliseconds time(0);
+    uint64_t nodes = 0;
+    uint64_t probes = 0;
+    uint64_t hits = 0;
+
+    const auto& positions = getPositions();
+    if (positions.empty())
+        FAIL() << "File with test positions couldn't be opened.";
+
+    for (const auto& board : positions) {
+        Engine engine(false, std::chrono::milliseconds(1000000), depth);
+        if (!useEvalCache)
+            engine.setEvalCache(nullptr);
+        engine.findBestMove(board, {});
+
+        const auto& statistics = engine.getSearchStatistics();
+        time += statistics.time;
+        nodes += statistics.nodes + statistics.quiescenceNodes;
+        probes += statistics.evalCacheProbes;
+        hits += statistics.evalCacheHits;
+    }
+
+    auto nps = static_cast<double>(nodes) * 1000.0 /
+               static_cast<double>(std::max<int64_t>(time.count(), 1));
+    result = "getBestMove(depth = " + std::to_string(depth) +
+             ", evalCache = " + (useEvalCache ? "on" : "off") +
+             "): nodes per second = " + std::to_string(static_cast<uint64_t>(nps));
+    if (probes > 0)
+        result += ", hit rate = " +
+                  std::to_string(100.0 * static_cast<double>(hits) / static_cast<double>(probes)) +
+                  " %";
+
+    std::string suffix = useEvalCache ? "_eval_cache" : "";
+    metrics["nps" + suffix] = {{nps}, "nodes/s", true};
+    if (probes > 0) {
+        metrics["hit_rate" + suffix] = {
+            {100.0 * static_cast<double>(hits) / static_cast<double>(probes)}, "%", true};
+    }
+}
+
 // The test log is long because of logging in each iteration, scroll to the and to see the result.
 TEST(PerformanceOfFindBestMove, TestFixedDepth)
 {
     std::string result4;
-    runPerformanceTestDepth(4, result4);
+    BenchmarkReport::Metrics metrics;
+    runPerformanceTestDepth(4, result4, metrics);
     std::cout << result4 << '\n';
+    BenchmarkReport::add("PerformanceOfFindBestMove.TestFixedDepth", metrics);
+}
+
+TEST(PerformanceOfFindBestMove, TestEvalCache)
+{
+    BenchmarkReport::Metrics metrics;
+    std::string withoutCache;
+    runPerformanceTestEvalCache(5, false, withoutCache, metrics);
+    std::cout << withoutCache << '\n';
+
+    std::string withCache;
+    runPerformanceTestEvalCache(5, true, withCache, metrics);
+    std::cout << withCache << '\n';
+    BenchmarkReport::add("PerformanceOfFindBestMove.TestEvalCache", metrics);
 }
 
 TEST(PerformanceOfFindBestMove, TestFixedTime)
 {
     std::string result;
-    runPerformanceTestTime(std::chrono::milliseconds(500), result);
+    BenchmarkReport::Metrics metrics;
+    runPerformanceTestTime(std::chrono::milliseconds(500), result, metrics);
     std::cout << result << '\n';
+    BenchmarkReport::add("PerformanceOfFindBestMove.TestFixedTime", metrics);
+}
+
+/**
+ * Time from stop to the result of a running search, which must be short enough to move within the
+ * remaining time of the game clock.
+ */
+TEST(PerformanceOfFindBestMove, TestStopLatency)
+{
+    const auto& positions = getPositions();
+    if (positions.empty())
+        FAIL() << "File with test positions couldn't be opened.";
+
+    BenchmarkReport::Metrics metrics;
+    auto& averageLatency = metrics["average_stop_latency"];
+    averageLatency.unit = "ms";
+    averageLatency.higherIsBetter = false;
+    double maxLatency = 0.0;
+
+    EngineWorker worker(false, std::chrono::milliseconds(1000000));
+    for (int i = 0; i < 3; ++i) {
+        double roundLatency = 0.0;
+        for (const auto& board : positions) {
+            std::atomic<unsigned int> iterations = 0;
+            auto search = worker.startSearch(
+                board, {}, [&iterations](const Engine::SearchInfo&) { iterations++; });
+            // Stop in the middle of a deeper iteration.
+            while (iterations < 3 && !search.isReady())
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            std::this_thread::sleep_for(std::chrono::milliseconds(20));
+            search.stop();
+
+            auto latency =
+                static_cast<double>(search.get().statistics.stopLatency.count()) / 1000.0;
+            roundLatency += latency;
+            maxLatency = std::max(maxLatency, latency);
+        }
+        averageLatency.samples.push_back(roundLatency / static_cast<double>(positions.size()));
+    }
+
+    std::cout << "stop latency: average = " << averageLatency.samples.back()
+              << " ms, max = " << maxLatency << " ms\n";
+    EXPECT_LT(maxLatency, 50.0);
+    BenchmarkReport::add("PerformanceOfFindBestMove.TestStopLatency", metrics);
 }
 
 } // namespace chessAi
@@ -0,0 +1,126 @@
+/**
+ * Tactical strength per time: solve rate of an EPD test suite with "bm" operations at several
+ * time limits, with time and nodes to solution. Run in release mode, on an otherwise idle
+ * machine (searches run in parallel, one per core, and are time limited).
+ *
+ * Time to solution is the time of the iteration after which the best move solves the position
+ * and doesn't change anymore.
+ */
+
+#include <gtest/gtest.h>
+
+#include "BenchmarkReport.h"
+#include "core/AnalysisPool.h"
+#include "core/EpdSuite.h"
+
+#include <iostream>
+#include <thread>
+
+namespace chessAi
+{
+
+namespace
+{
+
+struct PositionResult
+{
+    bool solved = false;
+    std::chrono::milliseconds timeToSolution{0};
+    uint64_t nodesToSolution = 0;
+};
+
+/**
+ * Finds when the search settled on a solving move, from its iterations.
+ */
+PositionResult getPositionResult(const EpdSuite::Position& position,
+                                 const std::vector<Engine::SearchInfo>& iterations,
+                                 const EngineWorker::Result& result)
+{
+    PositionResult positionResult;
+    positionResult.solved = result.move.has_value() && position.isSolvedBy(*result.move);
+    if (!positionResult.solved)
+        return positionResult;
+
+    // Solved by an unfinished iteration, if no completed one solves it.
+    positionResult.timeToSolution = result.statistics.time;
+    positionResult.nodesToSolution = result.statistics.nodes + result.statistics.quiescenceNodes;
+    for (auto it = iterations.rbegin(); it != iterations.rend(); ++it) {
+        if (it->lines.empty() || it->lines.front().moves.empty() ||
+            !position.isSolvedBy(it->lines.front().moves.front()))
+            break;
+        positionResult.timeToSolution = it->time;
+        positionResult.nodesToSolution = it->nodes;
+    }
+    return positionResult;
+}
+
+std::vector<PositionResult> runSuite(const std::vector<EpdSuite::Position>& positions,
+                                     std::chrono::milliseconds timeLimit)
+{
+    std::vector<std::vector<Engine::SearchInfo>> iterations(positions.size());
+    std::vector<std::optional<EngineWorker::Result>> results(positions.size());
+    AnalysisPool pool(std::max(1u, std::thread::hardware_concurrency()), false);
+    for (size_t i = 0; i < positions.size(); ++i) {
+        AnalysisPool::Analysis analysis;
+        analysis.bitBoards = positions[i].bitBoards;
+        analysis.limits.time = timeLimit;
+        analysis.clearHash = true;
+        // Callbacks of one analysis come from one worker and write only its slots.
+        pool.submit(
+            std::move(analysis),
+            [&results, i](unsigned int, const EngineWorker::Result& result) {
+                results[i] = result;
+            },
+            [&iterations, i](unsigned int, const Engine::SearchInfo& info) {
+                iterations[i].push_back(info);
+            });
+    }
+    pool.wait();
+
+    std::vector<PositionResult> positionResults;
+    for (size_t i = 0; i < positions.size(); ++i)
+        positionResults.push_back(getPositionResult(positions[i], iterations[i], *results[i]));
+    return positionResults;
+}
+
+} // namespace
+
+TEST(TacticalSuite, SolveRateVsTime)
+{
+    auto positions = EpdSuite::load("positions/wac_subset.epd");
+    ASSERT_TRUE(positions.has_value() && !positions->empty());
+
+    BenchmarkReport::Metrics metrics;
+    for (auto timeLimit : {100, 250, 500, 1000}) {
+        auto results = runSuite(*positions, std::chrono::milliseconds(timeLimit));
+
+        size_t solved = 0;
+        std::chrono::milliseconds time(0);
+        uint64_t nodes = 0;
+        for (const auto& result : results) {
+            if (!result.solved)
+                continue;
+            ++solved;
+            time += result.timeToSolution;
+            nodes += result.nodesToSolution;
+        }
+
+        auto count = static_cast<double>(std::max<size_t>(solved, 1));
+        std::cout << "Suite (timeLimit = " << timeLimit << " ms): solved " << solved << " / "
+                  << positions->size() << " ("
+                  << 100.0 * static_cast<double>(solved) / static_cast<double>(positions->size())
+                  << " %), average time to solution = "
+                  << static_cast<double>(time.count()) / count
+                  << " ms, average nodes to solution = " << static_cast<double>(nodes) / count
+                  << '\n';
+
+        // Solve rate has no noise estimate, searches are time limited and not repeated.
+        auto limit = std::to_string(timeLimit) + "ms";
+        metrics["solved_" + limit] = {{static_cast<double>(solved)}, "positions", true};
+        metrics["time_to_solution_" + limit] = {
+            {static_cast<double>(time.count()) / count}, "ms", false};
+    }
+    BenchmarkReport::add("TacticalSuite.SolveRateVsTime", metrics);
+}
+
+} // namespace chessAi
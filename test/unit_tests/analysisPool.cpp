@@ -0,0 +1,87 @@
+#include <gtest/gtest.h>
+
+#include "core/AnalysisPool.h"
+
+#include <map>
+
+namespace chessAi
+{
+
+TEST(AnalysisPool, RunsSessionsOnFixedWorkers)
+{
+    AnalysisPool pool(2, false);
+    EXPECT_EQ(pool.getThreads(), 2);
+
+    std::mutex resultsMutex;
+    std::map<unsigned int, EngineWorker::Result> results;
+    auto storeResult = [&results, &resultsMutex](unsigned int id,
+                                                 const EngineWorker::Result& result) {
+        std::lock_guard<std::mutex> lock(resultsMutex);
+        results.emplace(id, result);
+    };
+
+    // More analyses than workers, the rest waits in the queue.
+    std::vector<unsigned int> ids;
+    for (const auto* fen : {"r1bqkbnr/pppp1ppp/2n5/4p3/4P3/5N2/PPPP1PPP/RNBQKB1R w KQkq - 2 3",
+                            "8/8/8/8/8/2R5/1k6/7K w - - 0 1",
+                            "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1",
+                            "4k3/8/4K3/4P3/8/8/8/8 w - - 0 1"}) {
+        AnalysisPool::Analysis analysis;
+        analysis.session = "session" + std::to_string(ids.size() % 2);
+        analysis.bitBoards = PieceBitBoards(fen);
+        analysis.limits.depth = 4;
+        analysis.limits.multiPv = 2;
+        ids.push_back(pool.submit(std::move(analysis), storeResult));
+    }
+    pool.wait();
+
+    ASSERT_EQ(results.size(), ids.size());
+    for (auto id : ids) {
+        const auto& result = results.at(id);
+        EXPECT_TRUE(result.move.has_value());
+        EXPECT_FALSE(result.stopped);
+        EXPECT_EQ(result.depth, 4);
+        EXPECT_EQ(result.lines.size(), 2);
+    }
+    auto statistics = pool.getStatistics();
+    EXPECT_EQ(statistics.completed, ids.size());
+    EXPECT_EQ(statistics.running + statistics.queued, 0);
+    EXPECT_GT(statistics.analysesPerSecond, 0.0);
+}
+
+TEST(AnalysisPool, StopsSession)
+{
+    AnalysisPool pool(1, false);
+    std::mutex resultsMutex;
+    std::map<unsigned int, EngineWorker::Result> results;
+    auto storeResult = [&results, &resultsMutex](unsigned int id,
+                                                 const EngineWorker::Result& result) {
+        std::lock_guard<std::mutex> lock(resultsMutex);
+        results.emplace(id, result);
+    };
+
+    AnalysisPool::Analysis analysis;
+    analysis.bitBoards =
+        PieceBitBoards("r1bqkbnr/pppp1ppp/2n5/4p3/4P3/5N2/PPPP1PPP/RNBQKB1R w KQkq - 2 3");
+    analysis.limits.time = std::chrono::milliseconds(60000);
+    analysis.session = "a";
+    auto running = pool.submit(analysis, storeResult);
+    auto queued = pool.submit(analysis, storeResult);
+    analysis.session = "b";
+    analysis.limits.time = std::chrono::milliseconds(100);
+    auto other = pool.submit(analysis, storeResult);
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    pool.stopSession("a");
+    pool.wait();
+
+    ASSERT_EQ(results.size(), 3);
+    EXPECT_TRUE(results.at(running).stopped);
+    EXPECT_TRUE(results.at(running).move.has_value());
+    EXPECT_TRUE(results.at(queued).stopped);
+    EXPECT_FALSE(results.at(queued).move.has_value());
+    EXPECT_FALSE(results.at(other).stopped);
+    EXPECT_TRUE(results.at(other).move.has_value());
+}
+
+} // namespace chessAi
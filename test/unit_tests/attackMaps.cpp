@@ -0,0 +1,63 @@
+/**
+ * Run tests in release mode, otherwise takes a lot of time.
+ *
+ */
+
+#include <gtest/gtest.h>
+
+#include "core/AttackMaps.h"
+#include "core/Evaluate.h"
+#include "core/MoveGenerator.h"
+
+#include <fstream>
+
+namespace chessAi
+{
+
+TEST(AttackMaps, KnightMobilityOnEmptyBoard)
+{
+    // Knight on d4, kings in the corners.
+    AttackMaps attackMaps(PieceBitBoards("k7/8/8/8/3N4/8/8/7K w - - 0 1"));
+    const auto& white = attackMaps.get<PieceColor::White>();
+    EXPECT_EQ(white.mobility[static_cast<size_t>(PieceFigure::Knight)], 8);
+    EXPECT_EQ(PieceBitBoards::countSetBits(
+                  white.byFigure[static_cast<size_t>(PieceFigure::Knight)]),
+              8);
+
+    // Black pawns on a6 and g6 attack b5 and f5, knight loses two safe squares.
+    AttackMaps withPawn(PieceBitBoards("k7/8/p5p1/8/3N4/8/8/7K w - - 0 1"));
+    EXPECT_EQ(withPawn.get<PieceColor::White>().mobility[static_cast<size_t>(PieceFigure::Knight)],
+              6);
+}
+
+TEST(AttackMaps, AttackedTwice)
+{
+    // Both rooks attack d1.
+    AttackMaps attackMaps(PieceBitBoards("1k6/8/8/8/8/8/8/R2R3K w - - 0 1"));
+    EXPECT_TRUE(PieceBitBoards::getBit(attackMaps.get<PieceColor::White>().attackedTwice, 58));
+    EXPECT_FALSE(PieceBitBoards::getBit(attackMaps.get<PieceColor::White>().attackedTwice, 48));
+}
+
+TEST(AttackMaps, SameCheckDetectionAndMovesAsMoveGenerator)
+{
+    std::ifstream file("perft_positions/perftsuite.epd");
+    ASSERT_TRUE(file.is_open());
+
+    std::string line;
+    while (std::getline(file, line)) {
+        PieceBitBoards board(line.substr(0, line.find(';') - 1));
+        AttackMaps attackMaps(board);
+
+        EXPECT_EQ(attackMaps.isKingInCheck<PieceColor::White>(board),
+                  MoveGenerator<PieceColor::White>::isKingInCheck(board));
+        EXPECT_EQ(attackMaps.isKingInCheck<PieceColor::Black>(board),
+                  MoveGenerator<PieceColor::Black>::isKingInCheck(board));
+
+        EXPECT_EQ(MoveGeneratorWrapper::generateLegalMoves<MoveType::Normal>(board).size(),
+                  MoveGeneratorWrapper::generateLegalMoves<MoveType::Normal>(board, attackMaps)
+                      .size());
+        EXPECT_EQ(Evaluate::getEvaluation(board), Evaluate::getEvaluation(board, attackMaps));
+    }
+}
+
+} // namespace chessAi
@@ -0,0 +1,273 @@
+#include <gtest/gtest.h>
+
+#include "core/BitbaseGenerator.h"
+#include "core/Engine.h"
+#include "core/PieceBitBoards.h"
+
+#include <algorithm>
+#include <atomic>
+#include <filesystem>
+#include <random>
+#include <thread>
+
+namespace chessAi
+{
+
+namespace
+{
+
+/**
+ * All bitbases with 3 pieces, generated once.
+ */
+const Bitbases& getBitbases()
+{
+    static const Bitbases bitbases = []() {
+        Bitbases generated;
+        for (const auto& name : BitbaseGenerator::getNames(3)) {
+            auto bitbase = BitbaseGenerator::generate(name, generated, 2);
+            EXPECT_TRUE(bitbase.has_value());
+            if (bitbase.has_value())
+                generated.add(std::move(*bitbase));
+        }
+        return generated;
+    }();
+    return bitbases;
+}
+
+/**
+ * Empty directory with a unique name under the system temporary directory, removed with its
+ * files at the end of the test. Tests never touch bitbases/ of the working directory.
+ */
+class TemporaryDirectory
+{
+public:
+    TemporaryDirectory()
+        : m_path(std::filesystem::temp_directory_path() /
+                 ("chessAi_bitbase_test_" + std::to_string(std::random_device{}())))
+    {
+        std::filesystem::create_directories(m_path);
+    }
+
+    ~TemporaryDirectory()
+    {
+        std::error_code error;
+        std::filesystem::remove_all(m_path, error);
+    }
+
+    TemporaryDirectory(const TemporaryDirectory&) = delete;
+    TemporaryDirectory& operator=(const TemporaryDirectory&) = delete;
+
+    std::string getPath(const std::string& name = "") const
+    {
+        return name.empty() ? m_path.string() : (m_path / name).string();
+    }
+
+private:
+    std::filesystem::path m_path;
+};
+
+std::optional<Bitbase::Result> probe(const std::string& fen)
+{
+    auto position = BitbasePosition::fromBitBoards(PieceBitBoards(fen));
+    if (!position.has_value())
+        return {};
+    return getBitbases().probe(*position);
+}
+
+} // namespace
+
+TEST(Bitbase, Names)
+{
+    EXPECT_EQ(BitbaseGenerator::getNames(3),
+              (std::vector<std::string>{"KQK", "KRK", "KBK", "KNK", "KPK"}));
+
+    auto names = BitbaseGenerator::getNames(4);
+    EXPECT_EQ(names.size(), 35);
+    auto position = [&names](const std::string& name) {
+        return static_cast<size_t>(std::find(names.begin(), names.end(), name) - names.begin());
+    };
+    // Promotions lead to bitbases generated earlier.
+    EXPECT_LT(position("KQKP"), position("KPKP"));
+    EXPECT_LT(position("KQKR"), position("KRKP"));
+    EXPECT_EQ(position("KRKQ"), names.size());
+
+    EXPECT_FALSE(Bitbase::create("KRR").has_value());
+    EXPECT_FALSE(Bitbase::create("KXK").has_value());
+    EXPECT_FALSE(Bitbase::create("KQRKP").has_value());
+}
+
+TEST(Bitbase, IndexRoundTrips)
+{
+    for (const auto* name : {"KRK", "KPK", "KQKP", "KBNK"}) {
+        auto bitbase = Bitbase::create(name);
+        ASSERT_TRUE(bitbase.has_value());
+        for (size_t index = 0; index < bitbase->size(); index += 997) {
+            auto canonicalIndex = bitbase->getIndex(bitbase->getPosition(index));
+            EXPECT_EQ(bitbase->getIndex(bitbase->getPosition(canonicalIndex)), canonicalIndex);
+            if (bitbase->hasPawns())
+                EXPECT_EQ(canonicalIndex, index);
+        }
+    }
+
+    // Symmetric positions and flipped colors have the same index.
+    auto bitbase = Bitbase::create("KRK");
+    auto fromFen = [](const std::string& fen) {
+        return BitbasePosition::fromBitBoards(PieceBitBoards(fen));
+    };
+    auto original = fromFen("8/8/8/8/8/2k5/8/R3K3 w - - 0 1");
+    auto mirrored = fromFen("8/8/8/8/8/5k2/8/3K3R w - - 0 1");
+    auto flipped = fromFen("r3k3/8/2K5/8/8/8/8/8 b - - 0 1");
+    ASSERT_TRUE(original.has_value() && mirrored.has_value() && flipped.has_value());
+    EXPECT_EQ(bitbase->getIndex(*original), bitbase->getIndex(*mirrored));
+    EXPECT_EQ(bitbase->getIndex(*original), bitbase->getIndex(*flipped));
+
+    // White king on the a8-h1 diagonal, mirrored on it.
+    auto diagonal = fromFen("K6R/8/1k6/8/8/8/8/8 w - - 0 1");
+    auto transposed = fromFen("K7/2k5/8/8/8/8/8/R7 w - - 0 1");
+    ASSERT_TRUE(diagonal.has_value() && transposed.has_value());
+    EXPECT_EQ(bitbase->getIndex(*diagonal), bitbase->getIndex(*transposed));
+
+    EXPECT_FALSE(BitbasePosition::fromBitBoards(PieceBitBoards()).has_value());
+    EXPECT_FALSE(fromFen("4k3/8/8/8/8/8/8/R3K3 w Q - 0 1").has_value());
+    // En passant square matters only if the pawn can be captured.
+    EXPECT_TRUE(fromFen("4k3/8/8/8/4P3/8/8/4K3 b - e3 0 1").has_value());
+    EXPECT_FALSE(fromFen("4k3/8/8/8/3pP3/8/8/4K3 b - e3 0 1").has_value());
+}
+
+TEST(Bitbase, KnownResults)
+{
+    ASSERT_EQ(getBitbases().size(), 5);
+
+    // Mate in one, and lost for the side to move with colors flipped.
+    EXPECT_EQ(probe("4k3/Q7/4K3/8/8/8/8/8 w - - 0 1"), Bitbase::Result::Win);
+    EXPECT_EQ(probe("4k3/Q7/4K3/8/8/8/8/8 b - - 0 1"), Bitbase::Result::Loss);
+    EXPECT_EQ(probe("8/8/8/8/8/4k3/q7/4K3 b - - 0 1"), Bitbase::Result::Win);
+    // Queen hangs.
+    EXPECT_EQ(probe("8/8/8/8/8/8/1kQ5/7K b - - 0 1"), Bitbase::Result::Draw);
+    EXPECT_EQ(probe("7k/8/8/8/8/8/8/R3K3 b - - 0 1"), Bitbase::Result::Loss);
+
+    // King in front of the pawn on the 6th rank wins with either side to move.
+    EXPECT_EQ(probe("4k3/8/4K3/4P3/8/8/8/8 w - - 0 1"), Bitbase::Result::Win);
+    EXPECT_EQ(probe("4k3/8/4K3/4P3/8/8/8/8 b - - 0 1"), Bitbase::Result::Loss);
+    // Opposition decides.
+    EXPECT_EQ(probe("4k3/8/8/4K3/4P3/8/8/8 w - - 0 1"), Bitbase::Result::Win);
+    EXPECT_EQ(probe("4k3/8/4K3/8/4P3/8/8/8 w - - 0 1"), Bitbase::Result::Win);
+    EXPECT_EQ(probe("8/4k3/8/4K3/4P3/8/8/8 w - - 0 1"), Bitbase::Result::Draw);
+    EXPECT_EQ(probe("8/4k3/8/4K3/4P3/8/8/8 b - - 0 1"), Bitbase::Result::Loss);
+    // Stalemate and the rook pawn.
+    EXPECT_EQ(probe("4k3/4P3/4K3/8/8/8/8/8 b - - 0 1"), Bitbase::Result::Draw);
+    EXPECT_EQ(probe("k7/8/K7/P7/8/8/8/8 w - - 0 1"), Bitbase::Result::Draw);
+
+    // Minor pieces can't win alone.
+    for (const auto* name : {"KBK", "KNK"}) {
+        auto bitbase = Bitbase::create(name);
+        size_t wins = 0;
+        for (size_t index = 0; index < bitbase->size(); ++index)
+            wins += getBitbases().probe(bitbase->getPosition(index)) == Bitbase::Result::Win;
+        EXPECT_EQ(wins, 0);
+    }
+
+    EXPECT_FALSE(probe("4k3/8/8/8/8/8/8/RR2K3 w - - 0 1").has_value());
+}
+
+TEST(Bitbase, SaveAndLoad)
+{
+    TemporaryDirectory directory;
+    auto bitbase = Bitbase::create("KPK");
+    for (size_t index = 0; index < bitbase->size(); index += 3)
+        bitbase->setResult(index, (index % 2) ? Bitbase::Result::Win : Bitbase::Result::Loss);
+    ASSERT_TRUE(bitbase->save(directory.getPath("KPK.bbs")));
+
+    auto loaded = Bitbase::load(directory.getPath("KPK.bbs"));
+    ASSERT_TRUE(loaded.has_value());
+    EXPECT_EQ(loaded->getName(), "KPK");
+    for (size_t index = 0; index < bitbase->size(); ++index)
+        ASSERT_EQ(loaded->getResult(index), bitbase->getResult(index));
+    loaded.reset();
+    EXPECT_FALSE(std::filesystem::exists(directory.getPath("KPK.bbs.tmp")));
+
+    // Saving again replaces a file truncated by an interrupted generation.
+    std::filesystem::resize_file(directory.getPath("KPK.bbs"), 10);
+    EXPECT_FALSE(Bitbase::load(directory.getPath("KPK.bbs")).has_value());
+    ASSERT_TRUE(bitbase->save(directory.getPath("KPK.bbs")));
+    EXPECT_TRUE(Bitbase::load(directory.getPath("KPK.bbs")).has_value());
+
+    // File name must match the material of the contents.
+    ASSERT_TRUE(bitbase->save(directory.getPath("KRK.bbs")));
+    EXPECT_FALSE(Bitbase::load(directory.getPath("KRK.bbs")).has_value());
+}
+
+TEST(Bitbase, EngineKeepsResultAtRoot)
+{
+    TemporaryDirectory directory;
+    for (const auto* name : {"KQK", "KRK", "KBK", "KNK", "KPK"}) {
+        auto bitbase = Bitbase::create(name);
+        for (size_t index = 0; index < bitbase->size(); ++index) {
+            auto result = getBitbases().probe(bitbase->getPosition(index));
+            if (result.has_value())
+                bitbase->setResult(index, *result);
+        }
+        ASSERT_TRUE(bitbase->save(directory.getPath(std::string(name) + ".bbs")));
+    }
+    // Engines use the bitbases loaded before they are created.
+    ASSERT_TRUE(Bitbases::Init(directory.getPath()));
+
+    // Rook is attacked, moves that leave it hanging draw.
+    PieceBitBoards bitBoards("8/8/8/8/8/2R5/1k6/7K w - - 0 1");
+    Engine engine(false, std::chrono::milliseconds(500), 4);
+    auto [move, depth] = engine.findBestMove(bitBoards, {});
+    ASSERT_TRUE(move.has_value());
+    EXPECT_TRUE(engine.getSearchStatistics().bitbaseRootHit);
+    EXPECT_GT(engine.getSearchStatistics().bitbaseRootMovesExcluded, 0);
+
+    bitBoards.applyMove(*move);
+    EXPECT_EQ(Bitbases::probe(bitBoards), Bitbase::Result::Loss);
+
+    // Engines created by later tests don't use the bitbases.
+    Bitbases::clear();
+}
+
+TEST(Bitbase, ProbeWhileReloading)
+{
+    auto bitbase = Bitbase::create("KRK");
+    for (size_t index = 0; index < bitbase->size(); ++index) {
+        auto result = getBitbases().probe(bitbase->getPosition(index));
+        if (result.has_value())
+            bitbase->setResult(index, *result);
+    }
+    TemporaryDirectory first;
+    TemporaryDirectory second;
+    ASSERT_TRUE(bitbase->save(first.getPath("KRK.bbs")));
+    ASSERT_TRUE(bitbase->save(second.getPath("KRK.bbs")));
+    ASSERT_TRUE(Bitbases::Init(first.getPath()));
+
+    // Probes see the old or the new bitbases, never a half replaced set.
+    PieceBitBoards bitBoards("8/8/8/8/8/2R5/8/k6K w - - 0 1");
+    std::atomic<bool> reloading{true};
+    std::atomic<int> wrongResults{0};
+    std::thread prober([&]() {
+        while (reloading) {
+            if (Bitbases::probe(bitBoards) != Bitbase::Result::Win)
+                wrongResults++;
+        }
+    });
+    for (int i = 0; i < 100; ++i)
+        EXPECT_TRUE(Bitbases::Init((i % 2) ? first.getPath() : second.getPath()));
+    reloading = false;
+    prober.join();
+    EXPECT_EQ(wrongResults, 0);
+
+    // Failed loads and new engines keep the loaded bitbases.
+    std::filesystem::remove(second.getPath("KRK.bbs"));
+    EXPECT_FALSE(Bitbases::Init(second.getPath()));
+    EXPECT_FALSE(Bitbases::Init(first.getPath("missing")));
+    Engine engine(false, std::chrono::milliseconds(100), 1);
+    EXPECT_TRUE(Bitbases::isLoaded());
+    EXPECT_EQ(Bitbases::probe(bitBoards), Bitbase::Result::Win);
+
+    Bitbases::clear();
+    EXPECT_FALSE(Bitbases::isLoaded());
+    EXPECT_FALSE(Bitbases::probe(bitBoards).has_value());
+}
+
+} // namespace chessAi
@@ -0,0 +1,225 @@
+#include <gtest/gtest.h>
+
+#include "core/Engine.h"
+#include "core/EngineWorker.h"
+#include "core/Evaluate.h"
+#include "core/MoveGenerator.h"
+#include "core/PieceBitBoards.h"
+
+#include <algorithm>
+#include <atomic>
+#include <mutex>
+#include <thread>
+
+namespace chessAi
+{
+
+TEST(Engine, MultiPv)
+{
+    PieceBitBoards bitBoards("r1bqkbnr/pppp1ppp/2n5/4p3/4P3/5N2/PPPP1PPP/RNBQKB1R w KQkq - 2 3");
+    Engine engine(false, std::chrono::milliseconds(10000), 3);
+    engine.setMultiPv(3);
+    auto [move, depth] = engine.findBestMove(bitBoards, {});
+    ASSERT_TRUE(move.has_value());
+    EXPECT_EQ(depth, 3);
+
+    const auto& lines = engine.getPrincipalVariations();
+    ASSERT_EQ(lines.size(), 3);
+    EXPECT_EQ(lines.front().moves.front(), *move);
+    EXPECT_EQ(lines.front().score, engine.getSearchStatistics().score);
+    for (size_t i = 0; i < lines.size(); ++i) {
+        if (i > 0) {
+            EXPECT_GE(lines[i - 1].score, lines[i].score);
+            EXPECT_FALSE(lines[i - 1].moves.front() == lines[i].moves.front());
+        }
+
+        // Every line is a legal sequence of moves.
+        ASSERT_FALSE(lines[i].moves.empty());
+        PieceBitBoards tempBoards = bitBoards;
+        for (auto lineMove : lines[i].moves) {
+            auto moves = MoveGeneratorWrapper::generateLegalMoves<MoveType::Normal>(tempBoards);
+            ASSERT_NE(std::find(moves.begin(), moves.end(), lineMove), moves.end());
+            tempBoards.applyMove(lineMove);
+        }
+    }
+
+    // Single line gives the same best move.
+    Engine singleLineEngine(false, std::chrono::milliseconds(10000), 3);
+    auto [singleLineMove, singleLineDepth] = singleLineEngine.findBestMove(bitBoards, {});
+    EXPECT_EQ(singleLineEngine.getPrincipalVariations().size(), 1);
+    EXPECT_EQ(singleLineEngine.getSearchStatistics().score, lines.front().score);
+}
+
+TEST(Engine, InfoCallback)
+{
+    PieceBitBoards bitBoards("r1bqkbnr/pppp1ppp/2n5/4p3/4P3/5N2/PPPP1PPP/RNBQKB1R w KQkq - 2 3");
+    Engine engine(false, std::chrono::milliseconds(10000), 4);
+    std::vector<Engine::SearchInfo> infos;
+    engine.setInfoCallback([&infos](const Engine::SearchInfo& info) { infos.push_back(info); });
+    auto [move, depth] = engine.findBestMove(bitBoards, {});
+    ASSERT_TRUE(move.has_value());
+
+    ASSERT_EQ(infos.size(), 4);
+    for (size_t i = 0; i < infos.size(); ++i) {
+        EXPECT_EQ(infos[i].depth, i + 1);
+        EXPECT_GE(infos[i].selectiveDepth, infos[i].depth);
+        EXPECT_LE(infos[i].hashFull, 1000);
+        ASSERT_EQ(infos[i].lines.size(), 1);
+        EXPECT_EQ(infos[i].lines.front().score, infos[i].score);
+        // Principal variation is searched to the full depth, unless it ends in a transposition.
+        EXPECT_GE(infos[i].lines.front().moves.size(), 1);
+        if (i > 0)
+            EXPECT_GT(infos[i].nodes, infos[i - 1].nodes);
+    }
+    EXPECT_EQ(infos.back().lines.front().moves.front(), *move);
+    EXPECT_EQ(infos.back().score, engine.getSearchStatistics().score);
+    EXPECT_EQ(infos.back().lines.front().moves.size(), 4);
+}
+
+TEST(Engine, NoMoveWhenGameIsOver)
+{
+    // Black is checkmated.
+    PieceBitBoards mated("7k/6Q1/6K1/8/8/8/8/8 b - - 0 1");
+    Engine engine(false, std::chrono::milliseconds(10000), 3);
+    auto [move, depth] = engine.findBestMove(mated, {});
+    EXPECT_FALSE(move.has_value());
+    EXPECT_EQ(depth, 0);
+    EXPECT_TRUE(engine.getSearchStatistics().checkmate);
+    EXPECT_FALSE(engine.getSearchStatistics().stalemate);
+    EXPECT_EQ(engine.getSearchStatistics().score, Evaluate::negativeMateScore);
+
+    // Black is stalemated.
+    PieceBitBoards stalemated("7k/5Q2/6K1/8/8/8/8/8 b - - 0 1");
+    std::tie(move, depth) = engine.findBestMove(stalemated, {});
+    EXPECT_FALSE(move.has_value());
+    EXPECT_FALSE(engine.getSearchStatistics().checkmate);
+    EXPECT_TRUE(engine.getSearchStatistics().stalemate);
+    EXPECT_EQ(engine.getSearchStatistics().score, 0);
+
+    // Worker results report it the same way.
+    EngineWorker worker(false, std::chrono::milliseconds(10000), 3);
+    auto result = worker.startSearch(mated, {}).get();
+    EXPECT_FALSE(result.move.has_value());
+    EXPECT_FALSE(result.ponderMove.has_value());
+    EXPECT_FALSE(result.stopped);
+    EXPECT_TRUE(result.statistics.checkmate);
+}
+
+TEST(Engine, Pondering)
+{
+    PieceBitBoards bitBoards("r1bqkbnr/pppp1ppp/2n5/4p3/4P3/5N2/PPPP1PPP/RNBQKB1R w KQkq - 2 3");
+    EngineWorker worker(false, std::chrono::milliseconds(20));
+    std::mutex resultsMutex;
+    std::vector<EngineWorker::Result> results;
+    // Results of dropped searches come from the thread calling stop.
+    auto storeResult = [&results, &resultsMutex](const EngineWorker::Result& result) {
+        std::lock_guard<std::mutex> lock(resultsMutex);
+        results.push_back(result);
+    };
+    auto getResults = [&results, &resultsMutex]() {
+        std::lock_guard<std::mutex> lock(resultsMutex);
+        return results;
+    };
+
+    // Pondering ignores the time limit, it runs until ponder hit or stop.
+    worker.ponder(bitBoards, {}, storeResult);
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    EXPECT_TRUE(getResults().empty());
+
+    // Hit: search goes on as a normal search and finishes by itself within its time limit.
+    worker.ponderHit();
+    worker.wait();
+    ASSERT_EQ(getResults().size(), 1);
+    ASSERT_TRUE(results.back().move.has_value());
+    EXPECT_FALSE(results.back().stopped);
+
+    // Miss: search is stopped, also if it didn't start yet.
+    results.clear();
+    worker.ponder(bitBoards, {}, storeResult);
+    worker.stop();
+    worker.ponder(bitBoards, {}, storeResult);
+    worker.stop();
+    worker.wait();
+    ASSERT_EQ(getResults().size(), 2);
+    EXPECT_TRUE(results[0].stopped);
+    EXPECT_TRUE(results[1].stopped);
+
+    // Normal search finishes by itself.
+    results.clear();
+    worker.search(bitBoards, {}, storeResult);
+    worker.wait();
+    ASSERT_EQ(getResults().size(), 1);
+    EXPECT_TRUE(results.back().move.has_value());
+    EXPECT_FALSE(results.back().stopped);
+}
+
+TEST(Engine, WorkerIsReused)
+{
+    EngineWorker worker(false, std::chrono::milliseconds(1000), 3);
+    std::vector<EngineWorker::Result> results;
+    auto storeResult = [&results](const EngineWorker::Result& result) {
+        results.push_back(result);
+    };
+
+    // Requests run in order, settings posted between searches apply to the following ones.
+    PieceBitBoards bitBoards("r1bqkbnr/pppp1ppp/2n5/4p3/4P3/5N2/PPPP1PPP/RNBQKB1R w KQkq - 2 3");
+    worker.search(bitBoards, {}, storeResult);
+    worker.post([](Engine& engine) { engine.setMultiPv(2); });
+    worker.search(bitBoards, {}, storeResult);
+    worker.newGame();
+    worker.post([](Engine& engine) { engine.setMultiPv(1); });
+    worker.search(PieceBitBoards(), {}, storeResult);
+    worker.wait();
+
+    ASSERT_EQ(results.size(), 3);
+    for (const auto& result : results) {
+        ASSERT_TRUE(result.move.has_value());
+        EXPECT_EQ(result.depth, 3);
+        EXPECT_FALSE(result.stopped);
+        ASSERT_FALSE(result.lines.empty());
+        EXPECT_EQ(result.lines.front().moves.front(), *result.move);
+        // Principal variation can end in a transposition before the reply.
+        if (result.ponderMove.has_value())
+            EXPECT_EQ(result.lines.front().moves[1], *result.ponderMove);
+    }
+    EXPECT_EQ(results[0].lines.size(), 1);
+    EXPECT_EQ(results[1].lines.size(), 2);
+    EXPECT_EQ(results[2].lines.size(), 1);
+}
+
+TEST(Engine, AsyncSearch)
+{
+    PieceBitBoards bitBoards("r1bqkbnr/pppp1ppp/2n5/4p3/4P3/5N2/PPPP1PPP/RNBQKB1R w KQkq - 2 3");
+    EngineWorker worker(false, std::chrono::milliseconds(60000));
+    std::atomic<unsigned int> iterations = 0;
+    auto running = worker.startSearch(
+        bitBoards, {}, [&iterations](const Engine::SearchInfo&) { iterations++; });
+    auto queued = worker.startSearch(bitBoards, {});
+
+    // Queued search is dropped, the running one goes on.
+    queued.stop();
+    ASSERT_TRUE(queued.isReady());
+    EXPECT_TRUE(queued.get().stopped);
+    EXPECT_FALSE(queued.get().move.has_value());
+    while (iterations == 0)
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    EXPECT_FALSE(running.isReady());
+
+    // Running search returns the best move found so far after the stop. Stop latency is only
+    // measured here, its limit is checked by performance_tests.
+    running.stop();
+    const auto& result = running.get();
+    EXPECT_TRUE(result.stopped);
+    EXPECT_TRUE(result.move.has_value());
+    EXPECT_GT(result.statistics.stopLatency.count(), 0);
+
+    // Worker goes on with new searches, stop of a finished search doesn't affect them.
+    worker.post([](Engine& engine) { engine.setTimeLimit(std::chrono::milliseconds(100)); });
+    auto next = worker.startSearch(bitBoards, {});
+    running.stop();
+    EXPECT_TRUE(next.get().move.has_value());
+    EXPECT_FALSE(next.get().stopped);
+    EXPECT_EQ(next.get().statistics.stopLatency.count(), 0);
+}
+
+} // namespace chessAi
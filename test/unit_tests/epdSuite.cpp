@@ -0,0 +1,47 @@
+#include <gtest/gtest.h>
+
+#include "core/EpdSuite.h"
+#include "core/Notation.h"
+
+#include <cstdio>
+#include <fstream>
+
+namespace chessAi
+{
+
+TEST(EpdSuite, LoadsExpectedMoves)
+{
+    {
+        std::ofstream file("suite.epd");
+        file << "r1bqkbnr/pppp1ppp/2n5/4p3/4P3/5N2/PPPP1PPP/RNBQKB1R w KQkq - bm Bb5 Bc4; "
+                "id \"open, 1\";\n"
+                "\n"
+                "8/8/8/8/8/2R5/1k6/7K w - - am Rc4 c3h3; bm Rc2;\n"
+                "invalid line\n"
+                "4k3/8/4K3/4P3/8/8/8/8 w - - 0 1\n";
+    }
+    auto positions = EpdSuite::load("suite.epd");
+    std::remove("suite.epd");
+    ASSERT_TRUE(positions.has_value());
+    ASSERT_EQ(positions->size(), 3);
+
+    const auto& opening = (*positions)[0];
+    EXPECT_EQ(opening.id, "open, 1");
+    ASSERT_EQ(opening.bestMoves.size(), 2);
+    EXPECT_EQ(Notation::moveToUci(opening.bestMoves[0]), "f1b5");
+    EXPECT_TRUE(opening.isSolvedBy(opening.bestMoves[1]));
+    EXPECT_FALSE(opening.isSolvedBy(*Notation::uciToMove("d2d4", opening.bitBoards)));
+
+    // SAN and UCI notation, best and avoided moves together.
+    const auto& rook = (*positions)[1];
+    EXPECT_EQ(rook.id, "2");
+    ASSERT_EQ(rook.avoidMoves.size(), 2);
+    ASSERT_EQ(rook.bestMoves.size(), 1);
+    EXPECT_TRUE(rook.isSolvedBy(rook.bestMoves[0]));
+    EXPECT_FALSE(rook.isSolvedBy(rook.avoidMoves[1]));
+
+    EXPECT_FALSE((*positions)[2].hasExpectedMoves());
+    EXPECT_FALSE(EpdSuite::load("missing.epd").has_value());
+}
+
+} // namespace chessAi
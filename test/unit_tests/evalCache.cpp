@@ -0,0 +1,63 @@
+#include <gtest/gtest.h>
+
+#include "core/EvalCache.h"
+#include "core/Evaluate.h"
+
+#include <thread>
+
+namespace chessAi
+{
+
+TEST(EvalCache, StoreAndProbe)
+{
+    EvalCache cache(1);
+    PieceBitBoards board("r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1");
+
+    EXPECT_FALSE(cache.probe(board.zobristKey).has_value());
+
+    cache.store(board.zobristKey, Evaluate::getEvaluation(board));
+    ASSERT_TRUE(cache.probe(board.zobristKey).has_value());
+    EXPECT_EQ(*cache.probe(board.zobristKey), Evaluate::getEvaluation(board));
+
+    // Negative evaluations must survive packing.
+    cache.store(board.zobristKey, -1234);
+    EXPECT_EQ(*cache.probe(board.zobristKey), -1234);
+
+    // Same slot, different verification bits.
+    EXPECT_FALSE(cache.probe(board.zobristKey ^ 0x100000000ULL).has_value());
+
+    cache.clear();
+    EXPECT_FALSE(cache.probe(board.zobristKey).has_value());
+}
+
+TEST(EvalCache, SizeIsPowerOfTwo)
+{
+    EvalCache cache(3);
+    auto entries = cache.getNumberOfEntries();
+    EXPECT_EQ(entries & (entries - 1), 0u);
+    EXPECT_LE(entries * sizeof(uint64_t), 3u * 1024 * 1024);
+}
+
+TEST(EvalCache, SharedBetweenThreads)
+{
+    EvalCache cache(1);
+
+    auto worker = [&cache](uint64_t seed) {
+        for (uint64_t i = 1; i < 100000; ++i) {
+            uint64_t key = (i * 0x9E3779B97F4A7C15ULL) ^ seed;
+            int evaluation = static_cast<int>(key % 2000) - 1000;
+            cache.store(key, evaluation);
+            auto probed = cache.probe(key);
+            // Entry can be overwritten by another thread, but never torn.
+            if (probed.has_value())
+                EXPECT_EQ(*probed, evaluation);
+        }
+    };
+
+    std::thread first(worker, 0);
+    std::thread second(worker, 0xFFFFFFFF00000000ULL);
+    first.join();
+    second.join();
+}
+
+} // namespace chessAi
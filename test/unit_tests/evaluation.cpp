@@ -7,6 +7,10 @@
 
 #include "core/Evaluate.h"
 
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+
 namespace chessAi
 {
 
@@ -35,4 +39,45 @@ TEST(Evaluation, StartingPositionWithoutPieces)
               0);
 }
 
+TEST(Evaluation, TraceMatchesEvaluation)
+{
+    std::ifstream file("perft_positions/perftsuite.epd");
+    ASSERT_TRUE(file.is_open());
+
+    const auto& parameters = Evaluate::getParameters();
+    std::string line;
+    while (std::getline(file, line)) {
+        auto fen = line.substr(0, line.find(';') - 1);
+        PieceBitBoards board(fen);
+
+        auto trace = Evaluate::getEvaluationTrace(board);
+        float traceEvaluation = trace.constant;
+        for (size_t i = 0; i < trace.coefficients.size(); ++i)
+            traceEvaluation += trace.coefficients[i] * static_cast<float>(parameters[i]);
+
+        int evaluation = Evaluate::getEvaluation(board);
+        if (board.currentMoveColor == PieceColor::Black)
+            evaluation = -evaluation;
+
+        // Evaluation truncates each scaled term to int.
+        EXPECT_NEAR(traceEvaluation, static_cast<float>(evaluation), 4.f) << fen;
+    }
+}
+
+TEST(Evaluation, ParametersSaveAndLoad)
+{
+    EvaluationParameters parameters;
+    parameters[EvaluationParameters::PawnValue] = 97;
+    parameters[EvaluationParameters::KnightSquareValues + 10] = -7;
+    ASSERT_TRUE(parameters.save("test_evaluation_parameters.txt"));
+
+    EvaluationParameters loaded;
+    ASSERT_TRUE(loaded.load("test_evaluation_parameters.txt"));
+    for (size_t i = 0; i < EvaluationParameters::NumberOfParameters; ++i)
+        EXPECT_EQ(loaded[i], parameters[i]);
+    std::remove("test_evaluation_parameters.txt");
+
+    EXPECT_FALSE(loaded.load("missing_evaluation_parameters.txt"));
+}
+
 } // namespace chessAi
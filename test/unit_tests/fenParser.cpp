@@ -1,7 +1,10 @@
 #include <gtest/gtest.h>
 
+#include "core/Fen.h"
 #include "core/PieceBitBoards.h"
 
+#include <fstream>
+
 namespace chessAi
 {
 
@@ -129,4 +132,114 @@ TEST(FenParserTest, EnPassant)
     EXPECT_EQ(board.enPassantTargetSquare, 44);
 }
 
+TEST(FenParserTest, WriteRoundTrips)
+{
+    std::ifstream file("perft_positions/perftsuite.epd");
+    ASSERT_TRUE(file.is_open());
+
+    std::string line;
+    while (std::getline(file, line)) {
+        auto fen = line.substr(0, line.find(';') - 1);
+        // Half move clock is not tracked and written as 0.
+        auto clockEnd = fen.rfind(' ');
+        auto clockStart = fen.rfind(' ', clockEnd - 1) + 1;
+        fen.replace(clockStart, clockEnd - clockStart, "0");
+        EXPECT_EQ(Fen::toString(PieceBitBoards(fen)), fen);
+    }
+
+    auto fen = "rnbqkbnr/ppp1pppp/8/8/3pPP2/8/PPPP2PP/RNBQKBNR b KQkq e3 0 3";
+    PieceBitBoards board(fen);
+    EXPECT_EQ(board.halfMoveCount, 5);
+    EXPECT_EQ(Fen::toString(board), fen);
+}
+
+TEST(FenParserTest, RejectsInvalidFen)
+{
+    PieceBitBoards board;
+    auto key = board.zobristKey;
+
+    EXPECT_FALSE(Fen::parse("", board));
+    // Row with 9 squares.
+    EXPECT_FALSE(Fen::parse("rnbqkbnr/pppppppp/9/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1", board));
+    EXPECT_FALSE(Fen::parse("rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNRP w KQkq - 0 1", board));
+    EXPECT_FALSE(Fen::parse("rnbqkbnr/pppppppp/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1", board));
+    EXPECT_FALSE(Fen::parse("rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR x KQkq - 0 1", board));
+    EXPECT_FALSE(Fen::parse("rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkx - 0 1", board));
+    EXPECT_FALSE(Fen::parse("rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq e4 0 1", board));
+    EXPECT_EQ(board.zobristKey, key);
+}
+
+TEST(FenParserTest, RejectsIllegalPositions)
+{
+    PieceBitBoards board;
+    auto key = board.zobristKey;
+
+    // Missing and additional kings.
+    EXPECT_FALSE(Fen::parse("8/8/8/8/8/8/8/4K3 w - - 0 1", board));
+    EXPECT_FALSE(Fen::parse("4k3/8/8/8/8/8/8/8 b - - 0 1", board));
+    EXPECT_FALSE(Fen::parse("8/8/8/8/8/8/8/8 w - - 0 1", board));
+    EXPECT_FALSE(Fen::parse("4k3/8/8/8/8/8/8/3KK3 w - - 0 1", board));
+    EXPECT_FALSE(Fen::parse("3kk3/8/8/8/8/8/8/4K3 b - - 0 1", board));
+
+    // Side not to move is in check, by each figure.
+    EXPECT_FALSE(Fen::parse("4k3/8/8/8/8/8/8/4K2r b - - 0 1", board));
+    EXPECT_FALSE(Fen::parse("4k3/8/8/8/1b6/8/8/4K3 b - - 0 1", board));
+    EXPECT_FALSE(Fen::parse("4k3/8/8/8/8/8/2n5/4K3 b - - 0 1", board));
+    EXPECT_FALSE(Fen::parse("4k3/8/8/8/8/8/3p4/4K3 b - - 0 1", board));
+    EXPECT_FALSE(Fen::parse("4k3/4Q3/8/8/8/8/8/4K3 w - - 0 1", board));
+    EXPECT_FALSE(Fen::parse("4k3/3P4/8/8/8/8/8/4K3 w - - 0 1", board));
+    EXPECT_FALSE(Fen::parse("8/8/8/8/8/8/3k4/4K3 w - - 0 1", board));
+    EXPECT_EQ(board.zobristKey, key);
+
+    // Side to move in check, blocked and pawn attacks in the other direction are legal.
+    EXPECT_TRUE(Fen::parse("4k3/8/8/8/8/8/8/4K2r w - - 0 1", board));
+    EXPECT_TRUE(Fen::parse("4k3/8/8/8/8/8/4p3/4K3 b - - 0 1", board));
+    EXPECT_TRUE(Fen::parse("4k3/8/8/8/8/8/3P4/4K3 b - - 0 1", board));
+    EXPECT_TRUE(Fen::parse("4k3/8/8/8/8/8/8/4KR1r b - - 0 1", board));
+}
+
+TEST(FenParserTest, EpdOperations)
+{
+    PieceBitBoards board;
+    std::string_view operations;
+    ASSERT_TRUE(Fen::parse(
+        "1k1r4/pp1b1R2/3q2pp/4p3/2B5/4Q3/PPP2B2/2K5 b - - bm Qd1+; id \"BK.01\"; c0 \"a;b\";",
+        board, &operations));
+    EXPECT_EQ(board.currentMoveColor, PieceColor::Black);
+    EXPECT_EQ(board.halfMoveCount, 1);
+
+    EXPECT_EQ(Fen::getEpdOperation(operations, "bm"), "Qd1+");
+    EXPECT_EQ(Fen::getEpdOperation(operations, "id"), "BK.01");
+    EXPECT_EQ(Fen::getEpdOperation(operations, "c0"), "a;b");
+    EXPECT_FALSE(Fen::getEpdOperation(operations, "am").has_value());
+
+    EXPECT_EQ(Fen::getEpdOperation("noop; am e4 d4;", "am"), "e4 d4");
+}
+
+TEST(FenParserTest, ReadsEpdFile)
+{
+    {
+        std::ofstream file("test_positions.epd");
+        file << "8/8/8/8/8/8/8/K6k w - - bm Kb2;\r\n\ninvalid\n"
+                "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1";
+    }
+
+    std::vector<std::string> fens;
+    std::vector<std::string> operations;
+    auto lines = Fen::forEachEpdLine("test_positions.epd",
+                                     [&](const PieceBitBoards& board, std::string_view epd) {
+                                         fens.push_back(Fen::toString(board));
+                                         operations.emplace_back(epd);
+                                     });
+    std::remove("test_positions.epd");
+
+    ASSERT_EQ(lines, 2);
+    EXPECT_EQ(fens[0], "8/8/8/8/8/8/8/K6k w - - 0 1");
+    EXPECT_EQ(operations[0], "bm Kb2;");
+    EXPECT_EQ(fens[1], std::string(Fen::startingPosition));
+    EXPECT_EQ(operations[1], "");
+    EXPECT_FALSE(Fen::forEachEpdLine("missing.epd", [](const PieceBitBoards&, std::string_view) {
+                 }).has_value());
+}
+
 } // namespace chessAi
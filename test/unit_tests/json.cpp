@@ -0,0 +1,53 @@
+#include <gtest/gtest.h>
+
+#include "core/Json.h"
+
+namespace chessAi
+{
+
+TEST(Json, ParseAndWrite)
+{
+    auto value = JsonValue::parse(
+        R"( {"cmd": "analyse", "depth": 8, "score": -0.5, "info": true, "moves": ["e2e4", "e7e5"],
+            "nested": {"empty": [], "null": null}, "text": "a\"b\\c\nd\u0041"} )");
+    ASSERT_TRUE(value.has_value());
+    ASSERT_TRUE(value->isObject());
+    EXPECT_EQ(value->find("cmd")->getString(), "analyse");
+    EXPECT_EQ(value->find("depth")->getNumber(), 8.0);
+    EXPECT_EQ(value->find("score")->getNumber(), -0.5);
+    EXPECT_TRUE(value->find("info")->getBool());
+    EXPECT_EQ(value->find("moves")->getArray().size(), 2);
+    EXPECT_TRUE(value->find("nested")->find("null")->isNull());
+    EXPECT_EQ(value->find("text")->getString(), "a\"b\\c\ndA");
+    EXPECT_EQ(value->find("missing"), nullptr);
+    // Wrong type gives the default value.
+    EXPECT_EQ(value->find("cmd")->getNumber(7.0), 7.0);
+
+    EXPECT_EQ(value->toString(),
+              R"({"cmd":"analyse","depth":8,"info":true,"moves":["e2e4","e7e5"],)"
+              R"("nested":{"empty":[],"null":null},"score":-0.5,"text":"a\"b\\c\ndA"})");
+    EXPECT_EQ(JsonValue::parse(value->toString()), value);
+}
+
+TEST(Json, Build)
+{
+    JsonValue value;
+    value["nodes"] = uint64_t(123456789012);
+    value["name"] = "KRK";
+    value["lines"].push(JsonValue(1));
+    value["lines"].push(JsonValue(0.25));
+    EXPECT_EQ(value.toString(), R"({"lines":[1,0.25],"name":"KRK","nodes":123456789012})");
+}
+
+TEST(Json, RejectsInvalid)
+{
+    for (const auto* text : {"", "{", "{\"a\" 1}", "[1,]", "{\"a\":1,}", "tru", "\"abc",
+                             "1 2", "{\"a\":1}}", "\"\\x\"", "-"})
+        EXPECT_FALSE(JsonValue::parse(text).has_value()) << text;
+
+    std::string deep(100, '[');
+    deep += std::string(100, ']');
+    EXPECT_FALSE(JsonValue::parse(deep).has_value());
+}
+
+} // namespace chessAi
@@ -0,0 +1,66 @@
+#include <gtest/gtest.h>
+
+#include "core/Notation.h"
+#include "core/PieceBitBoards.h"
+
+namespace chessAi
+{
+
+TEST(Notation, Fields)
+{
+    EXPECT_EQ(Notation::fieldToPosition("a8"), 0);
+    EXPECT_EQ(Notation::fieldToPosition("h1"), 63);
+    EXPECT_EQ(Notation::fieldToPosition("e4"), 36);
+    EXPECT_FALSE(Notation::fieldToPosition("i4").has_value());
+    EXPECT_FALSE(Notation::fieldToPosition("e9").has_value());
+    EXPECT_EQ(Notation::positionToField(36), "e4");
+}
+
+TEST(Notation, Uci)
+{
+    PieceBitBoards board;
+    auto move = Notation::uciToMove("e2e4", board);
+    ASSERT_TRUE(move.has_value());
+    EXPECT_EQ(*move, Move(52, 36, 0, 0));
+    EXPECT_EQ(Notation::moveToUci(*move), "e2e4");
+    EXPECT_FALSE(Notation::uciToMove("e2e5", board).has_value());
+
+    PieceBitBoards promotion("8/1P5k/8/8/8/8/8/K7 w - - 0 1");
+    move = Notation::uciToMove("b7b8n", promotion);
+    ASSERT_TRUE(move.has_value());
+    EXPECT_EQ(*move, Move(9, 1, 0, 1));
+    EXPECT_EQ(Notation::moveToUci(*move), "b7b8n");
+}
+
+TEST(Notation, San)
+{
+    PieceBitBoards board("r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1");
+
+    EXPECT_EQ(Notation::moveToUci(*Notation::sanToMove("O-O", board)), "e1g1");
+    EXPECT_EQ(Notation::moveToUci(*Notation::sanToMove("O-O-O", board)), "e1c1");
+    EXPECT_EQ(Notation::moveToUci(*Notation::sanToMove("Nxf7", board)), "e5f7");
+    EXPECT_EQ(Notation::moveToUci(*Notation::sanToMove("Qxf6+", board)), "f3f6");
+    EXPECT_EQ(Notation::moveToUci(*Notation::sanToMove("dxe6", board)), "d5e6");
+    EXPECT_EQ(Notation::moveToUci(*Notation::sanToMove("g3", board)), "g2g3");
+    EXPECT_EQ(Notation::moveToUci(*Notation::sanToMove("a4!?", board)), "a2a4");
+    EXPECT_FALSE(Notation::sanToMove("Nb6", board).has_value());
+
+    // Both knights can go to e4.
+    PieceBitBoards knights("k7/8/8/8/8/2N3N1/8/K7 w - - 0 1");
+    EXPECT_FALSE(Notation::sanToMove("Ne4", knights).has_value());
+    EXPECT_EQ(Notation::moveToUci(*Notation::sanToMove("Nce4", knights)), "c3e4");
+
+    // Rank disambiguation.
+    PieceBitBoards rooks("1k6/8/8/R7/8/R7/8/7K w - - 0 1");
+    EXPECT_EQ(Notation::moveToUci(*Notation::sanToMove("R3a4", rooks)), "a3a4");
+
+    // En passant and promotion.
+    PieceBitBoards pawns("8/1P5k/8/3pP3/8/8/8/K7 w - d6 0 1");
+    auto enPassant = Notation::sanToMove("exd6", pawns);
+    ASSERT_TRUE(enPassant.has_value());
+    EXPECT_EQ(enPassant->specialMoveFlag, 2);
+    EXPECT_EQ(Notation::moveToUci(*Notation::sanToMove("b8=Q#", pawns)), "b7b8q");
+    EXPECT_EQ(Notation::moveToUci(*Notation::sanToMove("b8=R", pawns)), "b7b8r");
+}
+
+} // namespace chessAi
@@ -0,0 +1,233 @@
+#include <gtest/gtest.h>
+
+#include "core/BookBuilder.h"
+#include "core/MoveGenerator.h"
+#include "core/OpeningBook.h"
+
+#include <atomic>
+#include <cstdio>
+#include <fstream>
+#include <map>
+#include <thread>
+
+namespace chessAi
+{
+
+namespace
+{
+
+void applyMove(PieceBitBoards& board, uint16_t origin, uint16_t destination)
+{
+    for (const auto& move : MoveGeneratorWrapper::generateLegalMoves<MoveType::Normal>(board)) {
+        if (move.origin == origin && move.destination == destination) {
+            board.applyMove(move);
+            return;
+        }
+    }
+    FAIL() << "Move not legal.";
+}
+
+} // namespace
+
+TEST(OpeningBook, EncodeAndDecodeMoves)
+{
+    PieceBitBoards board("r3k2r/pPppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1");
+
+    for (const auto& move : MoveGeneratorWrapper::generateLegalMoves<MoveType::Normal>(board)) {
+        auto decoded = OpeningBook::decodeMove(OpeningBook::encodeMove(move), board);
+        ASSERT_TRUE(decoded.has_value());
+        EXPECT_EQ(*decoded, move);
+    }
+
+    // White king side castle is e1h1 in Polyglot encoding.
+    EXPECT_EQ(OpeningBook::encodeMove(Move(60, 62, 0, 3)), (4 << 6) | 7);
+}
+
+TEST(OpeningBook, FindsMoveAfterTransposition)
+{
+    // 1. Nf3 Nf6 2. Nc3
+    PieceBitBoards first;
+    applyMove(first, 62, 45);
+    applyMove(first, 6, 21);
+    applyMove(first, 57, 42);
+
+    // 1. Nc3 Nf6 2. Nf3
+    PieceBitBoards second;
+    applyMove(second, 57, 42);
+    applyMove(second, 6, 21);
+    applyMove(second, 62, 45);
+
+    // d7d5
+    BookEntry entry;
+    entry.key = first.zobristKey;
+    entry.move = OpeningBook::encodeMove(Move(11, 27, 0, 0));
+    entry.weight = 3;
+    BookEntry other;
+    other.key = first.zobristKey + 1;
+    other.move = entry.move;
+    other.weight = 1;
+
+    ASSERT_TRUE(OpeningBook::writeBook("test_book.bin", {other, entry}));
+    ASSERT_TRUE(OpeningBook::Init("test_book.bin"));
+    std::remove("test_book.bin");
+
+    auto entries = OpeningBook::getEntries(second.zobristKey);
+    ASSERT_EQ(entries.size(), 1);
+    EXPECT_EQ(entries[0].weight, 3);
+
+    auto move = OpeningBook::getBookMove(second);
+    ASSERT_TRUE(move.has_value());
+    EXPECT_EQ(*move, Move(11, 27, 0, 0));
+
+    EXPECT_FALSE(OpeningBook::getBookMove(PieceBitBoards()).has_value());
+}
+
+TEST(OpeningBook, BuilderStoresResults)
+{
+    PieceBitBoards board;
+    Move e4(52, 36, 0, 0);
+    Move d4(51, 35, 0, 0);
+
+    BookBuilder builder;
+    builder.addMove(board.zobristKey, e4, PieceColor::White, GameResult::WhiteWin);
+    builder.addMove(board.zobristKey, e4, PieceColor::White, GameResult::Draw);
+    BookBuilder other;
+    other.addMove(board.zobristKey, e4, PieceColor::White, GameResult::BlackWin);
+    other.addMove(board.zobristKey, d4, PieceColor::White);
+    builder.merge(other);
+
+    auto entries = builder.getEntries();
+    ASSERT_EQ(entries.size(), 2);
+    auto e4Entry = (entries[0].move == OpeningBook::encodeMove(e4)) ? entries[0] : entries[1];
+    EXPECT_EQ(e4Entry.weight, 3);
+    EXPECT_EQ(e4Entry.getWins(), 1);
+    EXPECT_EQ(e4Entry.getLosses(), 1);
+    EXPECT_EQ(e4Entry.getDraws(), 1);
+    EXPECT_DOUBLE_EQ(e4Entry.getScore(), 0.5);
+
+    EXPECT_EQ(builder.getEntries(2).size(), 1);
+}
+
+TEST(OpeningBook, BuilderScalesWeightsOfPosition)
+{
+    PieceBitBoards board;
+    Move e4(52, 36, 0, 0);
+    Move d4(51, 35, 0, 0);
+    Move c4(50, 34, 0, 0);
+    Move e5(12, 28, 0, 0);
+    Move c5(10, 26, 0, 0);
+
+    BookBuilder builder;
+    for (int i = 0; i < 100000; ++i)
+        builder.addMove(board.zobristKey, e4, PieceColor::White, GameResult::WhiteWin);
+    for (int i = 0; i < 70000; ++i)
+        builder.addMove(board.zobristKey, d4, PieceColor::White, GameResult::Draw);
+    builder.addMove(board.zobristKey, c4, PieceColor::White);
+    // Other position with few games keeps its counts.
+    applyMove(board, 52, 36);
+    builder.addMove(board.zobristKey, e5, PieceColor::Black);
+    builder.addMove(board.zobristKey, e5, PieceColor::Black);
+    builder.addMove(board.zobristKey, c5, PieceColor::Black);
+
+    std::map<uint16_t, BookEntry> entries;
+    for (const auto& entry : builder.getEntries())
+        entries[entry.move] = entry;
+    ASSERT_EQ(entries.size(), 5);
+
+    const auto& e4Entry = entries[OpeningBook::encodeMove(e4)];
+    EXPECT_EQ(e4Entry.weight, UINT16_MAX);
+    EXPECT_EQ(e4Entry.getWins(), UINT16_MAX);
+    const auto& d4Entry = entries[OpeningBook::encodeMove(d4)];
+    EXPECT_EQ(d4Entry.weight, 45875);
+    EXPECT_EQ(d4Entry.getDraws(), 45875);
+    EXPECT_EQ(entries[OpeningBook::encodeMove(c4)].weight, 1);
+
+    EXPECT_EQ(entries[OpeningBook::encodeMove(e5)].weight, 2);
+    EXPECT_EQ(entries[OpeningBook::encodeMove(c5)].weight, 1);
+}
+
+TEST(OpeningBook, SelectionPolicies)
+{
+    BookEntry popular;
+    popular.move = 1;
+    popular.weight = 100;
+    popular.setResults(40, 40);
+    BookEntry winning;
+    winning.move = 2;
+    winning.weight = 10;
+    winning.setResults(8, 1);
+    BookEntry rare;
+    rare.move = 3;
+    rare.weight = 1;
+    rare.setResults(1, 0);
+    std::vector<BookEntry> entries = {popular, winning, rare};
+
+    EXPECT_EQ(OpeningBook::selectEntry(entries, BookPolicy::MostPlayed).move, 1);
+    // A single won game does not beat a move scoring well in many games.
+    EXPECT_EQ(OpeningBook::selectEntry(entries, BookPolicy::BestScore).move, 2);
+
+    OpeningBook::setSeed(1);
+    std::map<uint16_t, int> weighted;
+    std::map<uint16_t, int> uniform;
+    for (int i = 0; i < 11100; ++i) {
+        weighted[OpeningBook::selectEntry(entries, BookPolicy::WeightedRandom).move]++;
+        uniform[OpeningBook::selectEntry(entries, BookPolicy::Uniform).move]++;
+    }
+    EXPECT_NEAR(weighted[1], 10000, 300);
+    EXPECT_NEAR(weighted[2], 1000, 150);
+    EXPECT_NEAR(weighted[3], 100, 50);
+    for (uint16_t move = 1; move <= 3; ++move)
+        EXPECT_NEAR(uniform[move], 3700, 300);
+}
+
+TEST(OpeningBook, ReadWhileReloading)
+{
+    PieceBitBoards board;
+    BookEntry entry;
+    entry.key = board.zobristKey;
+    entry.move = OpeningBook::encodeMove(Move(52, 36, 0, 0));
+    entry.weight = 1;
+    BookEntry other = entry;
+    other.key = board.zobristKey + 1;
+    ASSERT_TRUE(OpeningBook::writeBook("test_book_a.bin", {entry}));
+    ASSERT_TRUE(OpeningBook::writeBook("test_book_b.bin", {entry, other}));
+    ASSERT_TRUE(OpeningBook::Init("test_book_a.bin"));
+
+    // Readers see the old or the new book, never an unmapped one.
+    std::atomic<bool> reloading{true};
+    std::atomic<int> wrongEntries{0};
+    std::thread reader([&]() {
+        while (reloading) {
+            if (OpeningBook::getEntries(board.zobristKey).size() != 1)
+                wrongEntries++;
+        }
+    });
+    for (int i = 0; i < 100; ++i)
+        EXPECT_TRUE(OpeningBook::Init((i % 2) ? "test_book_a.bin" : "test_book_b.bin"));
+    reloading = false;
+    reader.join();
+    EXPECT_EQ(wrongEntries, 0);
+    EXPECT_EQ(OpeningBook::getNumberOfEntries(), 1);
+
+    std::remove("test_book_a.bin");
+    std::remove("test_book_b.bin");
+}
+
+TEST(OpeningBook, RejectsInvalidBookFiles)
+{
+    EXPECT_FALSE(MappedFile("missing_book.bin").isOpen());
+    EXPECT_FALSE(OpeningBook::Init("missing_book.bin"));
+
+    {
+        std::ofstream file("test_invalid_book.bin", std::ios::binary);
+        file << "not a multiple of 16 bytes";
+    }
+    MappedFile mapped("test_invalid_book.bin");
+    ASSERT_TRUE(mapped.isOpen());
+    EXPECT_EQ(mapped.size(), 26);
+    EXPECT_EQ(std::string(mapped.data(), 3), "not");
+    EXPECT_FALSE(OpeningBook::Init("test_invalid_book.bin"));
+    std::remove("test_invalid_book.bin");
+}
+
+} // namespace chessAi
@@ -0,0 +1,87 @@
+#include <gtest/gtest.h>
+
+#include "core/MoveGenerator.h"
+#include "core/PackedPosition.h"
+
+#include <fstream>
+
+namespace chessAi
+{
+
+namespace
+{
+
+void expectSamePosition(const PieceBitBoards& a, const PieceBitBoards& b)
+{
+    for (const auto& [type, bitBoard] : a.getTypeToPieceBitBoards())
+        EXPECT_EQ(*bitBoard, b.getPieceBitBoard(type));
+
+    EXPECT_EQ(a.currentMoveColor, b.currentMoveColor);
+    EXPECT_EQ(a.whiteKingSideCastle, b.whiteKingSideCastle);
+    EXPECT_EQ(a.whiteQueenSideCastle, b.whiteQueenSideCastle);
+    EXPECT_EQ(a.blackKingSideCastle, b.blackKingSideCastle);
+    EXPECT_EQ(a.blackQueenSideCastle, b.blackQueenSideCastle);
+    EXPECT_EQ(a.enPassantTargetSquare, b.enPassantTargetSquare);
+    EXPECT_EQ(a.halfMoveCount, b.halfMoveCount);
+    EXPECT_EQ(a.zobristKey, b.zobristKey);
+    EXPECT_EQ(a.whiteKnightPositions.size(), b.whiteKnightPositions.size());
+    EXPECT_EQ(a.blackKingPositions, b.blackKingPositions);
+}
+
+} // namespace
+
+TEST(PackedPosition, RoundTripsPositions)
+{
+    std::ifstream file("perft_positions/perftsuite.epd");
+    ASSERT_TRUE(file.is_open());
+
+    std::vector<PieceBitBoards> boards;
+    std::string line;
+    while (std::getline(file, line)) {
+        PieceBitBoards board(line.substr(0, line.find(';') - 1));
+        boards.push_back(board);
+
+        // Positions after every first move, with en passant squares and changed castling rights.
+        for (const auto& move : MoveGeneratorWrapper::generateLegalMoves<MoveType::Normal>(board)) {
+            boards.push_back(board);
+            boards.back().applyMove(move);
+        }
+    }
+
+    std::vector<PackedPosition> packed(boards.size());
+    ASSERT_EQ(PackedPosition::packBatch(boards.data(), boards.size(), packed.data()),
+              boards.size());
+
+    std::vector<PieceBitBoards> unpacked;
+    ASSERT_EQ(PackedPosition::unpackBatch(packed.data(), packed.size(), unpacked),
+              boards.size());
+    for (size_t i = 0; i < boards.size(); ++i)
+        expectSamePosition(boards[i], unpacked[i]);
+}
+
+TEST(PackedPosition, RejectsInvalidPositions)
+{
+    // Board with more than 32 pieces.
+    PieceBitBoards crowded("rnbqkbnr/pppppppp/pppppppp/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1");
+    EXPECT_FALSE(PackedPosition::pack(crowded).has_value());
+
+    PieceBitBoards board;
+    auto packed = PackedPosition::pack(board);
+    ASSERT_TRUE(packed.has_value());
+
+    // Piece codes above 11 are not used.
+    auto invalidCode = *packed;
+    invalidCode.pieces[0] |= 0xF;
+    EXPECT_FALSE(invalidCode.unpack(board));
+
+    // White king on e1 (piece 28) replaced by a queen.
+    auto noKing = *packed;
+    auto queen = PieceType(PieceColor::White, PieceFigure::Queen).getPieceIndex();
+    noKing.pieces[14] = static_cast<uint8_t>((noKing.pieces[14] & 0xF0) | queen);
+    EXPECT_FALSE(noKing.unpack(board));
+
+    // Board is left unchanged.
+    EXPECT_EQ(board.zobristKey, PieceBitBoards().zobristKey);
+}
+
+} // namespace chessAi
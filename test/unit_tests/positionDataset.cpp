@@ -0,0 +1,115 @@
+#include <gtest/gtest.h>
+
+#include "core/PieceBitBoards.h"
+#include "core/PositionDataset.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+
+namespace chessAi
+{
+
+namespace
+{
+
+std::vector<TrainingSample> createSamples(size_t count, uint32_t game)
+{
+    std::vector<TrainingSample> samples(count);
+    for (size_t i = 0; i < count; ++i) {
+        samples[i].position = *PackedPosition::pack(PieceBitBoards());
+        samples[i].position.score = static_cast<int16_t>(i);
+        samples[i].game = game;
+    }
+    return samples;
+}
+
+} // namespace
+
+TEST(PositionDataset, ReadsBinaryShards)
+{
+    ASSERT_TRUE(TrainingData::writeShard("test_dataset_00000.bin", createSamples(5, 0)));
+    ASSERT_TRUE(TrainingData::writeShard("test_dataset_00001.bin", createSamples(0, 1)));
+    ASSERT_TRUE(TrainingData::writeShard("test_dataset_00002.bin", createSamples(7, 2)));
+
+    PositionDataset dataset;
+    ASSERT_TRUE(dataset.open(std::vector<std::string>{
+        "test_dataset_00000.bin", "test_dataset_00001.bin", "test_dataset_00002.bin"}));
+    ASSERT_EQ(dataset.size(), 12);
+    EXPECT_EQ(dataset[4].game, 0);
+    EXPECT_EQ(dataset[4].position.score, 4);
+    EXPECT_EQ(dataset[5].game, 2);
+    EXPECT_EQ(dataset[11].position.score, 6);
+
+    PieceBitBoards board;
+    ASSERT_TRUE(dataset[7].position.unpack(board));
+    EXPECT_EQ(board.zobristKey, PieceBitBoards().zobristKey);
+
+    // Shards cover all samples in order without overlap.
+    size_t visited = 0;
+    for (size_t shard = 0; shard < 5; ++shard) {
+        auto [begin, end] = dataset.getShardRange(shard, 5);
+        EXPECT_EQ(begin, visited);
+        dataset.forEach(begin, end, [&](const TrainingSample& sample) {
+            EXPECT_EQ(&sample, &dataset[visited]);
+            ++visited;
+        });
+    }
+    EXPECT_EQ(visited, dataset.size());
+
+    auto shuffled = dataset.getShuffledIndices(42);
+    EXPECT_EQ(shuffled, dataset.getShuffledIndices(42));
+    EXPECT_NE(shuffled, dataset.getShuffledIndices(43));
+    std::sort(shuffled.begin(), shuffled.end());
+    for (size_t i = 0; i < shuffled.size(); ++i)
+        EXPECT_EQ(shuffled[i], i);
+
+    for (const auto* path :
+         {"test_dataset_00000.bin", "test_dataset_00001.bin", "test_dataset_00002.bin"})
+        std::remove(path);
+}
+
+TEST(PositionDataset, ReadsTextWithResults)
+{
+    {
+        std::ofstream file("test_dataset.epd");
+        file << "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1 1-0\n"
+                "rnbqkbnr/pppppppp/8/8/4P3/8/PPPP1PPP/RNBQKBNR b KQkq e3 0 1 [1.0]\n"
+                "not a position\n"
+                "4k3/8/8/8/8/8/8/4K3 w - - 0 1 \"1/2-1/2\"\n"
+                "4k3/8/8/8/8/8/8/4K3 b - - ;D1 5\n"
+                "4k3/8/8/8/8/8/8/4K3 w - - hmvc 0; fmvn 1;\n"
+                "4k3/8/8/8/8/8/8/4K3 w - - hmvc 3; fmvn 0;\n"
+                "4k3/8/8/8/8/8/8/4K3 w - - hmvc 0; fmvn 1; c9 \"0-1\";\n";
+    }
+
+    PositionDataset dataset;
+    ASSERT_TRUE(dataset.open("test_dataset.epd"));
+    ASSERT_EQ(dataset.size(), 7);
+    // Results from the view of the side to move.
+    EXPECT_EQ(dataset[0].position.result, TrainingData::Win);
+    EXPECT_EQ(dataset[1].position.result, TrainingData::Loss);
+    EXPECT_EQ(dataset[2].position.result, TrainingData::Draw);
+    EXPECT_EQ(dataset[3].position.result, TrainingData::Unknown);
+    // Move counters of EPD operations are not results.
+    EXPECT_EQ(dataset[4].position.result, TrainingData::Unknown);
+    EXPECT_EQ(dataset[5].position.result, TrainingData::Unknown);
+    EXPECT_EQ(dataset[6].position.result, TrainingData::Loss);
+    std::remove("test_dataset.epd");
+}
+
+TEST(PositionDataset, RejectsInvalidFiles)
+{
+    PositionDataset dataset;
+    EXPECT_FALSE(dataset.open("missing_dataset.bin"));
+    EXPECT_FALSE(dataset.open("missing_dataset.epd"));
+
+    {
+        std::ofstream file("test_invalid_dataset.bin", std::ios::binary);
+        file << "not a multiple of 40 bytes";
+    }
+    EXPECT_FALSE(dataset.open("test_invalid_dataset.bin"));
+    std::remove("test_invalid_dataset.bin");
+}
+
+} // namespace chessAi
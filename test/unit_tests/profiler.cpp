@@ -0,0 +1,77 @@
+#include <gtest/gtest.h>
+
+#include "core/Json.h"
+#include "core/Profiler.h"
+
+#include <fstream>
+#include <sstream>
+#include <thread>
+
+namespace chessAi
+{
+
+namespace
+{
+
+std::optional<JsonValue> readTrace(const std::string& path)
+{
+    std::ifstream file(path);
+    std::stringstream text;
+    text << file.rdbuf();
+    return JsonValue::parse(text.str());
+}
+
+} // namespace
+
+TEST(Profiler, ChromeTraceHasZonesOfAllThreads)
+{
+    Profiler::clear();
+    {
+        Profiler::Zone outer("outer");
+        Profiler::Zone inner("inner");
+    }
+    std::thread([]() { Profiler::Zone zone("worker"); }).join();
+
+    const std::string path = "profiler_trace.json";
+    ASSERT_TRUE(Profiler::writeChromeTrace(path));
+    auto trace = readTrace(path);
+    std::remove(path.c_str());
+    ASSERT_TRUE(trace.has_value());
+
+    const auto* events = trace->find("traceEvents");
+    ASSERT_NE(events, nullptr);
+    std::map<std::string, const JsonValue*> zones;
+    for (const auto& event : events->getArray())
+        zones[event.find("name")->getString()] = &event;
+    ASSERT_EQ(zones.size(), 3u);
+
+    const auto& outer = *zones["outer"];
+    const auto& inner = *zones["inner"];
+    EXPECT_EQ(outer.find("ph")->getString(), "X");
+    // Inner zone is nested in the outer one, on the same thread.
+    EXPECT_LE(outer.find("ts")->getNumber(), inner.find("ts")->getNumber());
+    EXPECT_GE(outer.find("ts")->getNumber() + outer.find("dur")->getNumber(),
+              inner.find("ts")->getNumber() + inner.find("dur")->getNumber());
+    EXPECT_EQ(outer.find("tid")->getNumber(), inner.find("tid")->getNumber());
+    EXPECT_NE(outer.find("tid")->getNumber(), zones["worker"]->find("tid")->getNumber());
+}
+
+TEST(Profiler, RingBufferKeepsLatestZones)
+{
+    Profiler::clear();
+    for (uint64_t i = 0; i < Profiler::s_capacity + 10; ++i)
+        Profiler::Zone zone(i < 10 ? "old" : "new");
+
+    const std::string path = "profiler_ring.json";
+    ASSERT_TRUE(Profiler::writeChromeTrace(path));
+    auto trace = readTrace(path);
+    std::remove(path.c_str());
+    ASSERT_TRUE(trace.has_value());
+
+    const auto& events = trace->find("traceEvents")->getArray();
+    ASSERT_EQ(events.size(), Profiler::s_capacity);
+    for (const auto& event : events)
+        ASSERT_EQ(event.find("name")->getString(), "new");
+}
+
+} // namespace chessAi
@@ -0,0 +1,82 @@
+#include <gtest/gtest.h>
+
+#include "core/Fen.h"
+#include "core/OpeningBook.h"
+#include "core/PieceBitBoards.h"
+#include "core/TrainingData.h"
+
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+
+namespace chessAi
+{
+
+TEST(TrainingData, ShardPath)
+{
+    EXPECT_EQ(TrainingData::getShardPath("data", 42), "data_00042.bin");
+    EXPECT_EQ(TrainingData::getShardPath("dir/data", 0), "dir/data_00000.bin");
+}
+
+TEST(TrainingData, ShardRoundTrip)
+{
+    PieceBitBoards bitBoards;
+    ASSERT_TRUE(Fen::parse("r3k2r/8/8/8/8/8/8/R3K2R b KQkq - 3 20", bitBoards));
+
+    std::vector<TrainingSample> samples(3);
+    for (uint32_t i = 0; i < samples.size(); ++i) {
+        samples[i].position = *PackedPosition::pack(bitBoards);
+        samples[i].position.score = static_cast<int16_t>(-100 * static_cast<int>(i));
+        samples[i].position.result = TrainingData::Draw;
+        samples[i].move = OpeningBook::encodeMove(Move(60, 62, 0, 0));
+        samples[i].depth = 4;
+        samples[i].game = i;
+    }
+
+    auto path = TrainingData::getShardPath("test_training", 0);
+    ASSERT_TRUE(TrainingData::writeShard(path, samples));
+    EXPECT_FALSE(std::filesystem::exists(path + ".tmp"));
+
+    std::ifstream file(path, std::ios::binary);
+    std::vector<char> bytes((std::istreambuf_iterator<char>(file)),
+                            std::istreambuf_iterator<char>());
+    ASSERT_EQ(bytes.size(), samples.size() * sizeof(TrainingSample));
+    std::vector<TrainingSample> read(samples.size());
+    std::memcpy(read.data(), bytes.data(), bytes.size());
+    for (size_t i = 0; i < samples.size(); ++i) {
+        EXPECT_EQ(read[i].position.score, samples[i].position.score);
+        EXPECT_EQ(read[i].position.result, TrainingData::Draw);
+        EXPECT_EQ(read[i].move, samples[i].move);
+        EXPECT_EQ(read[i].depth, 4);
+        EXPECT_EQ(read[i].game, i);
+
+        PieceBitBoards unpacked;
+        ASSERT_TRUE(read[i].position.unpack(unpacked));
+        EXPECT_EQ(Fen::toString(unpacked), Fen::toString(bitBoards));
+    }
+    std::filesystem::remove(path);
+}
+
+TEST(TrainingData, ResumeSkipsWrittenShards)
+{
+    std::filesystem::remove_all("test_resume");
+    std::filesystem::create_directory("test_resume");
+    const std::string prefix = "test_resume/data";
+
+    std::vector<unsigned int> allShards = {0, 1, 2, 3};
+    EXPECT_EQ(TrainingData::getMissingShards(prefix, 4), allShards);
+
+    ASSERT_TRUE(TrainingData::writeShard(TrainingData::getShardPath(prefix, 0), {}));
+    ASSERT_TRUE(TrainingData::writeShard(TrainingData::getShardPath(prefix, 2),
+                                         std::vector<TrainingSample>(2)));
+    // Shard interrupted while it was written.
+    std::ofstream(TrainingData::getShardPath(prefix, 3) + ".tmp") << "partial";
+
+    std::vector<unsigned int> missing = {1, 3};
+    EXPECT_EQ(TrainingData::getMissingShards(prefix, 4), missing);
+    EXPECT_TRUE(TrainingData::getMissingShards(prefix, 0).empty());
+    std::filesystem::remove_all("test_resume");
+}
+
+} // namespace chessAi